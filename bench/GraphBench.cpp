@@ -0,0 +1,197 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <functional>
+
+#include "graph/CSRGraph.hpp"
+#include "graph/Generators.hpp"
+
+// Usage: graph_bench [--generator rmat|er|grid|powerlaw|all] [--scale N]
+//                    [--repeat N] [--seed N] [--format csv|json] [--out file]
+//
+// scale is log2 of the number of vertexes. Dijkstra and MSTs in Graph
+// are far from linear, keep scale small (<= 12) when timing them.
+
+using BenchGraph = qaed::Graph<unsigned, int, qaed::UNDIRECTED>;
+
+struct Result {
+  std::string generator;
+  unsigned    scale;
+  std::size_t vertexes;
+  std::size_t edges;
+  std::string phase;
+  double      seconds;
+};
+
+struct Options {
+  std::string   generator = "all";
+  unsigned      scale     = 10;
+  unsigned      repeat    = 3;
+  std::uint64_t seed      = 1;
+  std::string   format    = "csv";
+  std::string   out;
+};
+
+double best_of(unsigned repeat, const std::function<void ()>& f) {
+  double best = 0;
+  for (unsigned ii = 0; ii < repeat; ++ii) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end   = std::chrono::steady_clock::now();
+
+    double secs = std::chrono::duration<double>(end - start).count();
+    if (ii == 0 || secs < best) best = secs;
+  }
+  return best;
+}
+
+qaed::EdgeList<int> generate(const std::string& name, unsigned scale, std::uint64_t seed) {
+  std::uint32_t n = std::uint32_t(1) << scale;
+
+  if (name == "rmat")     return qaed::generators::rmat<int>(scale, 8, seed);
+  if (name == "er")       return qaed::generators::erdos_renyi<int>(n, 8.0 / n, seed);
+  if (name == "powerlaw") return qaed::generators::power_law<int>(n, 4, seed);
+  if (name == "grid") {
+    std::uint32_t rows = std::uint32_t(1) << (scale / 2);
+    return qaed::generators::grid<int>(rows, n / rows, seed);
+  }
+
+  throw std::invalid_argument("Unknown generator " + name);
+}
+
+void run(const std::string& name, const Options& opt, std::vector<Result>& results) {
+  auto list = generate(name, opt.scale, opt.seed);
+
+  BenchGraph g;
+  auto record = [&](const std::string& phase, double secs) {
+    results.push_back({ name, opt.scale, g.no_vertexes(), g.no_edges(), phase, secs });
+  };
+
+  double build = best_of(opt.repeat, [&]() { g = BenchGraph(); list.fill(g); });
+  record("construction", build);
+
+  record("csr_snapshot", best_of(opt.repeat, [&]() { qaed::CSRGraph<unsigned, int> csr(g); }));
+
+  std::size_t visited = 0;
+  record("bfs", best_of(opt.repeat, [&]() { g.visit_bfs([&](auto&) { ++visited; }); }));
+  record("dfs", best_of(opt.repeat, [&]() { g.visit_dfs([&](auto&) { ++visited; }); }));
+  record("dijkstra_from", best_of(opt.repeat, [&]() { g.dijkstra_from(0); }));
+  record("mst_kruskal",   best_of(opt.repeat, [&]() { g.mst_kruskal(); }));
+  record("mst_prim",      best_of(opt.repeat, [&]() { g.mst_prim(); }));
+}
+
+void write_csv(std::ostream& os, const std::vector<Result>& results) {
+  os << "generator,scale,vertexes,edges,phase,seconds,edges_per_sec\n";
+  for (auto& r : results)
+    os << r.generator << ',' << r.scale << ',' << r.vertexes << ',' << r.edges << ','
+       << r.phase << ',' << r.seconds << ',' << (r.seconds > 0 ? r.edges / r.seconds : 0) << '\n';
+}
+
+void write_json(std::ostream& os, const std::vector<Result>& results) {
+  os << "[\n";
+  for (std::size_t ii = 0; ii < results.size(); ++ii) {
+    auto& r = results[ii];
+    os << "  {\"generator\": \"" << r.generator << "\", \"scale\": " << r.scale
+       << ", \"vertexes\": " << r.vertexes << ", \"edges\": " << r.edges
+       << ", \"phase\": \"" << r.phase << "\", \"seconds\": " << r.seconds
+       << ", \"edges_per_sec\": " << (r.seconds > 0 ? r.edges / r.seconds : 0) << "}"
+       << (ii + 1 < results.size() ? ",\n" : "\n");
+  }
+  os << "]\n";
+}
+
+void usage(const char* name) {
+  std::cerr << "Usage: " << name << " [--generator rmat|er|grid|powerlaw|all] [--scale N]\n"
+            << "       [--repeat N] [--seed N] [--format csv|json] [--out file]\n";
+}
+
+/// Whole argument as a decimal number, false on anything else
+bool parse_number(const std::string& val, std::uint64_t& out) {
+  if (val.empty() || val[0] < '0' || val[0] > '9') return false;
+
+  try {
+    std::size_t used;
+    out = std::stoull(val, &used);
+    return used == val.size();
+  } catch (const std::exception&) {
+    return false;
+  }
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+
+  for (int ii = 1; ii < argc; ii += 2) {
+    std::string key = argv[ii];
+    if (ii + 1 == argc) {
+      std::cerr << "Missing value for " << key << '\n';
+      usage(argv[0]);
+      return 1;
+    }
+    std::string val = argv[ii + 1];
+
+    std::uint64_t number = 0;
+    bool          valid  = true;
+
+    if      (key == "--generator") opt.generator = val;
+    else if (key == "--format")    opt.format    = val;
+    else if (key == "--out")       opt.out       = val;
+    else if (key == "--scale")     { valid = parse_number(val, number) && number < 32; opt.scale  = unsigned(number); }
+    else if (key == "--repeat")    { valid = parse_number(val, number) && number > 0 && number <= 1000000;
+                                     opt.repeat = unsigned(number); }
+    else if (key == "--seed")      { valid = parse_number(val, number); opt.seed = number; }
+    else {
+      std::cerr << "Unknown option " << key << '\n';
+      usage(argv[0]);
+      return 1;
+    }
+
+    if (!valid) {
+      std::cerr << "Bad value " << val << " for " << key << '\n';
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (opt.generator != "all" && opt.generator != "rmat" && opt.generator != "er" &&
+      opt.generator != "grid" && opt.generator != "powerlaw") {
+    std::cerr << "Unknown generator " << opt.generator << '\n';
+    usage(argv[0]);
+    return 1;
+  }
+
+  if (opt.format != "csv" && opt.format != "json") {
+    std::cerr << "Unknown format " << opt.format << '\n';
+    usage(argv[0]);
+    return 1;
+  }
+
+  // Opened before running, a bad path shouldn't cost a whole run
+  std::ofstream file;
+  if (!opt.out.empty()) {
+    file.open(opt.out);
+    if (!file) {
+      std::cerr << "Cannot open " << opt.out << '\n';
+      return 1;
+    }
+  }
+
+  std::vector<std::string> names;
+  if (opt.generator == "all") names = { "rmat", "er", "grid", "powerlaw" };
+  else                        names = { opt.generator };
+
+  std::vector<Result> results;
+  for (auto& name : names)
+    run(name, opt, results);
+
+  std::ostream& os = opt.out.empty() ? std::cout : file;
+
+  if (opt.format == "json") write_json(os, results);
+  else                      write_csv(os, results);
+
+  return 0;
+}
@@ -0,0 +1,299 @@
+#ifndef QAED_COMPRESSED_MATRIX_H
+#define QAED_COMPRESSED_MATRIX_H
+
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "SparseMatrix.hpp"
+
+namespace qaed {
+
+enum MAJOR {
+  ROW_MAJOR,   // CSR, rows are contiguous
+  COL_MAJOR    // CSC, columns are contiguous
+};
+
+/// Compressed sparse matrix, the compute format for sparse data.
+/// The major dimension (rows for CSR, columns for CSC) is split in
+/// lanes: lane o holds indices()[pointers()[o] .. pointers()[o + 1])
+/// sorted and without repeats, values() is parallel to indices().
+/// Iterating a lane is a linear scan, a position of the other
+/// dimension needs a binary search per lane.
+template <class Type, MAJOR major, class Index = std::uint32_t>
+class CompressedMatrix {
+public:
+  using Size_t = std::size_t;
+  using Offset = std::size_t;
+
+  template <class, MAJOR, class> friend class CompressedMatrix;
+
+private:
+  Size_t              m_no_rows;
+  Size_t              m_no_cols;
+  std::vector<Offset> m_ptr;
+  std::vector<Index>  m_idx;
+  std::vector<Type>   m_val;
+
+public:
+  CompressedMatrix() : m_no_rows(0), m_no_cols(0), m_ptr(1, 0) {}
+
+  /// All zero matrix
+  CompressedMatrix(Size_t rows, Size_t cols) : m_no_rows(rows), m_no_cols(cols) {
+    check_dimensions();
+    m_ptr.assign(outer_size() + 1, 0);
+  }
+
+  /// Takes ready made arrays, checked in O(nnz)
+  CompressedMatrix(Size_t rows, Size_t cols, std::vector<Offset> ptr, std::vector<Index> idx, std::vector<Type> val) :
+    m_no_rows(rows),
+    m_no_cols(cols),
+    m_ptr(std::move(ptr)),
+    m_idx(std::move(idx)),
+    m_val(std::move(val)) {
+    check_dimensions();
+
+    if (m_ptr.size() != outer_size() + 1 || m_ptr.front() != 0 || m_ptr.back() != m_idx.size() || m_val.size() != m_idx.size())
+      throw std::invalid_argument("Inconsistent compressed arrays");
+
+    for (Size_t o = 0; o < outer_size(); ++o) {
+      if (m_ptr[o + 1] < m_ptr[o]) throw std::invalid_argument("Lane pointers must not decrease");
+
+      for (Offset k = m_ptr[o]; k < m_ptr[o + 1]; ++k)
+        if (m_idx[k] >= inner_size() || (k > m_ptr[o] && m_idx[k] <= m_idx[k - 1]))
+          throw std::invalid_argument("Lane indices must be sorted, unique and in range");
+    }
+  }
+
+  /// Every stored entry of m, the map of maps is already sorted by
+  /// row and column so the conversion is O(nnz) (+ O(rows + cols)).
+  /// T stays a template parameter so CompressedMatrix<double> still
+  /// compiles, FastMatrix only takes integral types.
+  template <class T, T def, class SizeT, class = std::enable_if_t<std::is_same<T, Type>::value>>
+  explicit CompressedMatrix(const FastMatrix<T, def, SizeT>& m) : CompressedMatrix(m.noRows(), m.noCols()) {
+    build([&](auto&& f) { m.for_each(f); });
+  }
+
+  /// Row lists of Matrix are sorted too, O(nnz) (+ O(rows + cols))
+  explicit CompressedMatrix(const Matrix<Type>& m) : CompressedMatrix(m.noRows(), m.noCols()) {
+    build([&](auto&& f) { m.for_each(f); });
+  }
+
+  Size_t no_rows() const { return m_no_rows; }
+  Size_t no_cols() const { return m_no_cols; }
+  Offset nnz()     const { return m_idx.size(); }
+
+  /// Lanes and positions inside a lane
+  Size_t outer_size() const { return major == ROW_MAJOR ? m_no_rows : m_no_cols; }
+  Size_t inner_size() const { return major == ROW_MAJOR ? m_no_cols : m_no_rows; }
+
+  const std::vector<Offset>& pointers() const { return m_ptr; }
+  const std::vector<Index>&  indices()  const { return m_idx; }
+  const std::vector<Type>&   values()   const { return m_val; }
+  std::vector<Type>&         values()         { return m_val; }
+
+  Offset lane_size(Size_t o) const { return m_ptr[o + 1] - m_ptr[o]; }
+
+  const Index* idx_begin(Size_t o) const { return m_idx.data() + m_ptr[o]; }
+  const Index* idx_end(Size_t o)   const { return m_idx.data() + m_ptr[o + 1]; }
+
+  const Type* val_begin(Size_t o) const { return m_val.data() + m_ptr[o]; }
+  Type*       val_begin(Size_t o)       { return m_val.data() + m_ptr[o]; }
+
+  /// Stored value at (row, col) or nullptr, O(log(lane size))
+  const Type* find(Size_t row, Size_t col) const {
+    if (row >= m_no_rows || col >= m_no_cols) return nullptr;
+
+    Size_t o = major == ROW_MAJOR ? row : col;
+    Index  i = major == ROW_MAJOR ? col : row;
+
+    const Index* it = std::lower_bound(idx_begin(o), idx_end(o), i);
+    if (it == idx_end(o) || *it != i) return nullptr;
+    return m_val.data() + (it - m_idx.data());
+  }
+
+  Type* find(Size_t row, Size_t col) {
+    return const_cast<Type*>(static_cast<const CompressedMatrix&>(*this).find(row, col));
+  }
+
+  /// Stored entries only, the structure can't grow in place
+  Type& get(Size_t row, Size_t col) {
+    if (row >= m_no_rows) throw std::out_of_range("rows out of range");
+    if (col >= m_no_cols) throw std::out_of_range("cols out of range");
+
+    Type* v = find(row, col);
+    if (!v) throw std::runtime_error("Cannot find element at pos " + std::to_string(row) + ", " + std::to_string(col));
+    return *v;
+  }
+
+  /// Value at (row, col), def when nothing is stored there
+  Type at(Size_t row, Size_t col, const Type& def = Type()) const {
+    const Type* v = find(row, col);
+    return v ? *v : def;
+  }
+
+  /// f(row, col, value) for every stored entry in storage order
+  template <class Function>
+  void for_each(Function&& f) const {
+    for (Size_t o = 0; o < outer_size(); ++o)
+      for (Offset k = m_ptr[o]; k < m_ptr[o + 1]; ++k) {
+        if (major == ROW_MAJOR) f(Size_t(o), Size_t(m_idx[k]), m_val[k]);
+        else                    f(Size_t(m_idx[k]), Size_t(o), m_val[k]);
+      }
+  }
+
+  /// f(col, value) by increasing col. Linear for CSR, one binary search
+  /// per column for CSC
+  template <class Function>
+  void for_each_in_row(Size_t row, Function&& f) const {
+    if (row >= m_no_rows) throw std::out_of_range("rows out of range");
+    if (major == ROW_MAJOR) for_each_in_lane(row, f);
+    else                    for_each_across(row, f);
+  }
+
+  /// f(row, value) by increasing row. Linear for CSC, one binary search
+  /// per row for CSR
+  template <class Function>
+  void for_each_in_col(Size_t col, Function&& f) const {
+    if (col >= m_no_cols) throw std::out_of_range("cols out of range");
+    if (major == COL_MAJOR) for_each_in_lane(col, f);
+    else                    for_each_across(col, f);
+  }
+
+  /// Same matrix in the other layout (or a copy), counting sort on the
+  /// inner indices, O(nnz + rows + cols)
+  template <MAJOR other>
+  CompressedMatrix<Type, other, Index> convert() const {
+    if constexpr (other == major) {
+      return *this;
+    } else {
+      CompressedMatrix<Type, other, Index> m(m_no_rows, m_no_cols);
+
+      for (Index i : m_idx)
+        m.m_ptr[i + 1] += 1;
+      std::partial_sum(m.m_ptr.begin(), m.m_ptr.end(), m.m_ptr.begin());
+
+      std::vector<Offset> fill(m.m_ptr.begin(), m.m_ptr.end() - 1);
+      m.m_idx.resize(nnz());
+      m.m_val.resize(nnz());
+
+      // Lanes are visited in increasing order, so the new lanes come out sorted
+      for (Size_t o = 0; o < outer_size(); ++o)
+        for (Offset k = m_ptr[o]; k < m_ptr[o + 1]; ++k) {
+          Offset p = fill[m_idx[k]]++;
+          m.m_idx[p] = Index(o);
+          m.m_val[p] = m_val[k];
+        }
+
+      return m;
+    }
+  }
+
+  CompressedMatrix<Type, ROW_MAJOR, Index> to_csr() const { return convert<ROW_MAJOR>(); }
+  CompressedMatrix<Type, COL_MAJOR, Index> to_csc() const { return convert<COL_MAJOR>(); }
+
+  /// Every stored entry goes through FastMatrix::add, O(nnz log nnz)
+  template <auto def, class SizeT = unsigned long, class T = Type>
+  FastMatrix<T, def, SizeT> to_fast_matrix() const {
+    FastMatrix<T, def, SizeT> m(m_no_rows, m_no_cols);
+    for_each([&](Size_t r, Size_t c, const Type& v) { m.add(v, r, c); });
+    return m;
+  }
+
+  /// Entries are added backwards, every insertion lands at the head of
+  /// its row and column lists, O(nnz)
+  std::unique_ptr<Matrix<Type>> to_matrix() const {
+    auto m = std::make_unique<Matrix<Type>>(m_no_rows, m_no_cols);
+
+    for (Size_t o = outer_size(); o-- > 0; )
+      for (Offset k = m_ptr[o + 1]; k-- > m_ptr[o]; ) {
+        if (major == ROW_MAJOR) m->add(m_val[k], o, m_idx[k]);
+        else                    m->add(m_val[k], m_idx[k], o);
+      }
+
+    return m;
+  }
+
+  bool operator==(const CompressedMatrix& m) const {
+    return m_no_rows == m.m_no_rows && m_no_cols == m.m_no_cols && m_ptr == m.m_ptr && m_idx == m.m_idx && m_val == m.m_val;
+  }
+
+  bool operator!=(const CompressedMatrix& m) const { return !(*this == m); }
+
+  void print(std::ostream& os = std::cout, const Type& def = Type()) const {
+    for (Size_t ii = 0; ii < m_no_rows; ++ii) {
+      for (Size_t jj = 0; jj < m_no_cols; ++jj)
+        os << at(ii, jj, def) << " ";
+      os << std::endl;
+    }
+  }
+
+  void printLn(std::ostream& os = std::cout) const {
+    print(os); os << std::endl;
+  }
+
+private:
+
+  void check_dimensions() const {
+    if (m_no_rows > std::numeric_limits<Index>::max() || m_no_cols > std::numeric_limits<Index>::max())
+      throw std::invalid_argument("Dimensions don't fit in the index type");
+  }
+
+  /// Fills the arrays from a source visiting its entries sorted by row
+  /// and then by column. CSC needs a counting pass first.
+  template <class Visit>
+  void build(Visit visit) {
+    if constexpr (major == ROW_MAJOR) {
+      visit([&](Size_t r, Size_t c, const Type& v) {
+        m_ptr[r + 1] += 1;
+        m_idx.push_back(Index(c));
+        m_val.push_back(v);
+      });
+      std::partial_sum(m_ptr.begin(), m_ptr.end(), m_ptr.begin());
+    } else {
+      visit([&](Size_t, Size_t c, const Type&) { m_ptr[c + 1] += 1; });
+      std::partial_sum(m_ptr.begin(), m_ptr.end(), m_ptr.begin());
+
+      std::vector<Offset> fill(m_ptr.begin(), m_ptr.end() - 1);
+      m_idx.resize(m_ptr.back());
+      m_val.resize(m_ptr.back());
+
+      visit([&](Size_t r, Size_t c, const Type& v) {
+        Offset p = fill[c]++;
+        m_idx[p] = Index(r);
+        m_val[p] = v;
+      });
+    }
+  }
+
+  template <class Function>
+  void for_each_in_lane(Size_t o, Function& f) const {
+    for (Offset k = m_ptr[o]; k < m_ptr[o + 1]; ++k)
+      f(Size_t(m_idx[k]), m_val[k]);
+  }
+
+  template <class Function>
+  void for_each_across(Size_t i, Function& f) const {
+    for (Size_t o = 0; o < outer_size(); ++o) {
+      const Index* it = std::lower_bound(idx_begin(o), idx_end(o), Index(i));
+      if (it != idx_end(o) && *it == i) f(o, m_val[it - m_idx.data()]);
+    }
+  }
+
+};
+
+template <class Type, class Index = std::uint32_t>
+using CSRMatrix = CompressedMatrix<Type, ROW_MAJOR, Index>;
+
+template <class Type, class Index = std::uint32_t>
+using CSCMatrix = CompressedMatrix<Type, COL_MAJOR, Index>;
+
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include <queue>
 #include <stack>
 #include <vector>
+#include <fstream>
+#include <sstream>
 #include <iostream>
 #include <algorithm>
 #include <functional>
@@ -12,6 +14,8 @@
 
 #include "tools/Sfinae.hpp"
 #include "tools/GVTools.hpp"
+#include "tools/Instrumentation.hpp"
+#include "tools/StreamWriter.hpp"
 #include "FibonacciHeap.hpp"
 
 namespace qaed {
@@ -21,6 +25,93 @@ enum G_TYPE {
   UNDIRECTED
 };
 
+enum CHANGE_TYPE {
+  ADD_VERTEX,
+  REMOVE_VERTEX,
+  ADD_EDGE,
+  REMOVE_EDGE,
+  RETAG_EDGE
+};
+
+/// One mutation of a Graph, vertex changes only use `from`. In change
+/// logs REMOVE_EDGE keeps the removed tag and RETAG_EDGE the previous
+/// one in old_tag, so every entry can be undone.
+template <class VertexTag, class EdgeTag>
+struct GraphChange {
+  CHANGE_TYPE type;
+  VertexTag   from;
+  VertexTag   to;
+  EdgeTag     tag;
+  EdgeTag     old_tag;
+};
+
+/// Batch of mutations for Graph::apply, also the change log it returns
+template <class VertexTag, class EdgeTag>
+class GraphDelta {
+public:
+  using Change = GraphChange<VertexTag, EdgeTag>;
+
+private:
+  std::vector<Change> m_changes;
+
+public:
+  GraphDelta& add_vertex(const VertexTag& v)    { return push(ADD_VERTEX, v, VertexTag(), EdgeTag(), EdgeTag()); }
+  GraphDelta& remove_vertex(const VertexTag& v) { return push(REMOVE_VERTEX, v, VertexTag(), EdgeTag(), EdgeTag()); }
+
+  GraphDelta& add_edge(const VertexTag& a, const VertexTag& b, const EdgeTag& t) { return push(ADD_EDGE, a, b, t, EdgeTag()); }
+  GraphDelta& remove_edge(const VertexTag& a, const VertexTag& b, const EdgeTag& t = EdgeTag()) {
+    return push(REMOVE_EDGE, a, b, t, EdgeTag());
+  }
+  GraphDelta& set_tag_edge(const VertexTag& a, const VertexTag& b, const EdgeTag& t, const EdgeTag& old = EdgeTag()) {
+    return push(RETAG_EDGE, a, b, t, old);
+  }
+
+  GraphDelta& push(CHANGE_TYPE type, const VertexTag& a, const VertexTag& b, const EdgeTag& t, const EdgeTag& old) {
+    m_changes.push_back(Change{ type, a, b, t, old });
+    return *this;
+  }
+
+  std::size_t size()  const { return m_changes.size(); }
+  bool        empty() const { return m_changes.empty(); }
+  void        clear()       { m_changes.clear(); }
+
+  auto begin() const { return m_changes.cbegin(); }
+  auto end()   const { return m_changes.cend(); }
+
+  const Change& operator[](std::size_t ii) const { return m_changes[ii]; }
+
+  /// Undo of a change log: entries reversed, each one inverted
+  GraphDelta inverse() const {
+    GraphDelta inv;
+    inv.m_changes.reserve(m_changes.size());
+
+    for (auto it = m_changes.rbegin(); it != m_changes.rend(); ++it) {
+      Change c = *it;
+      switch (c.type) {
+        case ADD_VERTEX:    c.type = REMOVE_VERTEX; break;
+        case REMOVE_VERTEX: c.type = ADD_VERTEX;    break;
+        case ADD_EDGE:      c.type = REMOVE_EDGE;   break;
+        case REMOVE_EDGE:   c.type = ADD_EDGE;      break;
+        case RETAG_EDGE:    std::swap(c.tag, c.old_tag); break;
+      }
+      inv.m_changes.push_back(c);
+    }
+
+    return inv;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const GraphDelta& d) {
+    static const char* names[] = { "+v", "-v", "+e", "-e", "~e" };
+    for (auto& c : d.m_changes) {
+      os << names[c.type] << " " << c.from;
+      if (c.type != ADD_VERTEX && c.type != REMOVE_VERTEX) os << " " << c.to << " (" << c.tag << ")";
+      if (c.type == RETAG_EDGE) os << " was (" << c.old_tag << ")";
+      os << std::endl;
+    }
+    return os;
+  }
+};
+
 template <class VertexTag, class EdgeTag, G_TYPE type>
 class Graph {
 private:
@@ -193,8 +284,13 @@ public:
     );
   }
 
-  std::size_t no_vertexes() { return m_no_vertexes; }
-  std::size_t no_edges() { return m_no_edges; }
+  std::size_t no_vertexes() const { return m_no_vertexes; }
+  std::size_t no_edges() const { return m_no_edges; }
+
+  /// Read only traversal over the vertexes (ordered by tag),
+  /// used by the algorithms in include/graph
+  auto begin() const { return m_g.cbegin(); }
+  auto end()   const { return m_g.cend(); }
 
   auto add_vertex(const VertexTag& data) {
     auto result = m_g.emplace(Vertex(data));
@@ -212,6 +308,8 @@ public:
     return result;
   }
 
+  /// Edges are keyed by destination only, adding a second edge between
+  /// the same vertexes keeps the first one (graph/MultiGraph.hpp keeps both)
   auto add_edge(const VertexTag& d1, const VertexTag& d2, const EdgeTag& data) {
     VertexItr i1 = m_g.find(Vertex(d1));
     VertexItr i2 = m_g.find(Vertex(d2));
@@ -278,6 +376,18 @@ public:
 
   bool remove_edges_with(const VertexItr& vit) {
     if (vit == m_g.end()) return false;
+
+    if constexpr (type == UNDIRECTED) {
+      // Only the neighbours hold an edge back to vit
+      for (auto& e : vit->edges())
+        if (e.vertex_itr() != vit) e.vertex().edges().erase(Edge(vit));
+
+      m_no_edges -= vit->edges().size();
+      vit->edges().clear();
+      return true;
+    }
+
+    m_no_edges -= vit->edges().size();
     vit->edges().clear();
 
     EdgeItr tmp;
@@ -294,6 +404,106 @@ public:
     return true;
   }
 
+  /// Applies a whole batch and returns the change log, only the changes
+  /// that did something, ready for replication or for apply(log.inverse()).
+  /// The batch works as a set, in this order: vertex insertions, edge
+  /// removals, vertex removals, edge insertions, retags. Edges touching
+  /// missing vertexes are skipped. Every phase is sorted first and merged
+  /// into the (sorted) sets with exact hints instead of separate emplaces.
+  GraphDelta<VertexTag, EdgeTag> apply(const GraphDelta<VertexTag, EdgeTag>& delta) {
+    using Change = GraphChange<VertexTag, EdgeTag>;
+
+    std::vector<const Change*> ops[5];
+    for (auto& c : delta) ops[c.type].push_back(&c);
+
+    auto by_from = [](const Change* a, const Change* b) { return a->from < b->from; };
+
+    GraphDelta<VertexTag, EdgeTag> log;
+
+    std::stable_sort(ops[ADD_VERTEX].begin(), ops[ADD_VERTEX].end(), by_from);
+    VertexItr hint = m_g.begin();
+    for (const Change* c : ops[ADD_VERTEX]) {
+      Vertex key(c->from);
+      hint = seek(m_g, hint, key);
+      if (hint != m_g.end() && *hint == key) continue;
+
+      hint = m_g.emplace_hint(hint, key);
+      m_no_vertexes += 1;
+      log.add_vertex(c->from);
+    }
+
+    merge_edges(ops[REMOVE_EDGE], false, log);
+
+    std::stable_sort(ops[REMOVE_VERTEX].begin(), ops[REMOVE_VERTEX].end(), by_from);
+    remove_vertexes(ops[REMOVE_VERTEX], log);
+
+    merge_edges(ops[ADD_EDGE], true, log);
+
+    for (const Change* c : ops[RETAG_EDGE]) {
+      VertexItr a = m_g.find(Vertex(c->from));
+      VertexItr b = m_g.find(Vertex(c->to));
+      if (a == m_g.end() || b == m_g.end()) continue;
+
+      EdgeItr e = a->edges().find(Edge(b));
+      if (e == a->edges().end() || e->get_tag() == c->tag) continue;
+
+      log.set_tag_edge(c->from, c->to, c->tag, e->get_tag());
+      set_tag_edge(a, b, c->tag);
+    }
+
+    return log;
+  }
+
+  /// Delta turning `from` into `to`, both adjacencies are walked once
+  static GraphDelta<VertexTag, EdgeTag> diff(const Graph& from, const Graph& to) {
+    GraphDelta<VertexTag, EdgeTag> delta;
+
+    auto is_new = [&](const Vertex& v) { return from.m_g.find(v) == from.m_g.end(); };
+
+    auto a = from.m_g.begin(), b = to.m_g.begin();
+    while (a != from.m_g.end() || b != to.m_g.end()) {
+      if (b == to.m_g.end() || (a != from.m_g.end() && *a < *b)) {
+        // Its edges go away with the vertex
+        delta.remove_vertex(a->get_data());
+        ++a;
+        continue;
+      }
+
+      if (a == from.m_g.end() || *b < *a) {
+        delta.add_vertex(b->get_data());
+        for (auto& e : b->edges()) {
+          if (type == UNDIRECTED && e.vertex() < *b && is_new(e.vertex())) continue;
+          delta.add_edge(b->get_data(), e.vertex().get_data(), e.get_tag());
+        }
+        ++b;
+        continue;
+      }
+
+      // UNDIRECTED edges are handled from their lower end, edges to a
+      // new vertex were already added with it
+      auto x = a->edges().begin(), y = b->edges().begin();
+      while (x != a->edges().end() || y != b->edges().end()) {
+        if (y == b->edges().end() || (x != a->edges().end() && x->vertex() < y->vertex())) {
+          bool skip = (type == UNDIRECTED && x->vertex() < *a) || to.m_g.find(x->vertex()) == to.m_g.end();
+          if (!skip) delta.remove_edge(a->get_data(), x->vertex().get_data(), x->get_tag());
+          ++x;
+        } else if (x == a->edges().end() || y->vertex() < x->vertex()) {
+          bool skip = type == UNDIRECTED && (y->vertex() < *b || is_new(y->vertex()));
+          if (!skip) delta.add_edge(a->get_data(), y->vertex().get_data(), y->get_tag());
+          ++y;
+        } else {
+          bool skip = type == UNDIRECTED && x->vertex() < *a;
+          if (!skip && !(x->get_tag() == y->get_tag()))
+            delta.set_tag_edge(a->get_data(), x->vertex().get_data(), y->get_tag(), x->get_tag());
+          ++x; ++y;
+        }
+      }
+      ++a; ++b;
+    }
+
+    return delta;
+  }
+
   auto get_vertex_itr(const VertexTag& a) { return m_g.find(Vertex(a)); }
   auto get_vertex(const VertexTag& a) { return *get_vertex_itr(a);}
 
@@ -370,6 +580,8 @@ public:
 
 
   void visit_bfs(const std::function<void (const Vertex&)>& visit_func, VertexItr beg) {
+    QAED_STATS_SCOPE("visit_bfs");
+
     std::queue<VertexItr> queue;
     queue.push(beg);
 
@@ -381,6 +593,9 @@ public:
       visit_func(*tmp);
       tmp->mark();
 
+      QAED_STATS_ADD(vertexes_visited, 1);
+      QAED_STATS_ADD(edges_relaxed, tmp->edges().size());
+
       for (auto& e : tmp->edges())
         if (!e.vertex().marked()) {
           queue.push(e.vertex_itr());
@@ -394,6 +609,8 @@ public:
   void visit_bfs(const std::function<void (const Vertex&)>& visit_func) { visit_bfs(visit_func, m_g.begin()); }
 
   void visit_dfs(const std::function<void (const Vertex&)>& visit_func, VertexItr beg) {
+    QAED_STATS_SCOPE("visit_dfs");
+
     std::stack<VertexItr> stack;
     stack.push(beg);
 
@@ -405,6 +622,9 @@ public:
       visit_func(*tmp);
       tmp->mark();
 
+      QAED_STATS_ADD(vertexes_visited, 1);
+      QAED_STATS_ADD(edges_relaxed, tmp->edges().size());
+
       for (auto& e : tmp->edges())
         if (!e.vertex().marked()) {
           stack.push(e.vertex_itr());
@@ -445,6 +665,8 @@ public:
       "Dijkstra only works for arithmetic type or pseudoscalar (fully comparables) EdgeTags."
     );
 
+    QAED_STATS_SCOPE("dijkstra_from");
+
     VertexItr origin = m_g.find(Vertex(a));
     if (origin == m_g.end()) throw std::runtime_error("Vertex wasn\'t found");
 
@@ -454,6 +676,7 @@ public:
     DijkstraHeap heap;
     for (auto& x : distances)
       heap.add(x);
+    QAED_STATS_ADD(heap_pushes, distances.size());
 
     Edge    min_edge;
     EdgeItr from_min;
@@ -462,25 +685,35 @@ public:
     std::size_t used = 1;
 
     while (used < m_g.size() && !heap.empty()) { // O(n^2logn)
-      min_edge = get_min_dijkstra(heap);
+      {
+        QAED_STATS_PHASE("extract min");
+        min_edge = get_min_dijkstra(heap);
+      }
 
       min_edge.vertex().mark();
       ++used;
+      QAED_STATS_ADD(vertexes_visited, 1);
+      {
+        QAED_STATS_PHASE("relax");
+
+        for (VertexItr ii = m_g.begin(); ii != m_g.end(); ++ii) { // O(nlogn)
+          if (ii->marked()) continue;
 
-      for (VertexItr ii = m_g.begin(); ii != m_g.end(); ++ii) { // O(nlogn)
-        if (ii->marked()) continue;
+          from_min = min_edge.vertex().edges().find(Edge(ii)); // O(logn)
 
-        from_min = min_edge.vertex().edges().find(Edge(ii)); // O(logn)
+          if (from_min != min_edge.vertex().edges().end()) {
+            tmp = distances.find(Edge(ii)); // O(logn)
 
-        if (from_min != min_edge.vertex().edges().end()) {
-          tmp = distances.find(Edge(ii)); // O(logn)
+            if (tmp != distances.end()) {
+              tmp->set_tag(std::min(tmp->get_tag(), min_edge.get_tag() + from_min->get_tag()));
+              heap.add(*tmp); // O(1)
+            } else {
+              auto r = distances.emplace(from_min->vertex_itr(), min_edge.get_tag() + from_min->get_tag());
+              heap.add(*std::get<0>(r)); // O(1)
+            }
 
-          if (tmp != distances.end()) {
-            tmp->set_tag(std::min(tmp->get_tag(), min_edge.get_tag() + from_min->get_tag()));
-            heap.add(*tmp); // O(1)
-          } else {
-            auto r = distances.emplace(from_min->vertex_itr(), min_edge.get_tag() + from_min->get_tag());
-            heap.add(*std::get<0>(r)); // O(1)
+            QAED_STATS_ADD(edges_relaxed, 1);
+            QAED_STATS_ADD(heap_pushes, 1);
           }
         }
       }
@@ -493,8 +726,14 @@ public:
   Graph<VertexTag, EdgeTag, UNDIRECTED> mst_kruskal() {
     static_assert(type == UNDIRECTED, "Graph needs to be qaed::UNDIRECTED to obtain MST");
 
+    QAED_STATS_SCOPE("mst_kruskal");
+
     std::vector<FullyEdge> heap;
-    fill_kruskall_heap(heap);
+    {
+      QAED_STATS_PHASE("fill heap");
+      fill_kruskall_heap(heap);
+      QAED_STATS_ADD(heap_pushes, heap.size());
+    }
 
     Graph<VertexTag, EdgeTag, UNDIRECTED> mst;
 
@@ -502,8 +741,15 @@ public:
     while (mst.no_edges() + 1 < m_no_vertexes && !heap.empty()) {
       std::pop_heap(heap.begin(), heap.end(), std::greater<FullyEdge>());
       min_edge = heap.back(); heap.pop_back();
+      QAED_STATS_ADD(heap_pops, 1);
+
+      bool cycle;
+      {
+        QAED_STATS_PHASE("cycle check");
+        cycle = mst.cycle_with(min_edge);
+      }
 
-      if (!mst.cycle_with(min_edge)) {
+      if (!cycle) {
         auto b = mst.add_vertex(min_edge.beg().get_data());
         auto e = mst.add_vertex(min_edge.end().get_data());
         mst.add_edge(std::get<0>(b), std::get<0>(e), min_edge.get_tag());
@@ -516,6 +762,8 @@ public:
   Graph<VertexTag, EdgeTag, UNDIRECTED> mst_prim() {
     static_assert(type == UNDIRECTED, "Graph needs to be qaed::UNDIRECTED to obtain MST");
 
+    QAED_STATS_SCOPE("mst_prim");
+
     std::vector<FullyEdge> heap;
     heap.reserve(m_no_edges/2);
 
@@ -526,6 +774,9 @@ public:
     }
     beg->mark();
 
+    std::make_heap(heap.begin(), heap.end(), std::greater<FullyEdge>());
+    QAED_STATS_ADD(heap_pushes, heap.size());
+
 
     Graph<VertexTag, EdgeTag, UNDIRECTED> mst;
 
@@ -533,14 +784,24 @@ public:
     while (mst.no_edges() + 1 < m_no_vertexes && !heap.empty()) {
       std::pop_heap(heap.begin(), heap.end(), std::greater<FullyEdge>());
       min_edge = heap.back(); heap.pop_back();
+      QAED_STATS_ADD(heap_pops, 1);
+
+      bool cycle;
+      {
+        QAED_STATS_PHASE("cycle check");
+        cycle = mst.cycle_with(min_edge);
+      }
 
-      if (!mst.cycle_with(min_edge)) {
+      if (!cycle) {
         auto b = mst.add_vertex(min_edge.beg().get_data());
         auto e = mst.add_vertex(min_edge.end().get_data());
         mst.add_edge(std::get<0>(b), std::get<0>(e), min_edge.get_tag());
       }
 
-      fill_prim_heap(heap, min_edge.end_itr());
+      {
+        QAED_STATS_PHASE("fill heap");
+        fill_prim_heap(heap, min_edge.end_itr());
+      }
     }
 
     reset_marks();
@@ -552,16 +813,93 @@ public:
     std::vector<Graph<VertexTag, EdgeTag, type>> components;
   }
 
-  void draw_it(const std::string& filename) {
+  /// Streams the graph in DOT format in a single pass, every edge
+  /// of an UNDIRECTED graph is written once
+  void write_dot(std::ostream& os, const std::string& name = "G") const {
+    StreamWriter out(os);
+
+    out.put(type == DIRECTED ? "digraph " : "graph ").quoted(name).put(" {\n");
+    out.put("  node [shape=circle];\n");
+
+    for (auto& v : m_g) {
+      out.put("  ").value(v.get_data(), true).put(";\n");
+    }
+
+    for (auto& v : m_g) {
+      for (auto& e : v.edges()) {
+        if constexpr (type == UNDIRECTED)
+          if (e.vertex() < v) continue;
+
+        out.put("  ").value(v.get_data(), true)
+           .put(type == DIRECTED ? " -> " : " -- ")
+           .value(e.vertex().get_data(), true)
+           .put(" [label=").value(e.get_tag(), true).put("];\n");
+      }
+    }
+
+    out.put("}\n");
+  }
+
+  void write_dot(const std::string& filename) const {
+    std::ofstream os(filename);
+    if (!os) throw std::runtime_error("Cannot open " + filename);
+    write_dot(os);
+  }
+
+  /// Streams {"directed", "vertexes", "edges": [[from, to, tag], ...]},
+  /// every edge of an UNDIRECTED graph is written once
+  void write_json(std::ostream& os) const {
+    StreamWriter out(os);
+
+    out.put("{\"directed\": ").value(type == DIRECTED).put(", \"vertexes\": [");
+
+    bool first = true;
+    for (auto& v : m_g) {
+      if (!first) out.put(", ");
+      out.json(v.get_data());
+      first = false;
+    }
+
+    out.put("], \"edges\": [");
+
+    first = true;
+    for (auto& v : m_g) {
+      for (auto& e : v.edges()) {
+        if constexpr (type == UNDIRECTED)
+          if (e.vertex() < v) continue;
+
+        out.put(first ? "\n  [" : ",\n  [")
+           .json(v.get_data()).put(", ")
+           .json(e.vertex().get_data()).put(", ")
+           .json(e.get_tag()).put(']');
+        first = false;
+      }
+    }
+
+    out.put("\n]}\n");
+  }
+
+  void write_json(const std::string& filename) const {
+    std::ofstream os(filename);
+    if (!os) throw std::runtime_error("Cannot open " + filename);
+    write_json(os);
+  }
+
+  /// Layout and render through GraphViz, the graph is handed over
+  /// as DOT text instead of being rebuilt node by node
+  void draw_it(const std::string& filename, const std::string& format = "png", bool xdgopen = false) {
     if (m_g.empty()) return;
 
+    std::ostringstream dot;
+    write_dot(dot);
+
     GVTool gv;
-    if constexpr (type == DIRECTED)
-      gv.createGraph("G", Agdirected);
-    else
-      gv.createGraph("G", Agundirected);
+    gv.readGraph(dot.str());
+    gv.layout("dot");
+    gv.renderToFile(format.c_str(), filename.c_str());
 
-    gv.defAttr(AGNODE, "shape", "circle");
+    if (xdgopen)
+      gv.xdgOpenFile(filename.c_str());
   }
 
 private:
@@ -596,6 +934,7 @@ private:
       if (ii->vertex().marked()) continue;
       heap.push_back(FullyEdge(v, ii->vertex_itr(), ii->get_tag()));
       std::push_heap(heap.begin(), heap.end(), std::greater<FullyEdge>());
+      QAED_STATS_ADD(heap_pushes, 1);
     }
     v->mark();
   }
@@ -608,13 +947,167 @@ private:
     while (!h.empty()) {
       temp = h.get_top();
       h.remove_top();
+      QAED_STATS_ADD(heap_pops, 1);
       if (!temp.vertex().marked()) return temp;
     }
 
     throw std::logic_error("Heap is empty");
   }
 
+  /// First position not less than key from it on. Sorted batches are
+  /// mostly local, so a few linear steps are tried before a full search
+  template <class Set, class Key>
+  static typename Set::iterator seek(Set& set, typename Set::iterator it, const Key& key) {
+    for (int step = 0; step < 8; ++step, ++it)
+      if (it == set.end() || !(*it < key)) return it;
+    return set.lower_bound(key);
+  }
+
+  struct BatchArc {
+    std::size_t from_rank;
+    std::size_t to_rank;
+    VertexItr   from;
+    VertexItr   to;
+    EdgeTag     tag;
+    bool        logged;
+  };
+
+  /// Edge insertions or removals grouped by source vertex and merged
+  /// into each adjacency in order. UNDIRECTED edges also go in reverse,
+  /// only the direction given in the batch is counted and logged.
+  void merge_edges(const std::vector<const GraphChange<VertexTag, EdgeTag>*>& ops, bool insert,
+                   GraphDelta<VertexTag, EdgeTag>& log) {
+    if (ops.empty()) return;
+
+    // Endpoints are looked up once, walking the vertex set in order
+    std::vector<VertexTag> keys;
+    keys.reserve(2 * ops.size());
+    for (auto* c : ops) { keys.push_back(c->from); keys.push_back(c->to); }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<VertexItr> found(keys.size());
+    VertexItr hint = m_g.begin();
+    for (std::size_t ii = 0; ii < keys.size(); ++ii) {
+      Vertex key(keys[ii]);
+      hint = seek(m_g, hint, key);
+      found[ii] = hint != m_g.end() && *hint == key ? hint : m_g.end();
+    }
+
+    auto rank = [&](const VertexTag& t) -> std::size_t {
+      return std::lower_bound(keys.begin(), keys.end(), t) - keys.begin();
+    };
+
+    std::vector<BatchArc> arcs;
+    arcs.reserve(type == UNDIRECTED ? 2 * ops.size() : ops.size());
+
+    for (auto* c : ops) {
+      std::size_t a = rank(c->from), b = rank(c->to);
+      if (found[a] == m_g.end() || found[b] == m_g.end()) continue;
+
+      arcs.push_back(BatchArc{ a, b, found[a], found[b], c->tag, true });
+      if (type == UNDIRECTED && a != b) arcs.push_back(BatchArc{ b, a, found[b], found[a], c->tag, false });
+    }
+
+    // Ranks follow the vertex order, so sorting them needs no lookups
+    std::stable_sort(arcs.begin(), arcs.end(), [](const BatchArc& x, const BatchArc& y) {
+      return x.from_rank < y.from_rank || (x.from_rank == y.from_rank && x.to_rank < y.to_rank);
+    });
+
+    for (std::size_t ii = 0; ii < arcs.size(); ) {
+      EdgeSet& edges = arcs[ii].from->edges();
+      EdgeItr  it    = edges.begin();
+
+      for (VertexItr src = arcs[ii].from; ii < arcs.size() && arcs[ii].from == src; ++ii) {
+        const BatchArc& arc = arcs[ii];
+        Edge key(arc.to, arc.tag);
+
+        it = seek(edges, it, key);
+        bool found = it != edges.end() && it->vertex_itr() == arc.to;
+
+        if (insert && !found) {
+          it = edges.emplace_hint(it, key);
+          if (arc.logged) { m_no_edges += 1; log.add_edge(arc.from->get_data(), arc.to->get_data(), arc.tag); }
+        } else if (!insert && found) {
+          if (arc.logged) { m_no_edges -= 1; log.remove_edge(arc.from->get_data(), arc.to->get_data(), it->get_tag()); }
+          it = edges.erase(it);
+        }
+      }
+    }
+  }
+
+  /// Drops every edge touching the vertexes with one pass over the
+  /// graph (DIRECTED) or over their neighbours (UNDIRECTED), then the
+  /// vertexes themselves
+  void remove_vertexes(const std::vector<const GraphChange<VertexTag, EdgeTag>*>& ops,
+                       GraphDelta<VertexTag, EdgeTag>& log) {
+    std::vector<VertexItr> gone;
+    VertexItr hint = m_g.begin();
+
+    for (auto* c : ops) {
+      Vertex key(c->from);
+      hint = seek(m_g, hint, key);
+      if (hint != m_g.end() && *hint == key && (gone.empty() || gone.back() != hint))
+        gone.push_back(hint);
+    }
+
+    if (gone.empty()) return;
+
+    auto removed = [&](const Vertex& v) {
+      return std::binary_search(gone.begin(), gone.end(), v,
+          [](auto& x, auto& y) { return deref(x) < deref(y); });
+    };
+
+    for (VertexItr v : gone) {
+      for (auto& e : v->edges()) {
+        // An edge between two removed vertexes is logged by its lower end
+        if (type == UNDIRECTED && removed(e.vertex()) && e.vertex() < *v) continue;
+
+        log.remove_edge(v->get_data(), e.vertex().get_data(), e.get_tag());
+        m_no_edges -= 1;
+
+        if (type == UNDIRECTED && e.vertex_itr() != v) e.vertex().edges().erase(Edge(v));
+      }
+      v->edges().clear();
+    }
+
+    if constexpr (type == DIRECTED) {
+      for (VertexItr u = m_g.begin(); u != m_g.end(); ++u) {
+        if (removed(*u) || u->edges().empty()) continue;
+
+        EdgeSet& edges = u->edges();
+        if (edges.size() <= gone.size()) {
+          for (EdgeItr e = edges.begin(); e != edges.end(); ) {
+            if (!removed(e->vertex())) { ++e; continue; }
+            log.remove_edge(u->get_data(), e->vertex().get_data(), e->get_tag());
+            m_no_edges -= 1;
+            e = edges.erase(e);
+          }
+        } else {
+          for (VertexItr v : gone) {
+            EdgeItr e = edges.find(Edge(v));
+            if (e == edges.end()) continue;
+            log.remove_edge(u->get_data(), v->get_data(), e->get_tag());
+            m_no_edges -= 1;
+            edges.erase(e);
+          }
+        }
+      }
+    }
+
+    for (VertexItr v : gone) {
+      log.remove_vertex(v->get_data());
+      m_g.erase(v);
+      m_no_vertexes -= 1;
+    }
+  }
+
+  static const Vertex& deref(const Vertex& v)    { return v; }
+  static const Vertex& deref(const VertexItr& v) { return *v; }
+
   void reset_marks() {
+    QAED_STATS_ADD(mark_resets, 1);
     for (VertexItr ii = m_g.begin(); ii != m_g.end(); ++ii)
       ii->unmark();
   }
@@ -3,16 +3,28 @@
 
 #include <map>
 #include <tuple>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
 
-// TODO:
-// - Add swap rows, cols
-// - Remove row and col
-// - Remove an element in pos(i,j)
+#include "tools/NodePool.hpp"
+#include "tools/StreamWriter.hpp"
 
 namespace qaed {
 
+/// Orthogonal list sparse matrix: every element is linked in its row
+/// (by column) and in its column (by row), both lists sorted and
+/// doubly linked. Nodes come from a NodePool, so building and
+/// dropping a matrix costs a few big allocations instead of one per
+/// element.
 template <class Type>
 class Matrix {
 public:
@@ -29,48 +41,89 @@ private:
 
     Type  data;
     Point position;
-    Node* next_col;
-    Node* next_row;
+    Node* next_col = nullptr;   // along the row
+    Node* prev_col = nullptr;
+    Node* next_row = nullptr;   // along the column
+    Node* prev_row = nullptr;
 
-    Node(Type&& data, const Point& position)      : data(data), position(position) {}
+    Node(Type&& data, const Point& position)      : data(std::move(data)), position(position) {}
     Node(const Type& data, const Point& position) : data(data), position(position) {}
-
-    Node(Type&& data, const Size_t& x, const Size_t& y)      : data(data), position(std::make_tuple(x,y)) {}
-    Node(const Type& data, const Size_t& x, const Size_t& y) : data(data), position(std::make_tuple(x,y)) {}
   };
 
   Size_t m_no_rows;
   Size_t m_no_cols;
 
-  Node** m_rows;
-  Node** m_cols;
+  std::vector<Node*> m_rows;
+  std::vector<Node*> m_cols;
+  NodePool<Node>     m_pool;
 
 public:
-  Matrix(const Size_t& rows, const Size_t& cols): m_no_rows(rows), m_no_cols(cols) {
-    m_rows = new Node*[rows];
-    m_cols = new Node*[cols];
+  Matrix(const Size_t& rows, const Size_t& cols): m_no_rows(rows), m_no_cols(cols), m_rows(rows, nullptr), m_cols(cols, nullptr) {}
+
+  /// O(nnz), rows are copied in order and appended at the column tails
+  Matrix(const Matrix& m) : Matrix(m.m_no_rows, m.m_no_cols) {
+    std::vector<Node*> row_tail(m_no_rows, nullptr), col_tail(m_no_cols, nullptr);
+    m.for_each([&](Size_t row, Size_t col, const Type& data) {
+      Node* n = m_pool.create(data, std::make_tuple(row, col));
+      link_after(n, row_tail[row], col_tail[col]);
+      row_tail[row] = col_tail[col] = n;
+    });
+  }
+
+  Matrix(Matrix&& m) noexcept :
+    m_no_rows(m.m_no_rows), m_no_cols(m.m_no_cols),
+    m_rows(std::move(m.m_rows)), m_cols(std::move(m.m_cols)), m_pool(std::move(m.m_pool)) {
+    m.m_no_rows = m.m_no_cols = 0;
+    m.m_rows.clear();
+    m.m_cols.clear();
+  }
+
+  Matrix& operator=(Matrix m) {
+    swap(m);
+    return *this;
+  }
 
-    for (Size_t ii = 0; ii < rows; ++ii)
-      m_rows[ii] = 0;
+ ~Matrix() { clear(); }
 
-    for (Size_t ii = 0; ii < cols; ++ii)
-      m_cols[ii] = 0;
+  void swap(Matrix& m) noexcept {
+    std::swap(m_no_rows, m.m_no_rows);
+    std::swap(m_no_cols, m.m_no_cols);
+    m_rows.swap(m.m_rows);
+    m_cols.swap(m.m_cols);
+    std::swap(m_pool, m.m_pool);
   }
 
- ~Matrix() {}
+  /// Removes every element, the dimensions stay. O(1) per slab when
+  /// Type doesn't need a destructor, O(nnz) otherwise.
+  void clear() {
+    if (!std::is_trivially_destructible<Type>::value)
+      for (Node* head : m_rows)
+        for (Node* n = head; n; ) {
+          Node* next = n->next_col;
+          m_pool.destroy(n);
+          n = next;
+        }
 
+    m_pool.release();
+    std::fill(m_rows.begin(), m_rows.end(), nullptr);
+    std::fill(m_cols.begin(), m_cols.end(), nullptr);
+  }
+
+  /// Inserted at its place in the row and in the column, false if the
+  /// position is taken or out of the matrix. O(row + col length), O(1)
+  /// when it goes in front of both (e.g. filling backwards)
   bool add(const Type& data, const Point& pos) {
-    Node** r;
-    Node** c;
+    Size_t row = std::get<ROW>(pos);
+    Size_t col = std::get<COL>(pos);
 
-    if (find_by_row(pos, c)) return false;
-    find_by_col(pos, r);
+    if (row >= m_no_rows || col >= m_no_cols) return false;
 
-    Node* tmp = new Node(data, pos);
-    tmp->next_row = *r;
-    tmp->next_col = *c;
-    (*r) = (*c) = tmp;
+    Node* left = before_in_row(row, col);
+    Node* at   = left ? left->next_col : m_rows[row];
+    if (at && std::get<COL>(at->position) == col) return false;
 
+    Node* n = m_pool.create(data, pos);
+    link_after(n, left, before_in_col(col, row));
     return true;
   }
 
@@ -79,17 +132,11 @@ public:
   }
 
   bool remove(const Point& pos) {
-    Node** r;
-    Node** c;
-
-    if (!find_by_row(pos, c)) return false;
-    find_by_col(pos, r);
-
-    Node* tmp = *r;
-    (*r) = tmp->next_row;
-    (*c) = tmp->next_col;
-    delete tmp;
+    Node* n = find_node(pos);
+    if (!n) return false;
 
+    unlink(n);
+    m_pool.destroy(n);
     return true;
   }
 
@@ -97,79 +144,288 @@ public:
     return remove(makePoint(row, col));
   }
 
-  bool find(const Point& pos) {
-    Node** tmp;
-    return find_by_col(pos, tmp);
+  bool find(const Point& pos) const {
+    return find_node(pos) != nullptr;
   }
 
-  bool find(const Size_t& row, const Size_t& col) {
-    return find(makePoint(row, col));
+  bool find(const Size_t& row, const Size_t& col) const {
+    return find(std::make_tuple(row, col));
   }
 
   Type& get(const Point& pos) {
-    Node** tmp;
+    if (std::get<ROW>(pos) >= m_no_rows) throw std::out_of_range("rows out of range");
+    if (std::get<COL>(pos) >= m_no_cols) throw std::out_of_range("cols out of range");
 
-    if (!find_by_col(pos, tmp))
-      throw std::runtime_error("Cannot find element at pos " + 
-          std::to_string(std::get<COL>(pos)) +
-          std::to_string(std::get<ROW>(pos)));
+    Node* n = find_node(pos);
+    if (!n)
+      throw std::runtime_error("Cannot find element at pos " +
+          std::to_string(std::get<ROW>(pos)) + ", " +
+          std::to_string(std::get<COL>(pos)));
 
-    return (*tmp)->data;
+    return n->data;
   }
 
   Type& get(const Size_t& row, const Size_t& col) {
     return get(makePoint(row, col));
   }
 
-  void print(std::ostream& os = std::cout) {
-    Node** tmp;
+  /// Exchanges rows a and b walking both together by column. Common
+  /// columns only swap values, the other elements change row list in
+  /// place and slide along their column past the rows in between:
+  /// O(nnz of both rows + column elements between a and b). The slide
+  /// is what keeps the column lists sorted by row, so the bound isn't
+  /// O(nnz of the rows) unless a and b are adjacent in every column.
+  void swap_rows(Size_t a, Size_t b) {
+    if (a >= m_no_rows || b >= m_no_rows) throw std::out_of_range("rows out of range");
+    if (a == b) return;
+
+    Node* pa = m_rows[a];
+    Node* pb = m_rows[b];
+    Node* la = nullptr;   // last nodes of a and b left of the walk
+    Node* lb = nullptr;
+
+    while (pa || pb) {
+      Size_t ca = pa ? std::get<COL>(pa->position) : m_no_cols;
+      Size_t cb = pb ? std::get<COL>(pb->position) : m_no_cols;
+
+      if (ca == cb) {
+        std::swap(pa->data, pb->data);
+        la = pa; pa = pa->next_col;
+        lb = pb; pb = pb->next_col;
+      } else if (ca < cb) {
+        Node* n = pa;
+        pa = pa->next_col;
+        move_to_row(n, b, lb);
+        lb = n;
+      } else {
+        Node* n = pb;
+        pb = pb->next_col;
+        move_to_row(n, a, la);
+        la = n;
+      }
+    }
+  }
+
+  /// Same as swap_rows for columns, O(nnz of both columns + row
+  /// elements between a and b)
+  void swap_cols(Size_t a, Size_t b) {
+    if (a >= m_no_cols || b >= m_no_cols) throw std::out_of_range("cols out of range");
+    if (a == b) return;
+
+    Node* pa = m_cols[a];
+    Node* pb = m_cols[b];
+    Node* ua = nullptr;
+    Node* ub = nullptr;
+
+    while (pa || pb) {
+      Size_t ra = pa ? std::get<ROW>(pa->position) : m_no_rows;
+      Size_t rb = pb ? std::get<ROW>(pb->position) : m_no_rows;
+
+      if (ra == rb) {
+        std::swap(pa->data, pb->data);
+        ua = pa; pa = pa->next_row;
+        ub = pb; pb = pb->next_row;
+      } else if (ra < rb) {
+        Node* n = pa;
+        pa = pa->next_row;
+        move_to_col(n, b, ub);
+        ub = n;
+      } else {
+        Node* n = pb;
+        pb = pb->next_row;
+        move_to_col(n, a, ua);
+        ua = n;
+      }
+    }
+  }
 
+  /// Removes every element of the row, the dimensions don't change.
+  /// O(nnz of the row), the column lists are doubly linked.
+  void remove_row(Size_t row) {
+    if (row >= m_no_rows) throw std::out_of_range("rows out of range");
+
+    for (Node* n = m_rows[row]; n; ) {
+      Node* next = n->next_col;
+      unlink_from_col(n);
+      m_pool.destroy(n);
+      n = next;
+    }
+    m_rows[row] = nullptr;
+  }
+
+  /// Removes every element of the column, O(nnz of the column)
+  void remove_col(Size_t col) {
+    if (col >= m_no_cols) throw std::out_of_range("cols out of range");
+
+    for (Node* n = m_cols[col]; n; ) {
+      Node* next = n->next_row;
+      unlink_from_row(n);
+      m_pool.destroy(n);
+      n = next;
+    }
+    m_cols[col] = nullptr;
+  }
+
+  /// Stored elements
+  std::size_t nnz() const { return m_pool.size(); }
+
+  void print(std::ostream& os = std::cout) const {
     for (Size_t row = 0; row < m_no_rows; ++row) {
+      Node* n = m_rows[row];
       for (Size_t col = 0; col < m_no_cols; ++col) {
-        if (find_by_col(makePoint(row, col), tmp))
-          os << (*tmp)->data << " ";
-        else
+        if (n && std::get<COL>(n->position) == col) {
+          os << n->data << " ";
+          n = n->next_col;
+        } else {
           os << "0 ";
+        }
       }
       os << std::endl;
     }
   }
 
-  void printLn(std::ostream& os = std::cout) {
+  void printLn(std::ostream& os = std::cout) const {
     print(os); os << std::endl;
   }
 
+  /// f(row, col, data) for every element, by row and then by column
+  template <class Function>
+  void for_each(Function&& f) const {
+    for (Size_t row = 0; row < m_no_rows; ++row)
+      for (Node* n = m_rows[row]; n; n = n->next_col)
+        f(std::get<ROW>(n->position), std::get<COL>(n->position), n->data);
+  }
+
+  /// f(col, data) by increasing col
+  template <class Function>
+  void for_each_in_row(Size_t row, Function&& f) const {
+    if (row >= m_no_rows) throw std::out_of_range("rows out of range");
+    for (Node* n = m_rows[row]; n; n = n->next_col) f(std::get<COL>(n->position), n->data);
+  }
+
+  /// f(row, data) by increasing row
+  template <class Function>
+  void for_each_in_col(Size_t col, Function&& f) const {
+    if (col >= m_no_cols) throw std::out_of_range("cols out of range");
+    for (Node* n = m_cols[col]; n; n = n->next_row) f(std::get<ROW>(n->position), n->data);
+  }
+
+  const Size_t& noRows() const { return m_no_rows; }
+  const Size_t& noCols() const { return m_no_cols; }
+
 private:
 
-  bool find_by_row(const Point& pos, Node**& n) {
-    n = &(m_rows[std::get<ROW>(pos)]);
+  Node* find_node(const Point& pos) const {
+    Size_t row = std::get<ROW>(pos);
+    Size_t col = std::get<COL>(pos);
 
-    while (*n) {
-      if (std::get<COL>((*n)->position) == std::get<COL>(pos)) return true;
-      if (std::get<COL>((*n)->position)  > std::get<COL>(pos)) return false;
+    if (row >= m_no_rows || col >= m_no_cols) return nullptr;
 
-      n = &((*n)->next_col);
+    for (Node* n = m_rows[row]; n; n = n->next_col) {
+      if (std::get<COL>(n->position) == col) return n;
+      if (std::get<COL>(n->position)  > col) return nullptr;
     }
 
-    return false;
+    return nullptr;
   }
 
-  bool find_by_col(const Point& pos, Node**& n) {
-    n = &(m_rows[std::get<COL>(pos)]);
+  /// Last node of the row with a column below col, nullptr if none
+  Node* before_in_row(Size_t row, Size_t col) const {
+    Node* prev = nullptr;
+    for (Node* n = m_rows[row]; n && std::get<COL>(n->position) < col; n = n->next_col) prev = n;
+    return prev;
+  }
+
+  /// Last node of the column with a row below row, nullptr if none
+  Node* before_in_col(Size_t col, Size_t row) const {
+    Node* prev = nullptr;
+    for (Node* n = m_cols[col]; n && std::get<ROW>(n->position) < row; n = n->next_row) prev = n;
+    return prev;
+  }
+
+  /// Links n after left in its row and after up in its column, nullptr
+  /// meaning at the head
+  void link_after(Node* n, Node* left, Node* up) {
+    link_in_row(n, left);
+    link_in_col(n, up);
+  }
 
-    while (*n) {
-      if (std::get<ROW>((*n)->position) == std::get<ROW>(pos)) return true;
-      if (std::get<ROW>((*n)->position)  > std::get<ROW>(pos)) return false;
+  void link_in_row(Node* n, Node* left) {
+    Node*& head = m_rows[std::get<ROW>(n->position)];
 
-      n = &((*n)->next_row);
+    n->prev_col = left;
+    n->next_col = left ? left->next_col : head;
+    if (n->next_col) n->next_col->prev_col = n;
+    (left ? left->next_col : head) = n;
+  }
+
+  void link_in_col(Node* n, Node* up) {
+    Node*& head = m_cols[std::get<COL>(n->position)];
+
+    n->prev_row = up;
+    n->next_row = up ? up->next_row : head;
+    if (n->next_row) n->next_row->prev_row = n;
+    (up ? up->next_row : head) = n;
+  }
+
+  void unlink(Node* n) {
+    unlink_from_row(n);
+    unlink_from_col(n);
+  }
+
+  void unlink_from_row(Node* n) {
+    (n->prev_col ? n->prev_col->next_col : m_rows[std::get<ROW>(n->position)]) = n->next_col;
+    if (n->next_col) n->next_col->prev_col = n->prev_col;
+  }
+
+  void unlink_from_col(Node* n) {
+    (n->prev_row ? n->prev_row->next_row : m_cols[std::get<COL>(n->position)]) = n->next_row;
+    if (n->next_row) n->next_row->prev_row = n->prev_row;
+  }
+
+  /// Puts n in row after left (nullptr at the head), then moves it
+  /// along its column to its new place
+  void move_to_row(Node* n, Size_t row, Node* left) {
+    unlink_from_row(n);
+    std::get<ROW>(n->position) = row;
+    link_in_row(n, left);
+
+    Node* up = n->prev_row;
+    Node* down = n->next_row;
+
+    if (down && std::get<ROW>(down->position) < row) {
+      while (down->next_row && std::get<ROW>(down->next_row->position) < row) down = down->next_row;
+      unlink_from_col(n);
+      link_in_col(n, down);
+    } else if (up && std::get<ROW>(up->position) > row) {
+      while (up->prev_row && std::get<ROW>(up->prev_row->position) > row) up = up->prev_row;
+      unlink_from_col(n);
+      link_in_col(n, up->prev_row);
     }
+  }
 
-    return false;
+  /// Same as move_to_row for columns
+  void move_to_col(Node* n, Size_t col, Node* up) {
+    unlink_from_col(n);
+    std::get<COL>(n->position) = col;
+    link_in_col(n, up);
+
+    Node* left  = n->prev_col;
+    Node* right = n->next_col;
+
+    if (right && std::get<COL>(right->position) < col) {
+      while (right->next_col && std::get<COL>(right->next_col->position) < col) right = right->next_col;
+      unlink_from_row(n);
+      link_in_row(n, right);
+    } else if (left && std::get<COL>(left->position) > col) {
+      while (left->prev_col && std::get<COL>(left->prev_col->position) > col) left = left->prev_col;
+      unlink_from_row(n);
+      link_in_row(n, left->prev_col);
+    }
   }
 
 };
 
-
 template <class Type, Type def, class SizeT = unsigned long>
 class FastMatrix {
 public:
@@ -277,6 +533,32 @@ public:
     remove(makePoint(row, col));
   }
 
+  /// Exchanges rows a and b by relabelling their maps, O(log rows)
+  void swap_rows(Size_t a, Size_t b) {
+    if (a >= m_no_rows || b >= m_no_rows) throw std::out_of_range("rows out of range");
+    if (a != b) swap_keys(m_matrix, a, b);
+  }
+
+  /// Exchanges cols a and b in every row, O(rows log cols)
+  void swap_cols(Size_t a, Size_t b) {
+    if (a >= m_no_cols || b >= m_no_cols) throw std::out_of_range("cols out of range");
+    if (a == b) return;
+
+    for (auto& row : m_matrix) swap_keys(row.second, a, b);
+  }
+
+  /// Removes every element of the row, the dimensions don't change
+  void remove_row(Size_t row) {
+    if (row >= m_no_rows) throw std::out_of_range("rows out of range");
+    m_matrix.erase(row);
+  }
+
+  /// Removes every element of the column, O(rows log cols)
+  void remove_col(Size_t col) {
+    if (col >= m_no_cols) throw std::out_of_range("cols out of range");
+    for (auto& row : m_matrix) row.second.erase(col);
+  }
+
   void print(std::ostream& os = std::cout) {
     RowIterator rit;
     ColIterator cit;
@@ -297,92 +579,247 @@ public:
     print(os); os << std::endl;
   }
 
-  void write(const std::string filename, bool binary = true) {
-    RowIterator rit;
-    ColIterator cit;
+  /// Streams the stored elements only, by row and then by column, in
+  /// blocks. Binary files start with "QAFM", the format version, the
+  /// byte order (1 little, 2 big endian), sizeof(Size_t), sizeof(Type)
+  /// and then rows, cols and nnz, every element is (row, col, data).
+  /// Text files start with a "QAFM version rows cols nnz" line.
+  void write(const std::string filename, bool binary = true) const {
+    std::ofstream out(filename, binary ? std::ios::out | std::ios::binary : std::ios::out);
+    if (!out) throw std::runtime_error("Cannot open " + filename);
+
+    StreamWriter w(out);
 
     if (binary) {
-      std::fstream out(filename, std::ios::out | std::ios::binary);
-
-      char* tmp;
-
-      tmp = (char*) &m_no_rows;
-      out.write(tmp, sizeof(Size_t));
-      tmp = (char*) &m_no_cols;
-      out.write(tmp, sizeof(Size_t));
-      for (Size_t ii = 0; ii< m_no_rows; ++ii) {
-        for (Size_t jj = 0; jj < m_no_cols; ++jj) {
-          if (find(makePoint(ii,jj), rit, cit)) {
-            tmp = (char*) &(cit->second);
-            out.write(tmp, sizeof(Type));
-            tmp = (char*) &ii;
-            out.write(tmp, sizeof(Size_t));
-            tmp = (char*) &jj;
-            out.write(tmp, sizeof(Size_t));
-          }
-        }
-      }
+      const char head[8] = { 'Q', 'A', 'F', 'M', FILE_VERSION, char(little_endian() ? 1 : 2),
+                             char(sizeof(Size_t)), char(sizeof(Type)) };
+      w.put(std::string_view(head, sizeof(head)));
+
+      put_raw(w, m_no_rows);
+      put_raw(w, m_no_cols);
+      put_raw(w, nnz());
+      for_each([&](const Size_t& row, const Size_t& col, const Type& data) {
+        put_raw(w, row);
+        put_raw(w, col);
+        put_raw(w, data);
+      });
+    } else {
+      w.put("QAFM ").value(int(FILE_VERSION)).put(' ').value(m_no_rows).put(' ').value(m_no_cols)
+       .put(' ').value(nnz()).put('\n');
+
+      for_each([&](const Size_t& row, const Size_t& col, const Type& data) {
+        w.value(row).put(' ').value(col).put(' ');
+        put_text(w, data);
+        w.put('\n');
+      });
+    }
+  }
+
+  /// Replaces the matrix with the file content. Files without the
+  /// header are read in the old layout (data, row, col), a truncated
+  /// trailing element is ignored there instead of being added.
+  void read(const std::string filename, bool binary = true) {
+    std::ifstream in(filename, binary ? std::ios::in | std::ios::binary : std::ios::in);
+    if (!in) throw std::runtime_error("Cannot open " + filename);
+
+    m_matrix.clear();
+    if (binary) read_binary(in);
+    else        read_text(in);
+  }
+
+  /// Number of stored elements
+  Size_t nnz() const {
+    Size_t n = 0;
+    for (auto& row : m_matrix) n += row.second.size();
+    return n;
+  }
 
+  /// f(row, col, data) for every stored element, by row and then by column
+  template <class Function>
+  void for_each(Function&& f) const {
+    for (auto& row : m_matrix)
+      for (auto& col : row.second)
+        f(row.first, col.first, col.second);
+  }
+
+  Type get_default() const { return def; }
+
+  const Size_t& noRows() const { return m_no_rows; }
+  const Size_t& noCols() const { return m_no_cols; }
+
+private:
+
+  static constexpr char        FILE_VERSION = 1;
+  static constexpr std::size_t FILE_BLOCK   = 1 << 16;
+
+  static bool little_endian() {
+    const std::uint16_t probe = 1;
+    return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+  }
+
+  template <class T>
+  static void put_raw(StreamWriter& w, const T& v) {
+    w.put(std::string_view(reinterpret_cast<const char*>(&v), sizeof(T)));
+  }
+
+  /// Integers are written as numbers, bool and the char types
+  /// included, so that read_text gets them back with operator>>
+  template <class T>
+  static void put_text(StreamWriter& w, const T& v) {
+    if constexpr (std::is_integral<T>::value) w.value(+v);
+    else                                      w.value(v);
+  }
+
+  /// Reads what put_text wrote, integers narrower than long long go
+  /// through it and must fit in T
+  template <class T>
+  static bool get_text(std::istream& in, T& v) {
+    if constexpr (std::is_integral<T>::value && sizeof(T) < sizeof(long long)) {
+      long long wide;
+      if (!(in >> wide)) return false;
+      if (wide < static_cast<long long>(std::numeric_limits<T>::min()) ||
+          wide > static_cast<long long>(std::numeric_limits<T>::max()))
+        throw std::runtime_error("FastMatrix file value out of range");
+      v = static_cast<T>(wide);
+      return true;
     } else {
-      std::fstream out(filename, std::ios::out);
+      return bool(in >> v);
+    }
+  }
+
+  /// Unsigned integer of `width` bytes stored with the given byte order
+  static std::uint64_t decode_uint(const char* p, unsigned width, bool little) {
+    std::uint64_t v = 0;
+    for (unsigned ii = 0; ii < width; ++ii)
+      v |= std::uint64_t(static_cast<unsigned char>(p[little ? ii : width - 1 - ii])) << (8 * ii);
+    return v;
+  }
+
+  static Size_t decode_size(const char* p, unsigned width, bool little) {
+    std::uint64_t v = decode_uint(p, width, little);
+    if (v > std::uint64_t(std::numeric_limits<Size_t>::max()))
+      throw std::runtime_error("FastMatrix file value doesn't fit in Size_t");
+    return Size_t(v);
+  }
+
+  /// Moves the entries of keys a and b to each other's key, no copy
+  template <class Map>
+  static void swap_keys(Map& m, Size_t a, Size_t b) {
+    auto na = m.extract(a);
+    auto nb = m.extract(b);
+    if (!na.empty()) { na.key() = b; m.insert(std::move(na)); }
+    if (!nb.empty()) { nb.key() = a; m.insert(std::move(nb)); }
+  }
+
+  /// Elements come sorted, the hints make every insertion O(1)
+  void append(const Size_t& row, const Size_t& col, const Type& data) {
+    if (row >= m_no_rows || col >= m_no_cols) return;
+
+    auto rit = m_matrix.try_emplace(m_matrix.end(), row);
+    rit->second.try_emplace(rit->second.end(), col, data);
+  }
+
+  void read_binary(std::istream& in) {
+    char head[8];
+    in.read(head, sizeof(head));
+
+    if (in.gcount() != sizeof(head) || !std::equal(head, head + 4, "QAFM")) {
+      read_legacy(in);
+      return;
+    }
+
+    if (head[4] != FILE_VERSION)      throw std::runtime_error("Unsupported FastMatrix file version");
+    if (head[5] != 1 && head[5] != 2) throw std::runtime_error("Bad byte order mark in FastMatrix file");
+
+    const bool     little = head[5] == 1;
+    const bool     swap   = little != little_endian();
+    const unsigned width  = static_cast<unsigned char>(head[6]);
+
+    if (width == 0 || width > 8)                                throw std::runtime_error("Bad Size_t width in FastMatrix file");
+    if (static_cast<unsigned char>(head[7]) != sizeof(Type))   throw std::runtime_error("FastMatrix file holds another element type");
+
+    char sizes[24];
+    in.read(sizes, 3 * width);
+    if (in.gcount() != std::streamsize(3 * width)) throw std::runtime_error("Truncated FastMatrix file");
+
+    m_no_rows  = decode_size(sizes, width, little);
+    m_no_cols  = decode_size(sizes + width, width, little);
+    Size_t nnz = decode_size(sizes + 2 * width, width, little);
+
+    const std::size_t record = 2 * width + sizeof(Type);
+    std::vector<char> block(FILE_BLOCK / record * record + record);
+
+    while (nnz > 0) {
+      std::size_t count = std::min<std::size_t>(nnz, block.size() / record);
+      in.read(block.data(), count * record);
+      if (in.gcount() != std::streamsize(count * record)) throw std::runtime_error("Truncated FastMatrix file");
+
+      for (const char* p = block.data(); p != block.data() + count * record; p += record) {
+        char raw[sizeof(Type)];
+        std::copy(p + 2 * width, p + record, raw);
+        if (swap) std::reverse(raw, raw + sizeof(Type));
 
-      out << m_no_rows << ' ' << m_no_cols << ' ';
-      for (Size_t ii = 0; ii < m_no_rows; ++ii) {
-        for (Size_t jj = 0; jj < m_no_cols; ++jj)
-          if (find(makePoint(ii,jj), rit, cit))
-            out << cit->second << ' ' << ii << ' ' << jj << ' ';
+        Type data;
+        std::memcpy(&data, raw, sizeof(Type));
+        append(decode_size(p, width, little), decode_size(p + width, width, little), data);
       }
+
+      nnz -= count;
     }
   }
 
-  void read(const std::string filename, bool binary = true) {
-    if (binary) {
-      std::fstream in(filename, std::ios::in | std::ios::binary);
-
-      char* tmp_sizet = new char[sizeof(Size_t)];
-      char* tmp_type  = new char[sizeof(Type)];
-
-      in.read(tmp_sizet, sizeof(Size_t));
-      m_no_rows = *((Size_t*) tmp_sizet);
-
-      in.read(tmp_sizet, sizeof(Size_t));
-      m_no_cols = *((Size_t*) tmp_sizet);
-
-      Size_t row, col;
-      Type   data;
-      while (in) {
-        in.read(tmp_type, sizeof(Type));
-        data = *((Type*) tmp_type);
-        in.read(tmp_sizet, sizeof(Size_t));
-        row = *((Size_t*) tmp_sizet);
-        in.read(tmp_sizet, sizeof(Size_t));
-        col = *((Size_t*) tmp_sizet);
-        add(data, row, col);
-      }
+  /// Old layout: rows, cols, then (data, row, col) until the end
+  void read_legacy(std::istream& in) {
+    in.clear();
+    in.seekg(0);
 
-      delete[] tmp_sizet;
-      delete[] tmp_type;
+    in.read(reinterpret_cast<char*>(&m_no_rows), sizeof(Size_t));
+    in.read(reinterpret_cast<char*>(&m_no_cols), sizeof(Size_t));
+    if (!in) throw std::runtime_error("Truncated FastMatrix file");
 
-    } else {
-      std::fstream in(filename, std::ios::in);
+    const std::size_t record = sizeof(Type) + 2 * sizeof(Size_t);
+    std::vector<char> block(FILE_BLOCK / record * record + record);
 
-      in >> m_no_rows >> m_no_cols;
+    while (in) {
+      in.read(block.data(), block.size());
+      std::size_t count = std::size_t(in.gcount()) / record;
 
-      Size_t row, col;
-      Type   data;
-      while (in) {
-        in >> data >> row >> col;
+      for (const char* p = block.data(); p != block.data() + count * record; p += record) {
+        Type   data;
+        Size_t row, col;
+        std::memcpy(&data, p, sizeof(Type));
+        std::memcpy(&row, p + sizeof(Type), sizeof(Size_t));
+        std::memcpy(&col, p + sizeof(Type) + sizeof(Size_t), sizeof(Size_t));
         add(data, row, col);
       }
     }
   }
 
-  Type get_default() const { return def; }
+  void read_text(std::istream& in) {
+    Size_t row, col;
+    Type   data;
 
-  const Size_t& noRows() const { return m_no_rows; }
-  const Size_t& noCols() const { return m_no_cols; }
+    in >> std::ws;
+    if (in.peek() != 'Q') {
+      in >> m_no_rows >> m_no_cols;
+      while (in >> data >> row >> col)
+        add(data, row, col);
+      return;
+    }
 
-private:
+    std::string magic;
+    int         version;
+    Size_t      nnz;
+
+    in >> magic >> version >> m_no_rows >> m_no_cols >> nnz;
+    if (!in || magic != "QAFM")   throw std::runtime_error("Bad FastMatrix text header");
+    if (version != FILE_VERSION) throw std::runtime_error("Unsupported FastMatrix file version");
+
+    for (; nnz > 0; --nnz) {
+      if (!(in >> row >> col) || !get_text(in, data)) throw std::runtime_error("Truncated FastMatrix file");
+      append(row, col, data);
+    }
+  }
 
   bool find(const Point& pos, RowIterator& rit, ColIterator& cit) {
     Size_t row = std::get<ROW>(pos);
@@ -0,0 +1,298 @@
+#ifndef QAED_CSR_GRAPH_H
+#define QAED_CSR_GRAPH_H
+
+#include <tuple>
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../Graph.hpp"
+
+namespace qaed {
+
+/// Immutable snapshot of a Graph in compressed sparse row form.
+/// Vertexes are renamed to dense ids [0, no_vertexes()), every id
+/// keeps its original tag in label(id). Neighbours of a vertex are
+/// stored contiguously and sorted by id, tags live in a parallel
+/// array. UNDIRECTED graphs store both directions of every edge,
+/// so no_edges() counts arcs, not edges.
+template <class VertexTag, class EdgeTag>
+class CSRGraph {
+public:
+  using Id     = std::uint32_t;
+  using Offset = std::size_t;
+  using Arc    = std::tuple<Id, Id, EdgeTag>;
+
+  static constexpr Id NONE = ~Id(0);
+
+private:
+  std::vector<VertexTag> m_labels;
+  std::vector<Id>        m_by_label;
+  std::vector<Offset>    m_offsets;
+  std::vector<Id>        m_targets;
+  std::vector<EdgeTag>   m_tags;
+  bool                   m_directed;
+
+public:
+  CSRGraph() : m_offsets(1, 0), m_directed(true) {}
+
+  template <G_TYPE type>
+  explicit CSRGraph(const Graph<VertexTag, EdgeTag, type>& g) : m_directed(type == DIRECTED) {
+    m_labels.reserve(g.no_vertexes());
+    for (auto& v : g)
+      m_labels.push_back(v.get_data());
+
+    m_offsets.reserve(m_labels.size() + 1);
+    m_offsets.push_back(0);
+
+    // Vertexes and edges of Graph are ordered by tag, so ids
+    // are already sorted inside each adjacency
+    for (auto& v : g) {
+      for (auto& e : v.edges()) {
+        m_targets.push_back(lower_label(e.vertex().get_data()));
+        m_tags.push_back(e.get_tag());
+      }
+      m_offsets.push_back(m_targets.size());
+    }
+
+    m_by_label.resize(m_labels.size());
+    std::iota(m_by_label.begin(), m_by_label.end(), 0);
+  }
+
+  /// Takes ready made arrays, every row of targets needs to be sorted
+  CSRGraph(std::vector<VertexTag> labels, std::vector<Offset> offsets, std::vector<Id> targets,
+           std::vector<EdgeTag> tags, bool directed) :
+    m_labels(std::move(labels)),
+    m_offsets(std::move(offsets)),
+    m_targets(std::move(targets)),
+    m_tags(std::move(tags)),
+    m_directed(directed) {
+    if (m_offsets.size() != m_labels.size() + 1 || m_offsets.back() != m_targets.size() || m_tags.size() != m_targets.size())
+      throw std::invalid_argument("Inconsistent CSR arrays");
+
+    index_labels();
+  }
+
+  /// Bulk builder, arcs don't need to be sorted. When directed is
+  /// false every arc is also inserted reversed. Parallel arcs are
+  /// kept, use dedup = true to keep only the first one (as Graph does)
+  static CSRGraph from_arcs(std::vector<VertexTag> labels, const std::vector<Arc>& arcs, bool directed, bool dedup = true) {
+    CSRGraph g;
+    g.m_labels   = std::move(labels);
+    g.m_directed = directed;
+
+    Id n = g.m_labels.size();
+    g.m_offsets.assign(n + 1, 0);
+
+    for (auto& a : arcs) {
+      if (std::get<0>(a) >= n || std::get<1>(a) >= n)
+        throw std::out_of_range("Arc with an unknown vertex id");
+
+      g.m_offsets[std::get<0>(a) + 1] += 1;
+      if (!directed && std::get<0>(a) != std::get<1>(a))
+        g.m_offsets[std::get<1>(a) + 1] += 1;
+    }
+
+    std::partial_sum(g.m_offsets.begin(), g.m_offsets.end(), g.m_offsets.begin());
+
+    std::vector<Offset> fill(g.m_offsets.begin(), g.m_offsets.end() - 1);
+    g.m_targets.resize(g.m_offsets.back());
+    g.m_tags.resize(g.m_offsets.back());
+
+    for (auto& a : arcs) {
+      Offset p = fill[std::get<0>(a)]++;
+      g.m_targets[p] = std::get<1>(a);
+      g.m_tags[p]    = std::get<2>(a);
+
+      if (!directed && std::get<0>(a) != std::get<1>(a)) {
+        p = fill[std::get<1>(a)]++;
+        g.m_targets[p] = std::get<0>(a);
+        g.m_tags[p]    = std::get<2>(a);
+      }
+    }
+
+    g.sort_adjacencies(dedup);
+    g.index_labels();
+    return g;
+  }
+
+  Id     no_vertexes() const { return m_labels.size(); }
+  Offset no_edges()    const { return m_targets.size(); }
+  bool   directed()    const { return m_directed; }
+
+  Offset degree(Id v) const { return m_offsets[v + 1] - m_offsets[v]; }
+
+  const Id* nbr_begin(Id v) const { return m_targets.data() + m_offsets[v]; }
+  const Id* nbr_end(Id v)   const { return m_targets.data() + m_offsets[v + 1]; }
+
+  const EdgeTag* tag_begin(Id v) const { return m_tags.data() + m_offsets[v]; }
+  const EdgeTag* tag_end(Id v)   const { return m_tags.data() + m_offsets[v + 1]; }
+
+  const std::vector<Offset>&    offsets() const { return m_offsets; }
+  const std::vector<Id>&        targets() const { return m_targets; }
+  const std::vector<EdgeTag>&   tags()    const { return m_tags; }
+  const std::vector<VertexTag>& labels()  const { return m_labels; }
+
+  const VertexTag& label(Id v) const { return m_labels[v]; }
+
+  /// Returns NONE when the tag isn't in the graph, O(logn)
+  Id id_of(const VertexTag& tag) const {
+    auto it = std::lower_bound(m_by_label.begin(), m_by_label.end(), tag,
+        [this](Id a, const VertexTag& t) { return m_labels[a] < t; });
+
+    if (it == m_by_label.end() || tag < m_labels[*it]) return NONE;
+    return *it;
+  }
+
+  /// Tag of the arc u -> v or nullptr, O(log(degree(u)))
+  const EdgeTag* find_edge(Id u, Id v) const {
+    const Id* it = std::lower_bound(nbr_begin(u), nbr_end(u), v);
+    if (it == nbr_end(u) || *it != v) return nullptr;
+    return m_tags.data() + (it - m_targets.data());
+  }
+
+  /// Graph with every arc reversed (same as the graph itself for UNDIRECTED)
+  CSRGraph transposed() const {
+    if (!m_directed) return *this;
+
+    CSRGraph t;
+    t.m_labels   = m_labels;
+    t.m_by_label = m_by_label;
+    t.m_directed = true;
+    t.m_offsets.assign(no_vertexes() + 1, 0);
+
+    for (Id v : m_targets)
+      t.m_offsets[v + 1] += 1;
+
+    std::partial_sum(t.m_offsets.begin(), t.m_offsets.end(), t.m_offsets.begin());
+
+    std::vector<Offset> fill(t.m_offsets.begin(), t.m_offsets.end() - 1);
+    t.m_targets.resize(m_targets.size());
+    t.m_tags.resize(m_tags.size());
+
+    // Sources are visited in increasing order, so rows come out sorted
+    for (Id u = 0; u < no_vertexes(); ++u) {
+      for (Offset e = m_offsets[u]; e < m_offsets[u + 1]; ++e) {
+        Offset p = fill[m_targets[e]]++;
+        t.m_targets[p] = u;
+        t.m_tags[p]    = m_tags[e];
+      }
+    }
+
+    return t;
+  }
+
+  /// Same graph with vertex v renamed to perm[v], perm needs to be
+  /// a permutation of [0, no_vertexes()). Rows are re-sorted.
+  CSRGraph permuted(const std::vector<Id>& perm) const {
+    if (perm.size() != no_vertexes())
+      throw std::invalid_argument("Permutation size doesn't match the graph");
+
+    std::vector<bool> used(no_vertexes(), false);
+    for (Id id : perm) {
+      if (id >= no_vertexes() || used[id])
+        throw std::invalid_argument("Not a permutation of the vertexes");
+      used[id] = true;
+    }
+
+    CSRGraph p;
+    p.m_directed = m_directed;
+    p.m_labels.resize(no_vertexes());
+    p.m_offsets.assign(no_vertexes() + 1, 0);
+
+    for (Id v = 0; v < no_vertexes(); ++v) {
+      p.m_labels[perm[v]]      = m_labels[v];
+      p.m_offsets[perm[v] + 1] = degree(v);
+    }
+
+    std::partial_sum(p.m_offsets.begin(), p.m_offsets.end(), p.m_offsets.begin());
+    p.m_targets.resize(m_targets.size());
+    p.m_tags.resize(m_tags.size());
+
+    std::vector<std::pair<Id, EdgeTag>> row;
+    for (Id v = 0; v < no_vertexes(); ++v) {
+      row.clear();
+      for (Offset e = m_offsets[v]; e < m_offsets[v + 1]; ++e)
+        row.emplace_back(perm[m_targets[e]], m_tags[e]);
+
+      std::stable_sort(row.begin(), row.end(),
+          [](auto& a, auto& b) { return a.first < b.first; });
+
+      Offset out = p.m_offsets[perm[v]];
+      for (auto& x : row) {
+        p.m_targets[out] = x.first;
+        p.m_tags[out]    = x.second;
+        ++out;
+      }
+    }
+
+    p.index_labels();
+    return p;
+  }
+
+  void print(std::ostream& os = std::cout) const {
+    for (Id v = 0; v < no_vertexes(); ++v) {
+      os << v << " [" << m_labels[v] << "] => {";
+
+      for (Offset e = m_offsets[v]; e < m_offsets[v + 1]; ++e) {
+        os << "(" << m_tags[e] << ", " << m_targets[e] << ")";
+        if (e + 1 < m_offsets[v + 1])
+          os << ", ";
+      }
+
+      os << "}" << std::endl;
+    }
+  }
+
+private:
+
+  Id lower_label(const VertexTag& tag) const {
+    return std::lower_bound(m_labels.begin(), m_labels.end(), tag) - m_labels.begin();
+  }
+
+  void sort_adjacencies(bool dedup) {
+    std::vector<std::pair<Id, EdgeTag>> row;
+    Offset out = 0;
+
+    for (Id v = 0; v < no_vertexes(); ++v) {
+      Offset beg = m_offsets[v];
+      Offset end = m_offsets[v + 1];
+
+      row.clear();
+      for (Offset e = beg; e < end; ++e)
+        row.emplace_back(m_targets[e], m_tags[e]);
+
+      std::stable_sort(row.begin(), row.end(),
+          [](auto& a, auto& b) { return a.first < b.first; });
+
+      m_offsets[v] = out;
+      for (std::size_t ii = 0; ii < row.size(); ++ii) {
+        if (dedup && ii > 0 && row[ii].first == row[ii - 1].first) continue;
+        m_targets[out] = row[ii].first;
+        m_tags[out]    = row[ii].second;
+        ++out;
+      }
+    }
+
+    m_offsets[no_vertexes()] = out;
+    m_targets.resize(out);
+    m_tags.resize(out);
+  }
+
+  void index_labels() {
+    m_by_label.resize(m_labels.size());
+    std::iota(m_by_label.begin(), m_by_label.end(), 0);
+
+    if (!std::is_sorted(m_labels.begin(), m_labels.end()))
+      std::stable_sort(m_by_label.begin(), m_by_label.end(),
+          [this](Id a, Id b) { return m_labels[a] < m_labels[b]; });
+  }
+
+};
+
+}
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef QAED_COLORING_H
+#define QAED_COLORING_H
+
+#include <atomic>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "CSRGraph.hpp"
+#include "../tools/Parallel.hpp"
+
+namespace qaed {
+
+enum COLOR_ORDER {
+  LARGEST_FIRST,
+  SMALLEST_LAST,
+  RANDOM_ORDER
+};
+
+enum COLOR_METHOD {
+  JONES_PLASSMANN,
+  SPECULATIVE
+};
+
+struct Coloring {
+  std::vector<std::uint32_t> color;
+  std::uint32_t              no_colors = 0;
+};
+
+namespace coloring {
+
+using Id = std::uint32_t;
+
+/// Distinct priorities, higher gets colored first. Ties are broken at
+/// random so Jones-Plassmann rounds don't serialize on regular graphs.
+template <class V, class E>
+std::vector<std::uint64_t> priorities(const CSRGraph<V, E>& g, COLOR_ORDER order, std::uint64_t seed) {
+  const Id n = g.no_vertexes();
+
+  std::vector<Id> shuffle(n);
+  std::iota(shuffle.begin(), shuffle.end(), 0);
+  std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937_64(seed));
+
+  std::vector<std::uint64_t> prio(n);
+
+  if (order == RANDOM_ORDER) {
+    for (Id v = 0; v < n; ++v) prio[v] = shuffle[v];
+  } else if (order == LARGEST_FIRST) {
+    for (Id v = 0; v < n; ++v) prio[v] = (std::uint64_t(g.degree(v)) << 32) | shuffle[v];
+  } else {
+    // Smallest last: repeatedly remove a minimum degree vertex (bucket
+    // queue, O(n + m)), vertexes removed last are colored first
+    std::size_t max_degree = 0;
+    for (Id v = 0; v < n; ++v) max_degree = std::max(max_degree, g.degree(v));
+
+    std::vector<std::size_t>     degree(n);
+    std::vector<std::vector<Id>> bucket(max_degree + 1);
+    std::vector<bool>            removed(n, false);
+
+    for (Id v = 0; v < n; ++v) {
+      degree[v] = g.degree(v);
+      bucket[degree[v]].push_back(v);
+    }
+
+    std::size_t low = 0;
+    for (Id step = 0; step < n; ++step) {
+      low = low > 0 ? low - 1 : 0;
+
+      Id v;
+      while (true) {
+        while (bucket[low].empty()) ++low;
+        v = bucket[low].back(); bucket[low].pop_back();
+        if (!removed[v] && degree[v] == low) break;
+      }
+
+      removed[v] = true;
+      prio[v]    = step;
+
+      for (const Id* w = g.nbr_begin(v); w != g.nbr_end(v); ++w) {
+        if (removed[*w]) continue;
+        bucket[--degree[*w]].push_back(*w);
+      }
+    }
+  }
+
+  return prio;
+}
+
+/// Smallest color not used by any colored neighbour, forbidden is
+/// scratch indexed by color and marked with stamp
+inline Id first_fit(const Id* nbr, const Id* nbr_end, const std::atomic<Id>* color, std::vector<Id>& forbidden, Id stamp) {
+  for (; nbr != nbr_end; ++nbr) {
+    Id c = color[*nbr].load(std::memory_order_relaxed);
+    if (c == ~Id(0)) continue;
+    if (c >= forbidden.size()) forbidden.resize(c + 1, 0);
+    forbidden[c] = stamp;
+  }
+
+  Id c = 0;
+  while (c < forbidden.size() && forbidden[c] == stamp) ++c;
+  return c;
+}
+
+}
+
+/// Parallel greedy vertex coloring for UNDIRECTED graphs.
+/// JONES_PLASSMANN colors, round after round, the vertexes whose
+/// priority beats every uncolored neighbour. SPECULATIVE colors every
+/// vertex at once optimistically, then recolors the lower priority end
+/// of each conflicting edge until there are no conflicts.
+template <class V, class E>
+Coloring color_graph(const CSRGraph<V, E>& g, COLOR_ORDER order = SMALLEST_LAST, COLOR_METHOD method = SPECULATIVE,
+                     unsigned threads = default_threads(), std::uint64_t seed = 1) {
+  using coloring::Id;
+  const Id NONE = ~Id(0);
+
+  if (g.directed()) throw std::invalid_argument("Coloring needs an UNDIRECTED graph");
+
+  threads = std::max(1u, threads);
+  const Id n = g.no_vertexes();
+
+  auto prio = coloring::priorities(g, order, seed);
+
+  std::vector<std::atomic<Id>> color(n);
+  for (auto& c : color) c.store(NONE, std::memory_order_relaxed);
+
+  std::vector<std::vector<Id>> forbidden(threads);
+  std::vector<Id>              stamp(threads, 0);
+
+  // Work list sorted by decreasing priority, so chunks start with the
+  // vertexes that would come first in a serial greedy
+  std::vector<Id> active(n);
+  std::iota(active.begin(), active.end(), 0);
+  std::sort(active.begin(), active.end(), [&](Id a, Id b) { return prio[a] > prio[b]; });
+
+  std::vector<char> flag(n, 0);
+
+  while (!active.empty()) {
+    if (method == JONES_PLASSMANN) {
+      // Local maxima first, coloring them afterwards keeps every write
+      // away from the vertexes being read in the same phase
+      parallel_for(0, active.size(), threads, [&](std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t ii = b; ii < e; ++ii) {
+          Id u = active[ii];
+          bool top = true;
+          for (const Id* w = g.nbr_begin(u); top && w != g.nbr_end(u); ++w)
+            if (*w != u && color[*w].load(std::memory_order_relaxed) == NONE && prio[*w] > prio[u]) top = false;
+          flag[u] = top;
+        }
+      });
+    }
+
+    parallel_for(0, active.size(), threads, [&](std::size_t b, std::size_t e, unsigned tid) {
+      for (std::size_t ii = b; ii < e; ++ii) {
+        Id u = active[ii];
+        if (method == JONES_PLASSMANN && !flag[u]) continue;
+
+        Id c = coloring::first_fit(g.nbr_begin(u), g.nbr_end(u), color.data(), forbidden[tid], ++stamp[tid]);
+        color[u].store(c, std::memory_order_relaxed);
+      }
+    });
+
+    std::vector<Id> next;
+
+    if (method == JONES_PLASSMANN) {
+      for (Id u : active)
+        if (!flag[u]) next.push_back(u);
+    } else {
+      parallel_for(0, active.size(), threads, [&](std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t ii = b; ii < e; ++ii) {
+          Id u  = active[ii];
+          Id cu = color[u].load(std::memory_order_relaxed);
+          bool conflict = false;
+          for (const Id* w = g.nbr_begin(u); !conflict && w != g.nbr_end(u); ++w)
+            conflict = *w != u && color[*w].load(std::memory_order_relaxed) == cu && prio[*w] > prio[u];
+          flag[u] = conflict;
+        }
+      });
+
+      for (Id u : active) {
+        if (!flag[u]) continue;
+        color[u].store(NONE, std::memory_order_relaxed);
+        next.push_back(u);
+      }
+    }
+
+    active.swap(next);
+  }
+
+  Coloring result;
+  result.color.resize(n);
+  for (Id v = 0; v < n; ++v) {
+    result.color[v]  = color[v].load(std::memory_order_relaxed);
+    result.no_colors = std::max(result.no_colors, result.color[v] + 1);
+  }
+
+  return result;
+}
+
+/// No arc joins two vertexes of the same color (self loops are ignored)
+template <class V, class E>
+bool is_proper_coloring(const CSRGraph<V, E>& g, const Coloring& c) {
+  for (std::uint32_t u = 0; u < g.no_vertexes(); ++u)
+    for (const std::uint32_t* w = g.nbr_begin(u); w != g.nbr_end(u); ++w)
+      if (*w != u && c.color[u] == c.color[*w]) return false;
+  return true;
+}
+
+}
+
+#endif
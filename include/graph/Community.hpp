@@ -0,0 +1,360 @@
+#ifndef QAED_COMMUNITY_H
+#define QAED_COMMUNITY_H
+
+#include <atomic>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <type_traits>
+
+#include "CSRGraph.hpp"
+#include "../tools/Parallel.hpp"
+
+namespace qaed {
+
+struct Communities {
+  std::vector<std::uint32_t> community;
+  std::uint32_t              no_communities = 0;
+  double                     modularity     = 0;
+};
+
+namespace community {
+
+using Id     = std::uint32_t;
+using Offset = std::size_t;
+
+/// Weighted adjacency the algorithms work on, rows may contain a
+/// self arc holding the weight inside the (collapsed) vertex
+struct WeightedCSR {
+  std::vector<Offset> offsets;
+  std::vector<Id>     targets;
+  std::vector<double> weights;
+  std::vector<double> strength;
+  double              total = 0;
+
+  Id no_vertexes() const { return offsets.size() - 1; }
+
+  void compute_strength() {
+    strength.assign(no_vertexes(), 0);
+    total = 0;
+    for (Id u = 0; u < no_vertexes(); ++u) {
+      for (Offset e = offsets[u]; e < offsets[u + 1]; ++e)
+        strength[u] += weights[e];
+      total += strength[u];
+    }
+  }
+};
+
+/// Open addressing map community -> weight, one per thread. Clearing
+/// only touches the slots in use, so hubs don't make it slow.
+class ScratchMap {
+private:
+  std::vector<Id>     m_keys;
+  std::vector<double> m_vals;
+  std::vector<Id>     m_used;
+  Id                  m_mask = 0;
+
+  static constexpr Id EMPTY = ~Id(0);
+
+public:
+  void reset(std::size_t expected) {
+    for (Id slot : m_used) m_keys[slot] = EMPTY;
+    m_used.clear();
+
+    std::size_t cap = 16;
+    while (cap < 2 * expected) cap <<= 1;
+
+    if (cap > m_keys.size()) {
+      m_keys.assign(cap, EMPTY);
+      m_vals.assign(cap, 0);
+      m_mask = cap - 1;
+    }
+  }
+
+  void add(Id key, double w) {
+    Id slot = (key * 2654435761u) & m_mask;
+    while (m_keys[slot] != EMPTY && m_keys[slot] != key)
+      slot = (slot + 1) & m_mask;
+
+    if (m_keys[slot] == EMPTY) {
+      m_keys[slot] = key;
+      m_vals[slot] = 0;
+      m_used.push_back(slot);
+    }
+    m_vals[slot] += w;
+  }
+
+  double get(Id key) const {
+    Id slot = (key * 2654435761u) & m_mask;
+    while (m_keys[slot] != EMPTY) {
+      if (m_keys[slot] == key) return m_vals[slot];
+      slot = (slot + 1) & m_mask;
+    }
+    return 0;
+  }
+
+  template <class Function>
+  void for_each(Function&& f) const {
+    for (Id slot : m_used) f(m_keys[slot], m_vals[slot]);
+  }
+};
+
+template <class V, class E>
+WeightedCSR weighted(const CSRGraph<V, E>& g) {
+  static_assert(std::is_arithmetic<E>::value, "Community detection only works for arithmetic EdgeTags.");
+
+  if (g.directed()) throw std::invalid_argument("Community detection needs an UNDIRECTED graph");
+
+  WeightedCSR w;
+  w.offsets = g.offsets();
+  w.targets = g.targets();
+  w.weights.assign(g.tags().begin(), g.tags().end());
+  w.compute_strength();
+  return w;
+}
+
+inline double modularity(const WeightedCSR& g, const std::vector<Id>& comm) {
+  if (g.total == 0) return 0;
+
+  std::vector<double> in(g.no_vertexes(), 0), tot(g.no_vertexes(), 0);
+  for (Id u = 0; u < g.no_vertexes(); ++u) {
+    tot[comm[u]] += g.strength[u];
+    for (Offset e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+      if (comm[g.targets[e]] == comm[u]) in[comm[u]] += g.weights[e];
+  }
+
+  double q = 0;
+  for (Id c = 0; c < g.no_vertexes(); ++c)
+    q += in[c] / g.total - (tot[c] / g.total) * (tot[c] / g.total);
+  return q;
+}
+
+/// Renames labels to [0, k), returns k
+inline Id compact(std::vector<Id>& label) {
+  std::vector<Id> rename(label.size(), ~Id(0));
+  Id next = 0;
+  for (Id& l : label) {
+    if (rename[l] == ~Id(0)) rename[l] = next++;
+    l = rename[l];
+  }
+  return next;
+}
+
+/// Collapses every community in one vertex, parallel arcs are summed
+inline WeightedCSR aggregate(const WeightedCSR& g, const std::vector<Id>& comm, Id k) {
+  std::vector<std::vector<Id>> members(k);
+  for (Id u = 0; u < g.no_vertexes(); ++u)
+    members[comm[u]].push_back(u);
+
+  WeightedCSR c;
+  c.offsets.assign(1, 0);
+
+  ScratchMap acc;
+  std::vector<std::pair<Id, double>> row;
+
+  for (Id cu = 0; cu < k; ++cu) {
+    std::size_t degree = 0;
+    for (Id u : members[cu]) degree += g.offsets[u + 1] - g.offsets[u];
+
+    acc.reset(degree);
+    for (Id u : members[cu])
+      for (Offset e = g.offsets[u]; e < g.offsets[u + 1]; ++e)
+        acc.add(comm[g.targets[e]], g.weights[e]);
+
+    row.clear();
+    acc.for_each([&](Id cv, double w) { row.emplace_back(cv, w); });
+    std::sort(row.begin(), row.end());
+
+    for (auto& x : row) {
+      c.targets.push_back(x.first);
+      c.weights.push_back(x.second);
+    }
+    c.offsets.push_back(c.targets.size());
+  }
+
+  c.compute_strength();
+  return c;
+}
+
+/// One local moving phase. Every sweep goes over the vertexes in
+/// `batches` slices, threads pick the best community for the vertexes
+/// of a slice and the moves are applied before the next slice, so
+/// decisions are never older than one slice. Singleton to singleton
+/// moves only go to smaller ids so pairs of vertexes don't keep
+/// swapping. Returns true if anything moved.
+inline bool local_moving(const WeightedCSR& g, std::vector<Id>& comm, unsigned threads, unsigned max_sweeps,
+                         double tolerance, Id batches = 16) {
+  const Id n = g.no_vertexes();
+
+  std::vector<double> tot(n, 0);
+  std::vector<Id>     size(n, 0);
+  for (Id u = 0; u < n; ++u) { tot[comm[u]] += g.strength[u]; size[comm[u]] += 1; }
+
+  std::vector<ScratchMap> scratch(threads);
+  std::vector<Id>         target(n);
+  batches = std::max<Id>(1, std::min(batches, n));
+
+  bool   any_move = false;
+  double q        = modularity(g, comm);
+
+  for (unsigned sweep = 0; sweep < max_sweeps; ++sweep) {
+    std::size_t moved = 0;
+
+    for (Id batch = 0; batch < batches; ++batch) {
+      Id first = std::size_t(n) * batch / batches;
+      Id last  = std::size_t(n) * (batch + 1) / batches;
+
+      parallel_for(first, last, threads, [&](std::size_t b, std::size_t e, unsigned tid) {
+        ScratchMap& links = scratch[tid];
+
+        for (Id u = b; u < e; ++u) {
+          Id     cu = comm[u];
+          double ku = g.strength[u];
+
+          links.reset(g.offsets[u + 1] - g.offsets[u]);
+          for (Offset a = g.offsets[u]; a < g.offsets[u + 1]; ++a)
+            if (g.targets[a] != u) links.add(comm[g.targets[a]], g.weights[a]);
+
+          double best_gain = links.get(cu) - (tot[cu] - ku) * ku / g.total;
+          Id     best      = cu;
+
+          links.for_each([&](Id c, double w) {
+            if (c == cu) return;
+            if (size[cu] == 1 && size[c] == 1 && c > cu) return;
+
+            double gain = w - tot[c] * ku / g.total;
+            if (gain > best_gain || (gain == best_gain && c < best)) { best_gain = gain; best = c; }
+          });
+
+          target[u] = best;
+        }
+      });
+
+      for (Id u = first; u < last; ++u) {
+        if (target[u] == comm[u]) continue;
+
+        tot[comm[u]]   -= g.strength[u]; size[comm[u]]   -= 1;
+        tot[target[u]] += g.strength[u]; size[target[u]] += 1;
+        comm[u] = target[u];
+        ++moved;
+      }
+    }
+
+    if (!moved) break;
+    any_move = true;
+
+    double next = modularity(g, comm);
+    if (next - q < tolerance) break;
+    q = next;
+  }
+
+  return any_move;
+}
+
+}
+
+/// Multilevel Louvain modularity optimisation for weighted UNDIRECTED
+/// graphs. Local moving runs in parallel, then every community is
+/// collapsed into a vertex and the process repeats on the coarse graph.
+template <class V, class E>
+Communities louvain(const CSRGraph<V, E>& g, unsigned threads = default_threads(), unsigned max_levels = 16,
+                    unsigned max_sweeps = 32, double tolerance = 1e-6) {
+  using community::Id;
+
+  threads = std::max(1u, threads);
+  community::WeightedCSR level = community::weighted(g);
+
+  Communities result;
+  result.community.resize(g.no_vertexes());
+  std::iota(result.community.begin(), result.community.end(), 0);
+
+  for (unsigned it = 0; it < max_levels; ++it) {
+    std::vector<Id> comm(level.no_vertexes());
+    std::iota(comm.begin(), comm.end(), 0);
+
+    if (!community::local_moving(level, comm, threads, max_sweeps, tolerance)) break;
+
+    Id k = community::compact(comm);
+    for (Id& c : result.community) c = comm[c];
+
+    if (k == level.no_vertexes()) break;
+    level = community::aggregate(level, comm, k);
+  }
+
+  result.no_communities = community::compact(result.community);
+  result.modularity     = community::modularity(community::weighted(g), result.community);
+  return result;
+}
+
+/// Asynchronous label propagation: threads update labels in place and
+/// see each other's changes right away, every vertex takes the label
+/// with the heaviest incident weight. Much faster than louvain, lower
+/// modularity.
+template <class V, class E>
+Communities label_propagation(const CSRGraph<V, E>& g, unsigned threads = default_threads(),
+                              unsigned max_sweeps = 20, std::uint64_t seed = 1) {
+  using community::Id;
+  using community::Offset;
+
+  threads = std::max(1u, threads);
+  community::WeightedCSR w = community::weighted(g);
+  const Id n = w.no_vertexes();
+
+  std::vector<std::atomic<Id>> label(n);
+  for (Id u = 0; u < n; ++u) label[u].store(u, std::memory_order_relaxed);
+
+  std::vector<community::ScratchMap> scratch(threads);
+  std::vector<std::mt19937_64>       rng;
+  for (unsigned t = 0; t < threads; ++t) rng.emplace_back(seed + t);
+
+  for (unsigned sweep = 0; sweep < max_sweeps; ++sweep) {
+    std::atomic<std::size_t> changed(0);
+
+    parallel_for(0, n, threads, [&](std::size_t b, std::size_t e, unsigned tid) {
+      auto& links = scratch[tid];
+      std::size_t local_changed = 0;
+
+      // Random start inside the chunk so ties don't always break the same way
+      std::size_t len   = e - b;
+      std::size_t shift = std::uniform_int_distribution<std::size_t>(0, len - 1)(rng[tid]);
+
+      for (std::size_t ii = 0; ii < len; ++ii) {
+        Id u = b + (ii + shift) % len;
+        if (w.offsets[u] == w.offsets[u + 1]) continue;
+
+        links.reset(w.offsets[u + 1] - w.offsets[u]);
+        for (Offset a = w.offsets[u]; a < w.offsets[u + 1]; ++a)
+          if (w.targets[a] != u) links.add(label[w.targets[a]].load(std::memory_order_relaxed), w.weights[a]);
+
+        Id     current = label[u].load(std::memory_order_relaxed);
+        Id     best    = current;
+        double best_w  = links.get(current);
+
+        links.for_each([&](Id c, double weight) {
+          if (weight > best_w || (weight == best_w && c < best)) { best_w = weight; best = c; }
+        });
+
+        if (best != current) {
+          label[u].store(best, std::memory_order_relaxed);
+          ++local_changed;
+        }
+      }
+
+      changed += local_changed;
+    });
+
+    if (changed.load() == 0) break;
+  }
+
+  Communities result;
+  result.community.resize(n);
+  for (Id u = 0; u < n; ++u) result.community[u] = label[u].load(std::memory_order_relaxed);
+
+  result.no_communities = community::compact(result.community);
+  result.modularity     = community::modularity(w, result.community);
+  return result;
+}
+
+}
+
+#endif
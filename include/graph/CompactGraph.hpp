@@ -0,0 +1,324 @@
+#ifndef QAED_COMPACT_GRAPH_H
+#define QAED_COMPACT_GRAPH_H
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "CSRGraph.hpp"
+
+namespace qaed {
+
+/// Mutable adjacency with a small memory footprint. Vertexes get dense
+/// 32 bit ids in insertion order (ids are never reused), every row is
+/// a sorted vector of neighbour ids plus a parallel vector of tags.
+/// UNDIRECTED edges keep one tag only: row u splits its neighbours
+/// into the ones below u (no tags, the tag lives in the other row) and
+/// the ones from u up (with tags). Sorted order is just both halves one
+/// after the other, so iteration doesn't care about the split.
+/// An UNDIRECTED edge costs 2 ids + 1 tag, a DIRECTED arc 1 id + 1 tag.
+template <class VertexTag, class EdgeTag, G_TYPE type>
+class CompactGraph {
+public:
+  using Id = std::uint32_t;
+
+  static constexpr Id NONE = ~Id(0);
+
+private:
+  struct Row {
+    std::vector<Id>      nbr;
+    std::vector<EdgeTag> tag;
+    Id                   split = 0;   // neighbours below the vertex, UNDIRECTED only
+
+    const EdgeTag* own_tag(std::size_t pos) const { return &tag[pos - split]; }
+  };
+
+  std::vector<VertexTag>    m_labels;
+  std::vector<Row>          m_rows;
+  std::vector<bool>         m_alive;
+  std::map<VertexTag, Id>   m_ids;
+  std::size_t               m_no_edges;
+
+public:
+  CompactGraph() : m_no_edges(0) {
+    static_assert(type == DIRECTED || type == UNDIRECTED,
+                  "Unknown graph type (posible values are {qaed::DIRECTED, qaed::UNDIRECTED})");
+  }
+
+  /// Vertexes and edges of Graph come ordered by tag, ids follow that
+  /// order, so every row is filled with push_backs only
+  explicit CompactGraph(const Graph<VertexTag, EdgeTag, type>& g) : CompactGraph() {
+    m_labels.reserve(g.no_vertexes());
+    m_rows.resize(g.no_vertexes());
+    m_alive.assign(g.no_vertexes(), true);
+
+    for (auto& v : g) {
+      m_ids.emplace_hint(m_ids.end(), v.get_data(), m_labels.size());
+      m_labels.push_back(v.get_data());
+    }
+
+    Id u = 0;
+    for (auto& v : g) {
+      Row& row = m_rows[u];
+      row.nbr.reserve(v.edges().size());
+
+      for (auto& e : v.edges()) {
+        Id w = m_ids.find(e.vertex().get_data())->second;
+        row.nbr.push_back(w);
+
+        if (type == UNDIRECTED && w < u) row.split += 1;
+        else                             row.tag.push_back(e.get_tag());
+      }
+
+      row.tag.shrink_to_fit();
+      m_no_edges += row.tag.size();
+      ++u;
+    }
+  }
+
+  std::size_t no_vertexes() const { return m_ids.size(); }
+  std::size_t no_edges()    const { return m_no_edges; }
+
+  /// Ids are in [0, id_bound()), removed ids stay dead
+  Id   id_bound()    const { return m_labels.size(); }
+  bool alive(Id v)   const { return v < m_alive.size() && m_alive[v]; }
+
+  const VertexTag& label(Id v) const { return m_labels[v]; }
+
+  /// Returns NONE when the tag isn't in the graph, O(logn)
+  Id id_of(const VertexTag& tag) const {
+    auto it = m_ids.find(tag);
+    return it == m_ids.end() ? NONE : it->second;
+  }
+
+  std::size_t degree(Id v) const { return m_rows[v].nbr.size(); }
+
+  const Id* nbr_begin(Id v) const { return m_rows[v].nbr.data(); }
+  const Id* nbr_end(Id v)   const { return m_rows[v].nbr.data() + m_rows[v].nbr.size(); }
+
+  /// Returns {id, inserted}
+  std::pair<Id, bool> add_vertex(const VertexTag& data) {
+    auto result = m_ids.emplace(data, m_labels.size());
+    if (!result.second) return { result.first->second, false };
+
+    m_labels.push_back(data);
+    m_rows.emplace_back();
+    m_alive.push_back(true);
+    return { result.first->second, true };
+  }
+
+  bool add_edge(const VertexTag& d1, const VertexTag& d2, const EdgeTag& data) {
+    Id u = id_of(d1), v = id_of(d2);
+    if (u == NONE || v == NONE)
+      throw std::runtime_error("One/two vertex(s) were not found");
+
+    return link(u, v, data);
+  }
+
+  /// Same as add_edge on ids, an existing edge keeps its tag
+  bool link(Id u, Id v, const EdgeTag& data) {
+    if (!alive(u) || !alive(v)) throw std::out_of_range("Vertex id out of range");
+
+    if constexpr (type == DIRECTED) {
+      Row& row = m_rows[u];
+      auto it  = std::lower_bound(row.nbr.begin(), row.nbr.end(), v);
+      if (it != row.nbr.end() && *it == v) return false;
+
+      row.tag.insert(row.tag.begin() + (it - row.nbr.begin()), data);
+      row.nbr.insert(it, v);
+    } else {
+      Id lo = std::min(u, v), hi = std::max(u, v);
+
+      Row& low = m_rows[lo];
+      auto it  = std::lower_bound(low.nbr.begin(), low.nbr.end(), hi);
+      if (it != low.nbr.end() && *it == hi) return false;
+
+      low.tag.insert(low.tag.begin() + (it - low.nbr.begin() - low.split), data);
+      low.nbr.insert(it, hi);
+
+      if (lo != hi) {
+        Row& high = m_rows[hi];
+        high.nbr.insert(high.nbr.begin() + lower_half(high, lo), lo);
+        high.split += 1;
+      }
+    }
+
+    m_no_edges += 1;
+    return true;
+  }
+
+  bool remove_edge(const VertexTag& d1, const VertexTag& d2) {
+    Id u = id_of(d1), v = id_of(d2);
+    if (u == NONE || v == NONE) return false;
+    return unlink(u, v);
+  }
+
+  bool unlink(Id u, Id v) {
+    if (!alive(u) || !alive(v)) return false;
+
+    if constexpr (type == DIRECTED) {
+      if (!erase_from(m_rows[u], v, true)) return false;
+    } else {
+      Id lo = std::min(u, v), hi = std::max(u, v);
+      if (!erase_from(m_rows[lo], hi, true)) return false;
+      if (lo != hi) erase_from(m_rows[hi], lo, false);
+    }
+
+    m_no_edges -= 1;
+    return true;
+  }
+
+  bool remove_vertex(const VertexTag& data) {
+    Id v = id_of(data);
+    if (v == NONE) return false;
+
+    if constexpr (type == DIRECTED) {
+      // No reverse adjacency, every row has to be checked
+      for (Id u = 0; u < id_bound(); ++u)
+        if (u != v && alive(u) && erase_from(m_rows[u], v, true)) m_no_edges -= 1;
+    } else {
+      // Only the neighbours can hold v
+      for (Id w : m_rows[v].nbr)
+        if (w != v) erase_from(m_rows[w], v, w < v);
+    }
+
+    m_no_edges -= m_rows[v].split + m_rows[v].tag.size();
+    m_rows[v] = Row();
+    m_alive[v] = false;
+    m_ids.erase(data);
+    return true;
+  }
+
+  /// Tag of the edge u -> v or nullptr, O(log(degree))
+  const EdgeTag* find_edge(Id u, Id v) const {
+    if (!alive(u) || !alive(v)) return nullptr;
+
+    if (type == UNDIRECTED && v < u) std::swap(u, v);
+
+    const Row& row = m_rows[u];
+    auto it = std::lower_bound(row.nbr.begin() + row.split, row.nbr.end(), v);
+    if (it == row.nbr.end() || *it != v) return nullptr;
+    return row.own_tag(it - row.nbr.begin());
+  }
+
+  EdgeTag const& get_tag_edge(const VertexTag& a, const VertexTag& b) const {
+    const EdgeTag* t = find_edge(id_of(a), id_of(b));
+    if (!t) throw std::runtime_error("Edge was not found");
+    return *t;
+  }
+
+  bool set_tag_edge(const VertexTag& a, const VertexTag& b, const EdgeTag& newdata) {
+    const EdgeTag* t = find_edge(id_of(a), id_of(b));
+    if (!t) return false;
+
+    *const_cast<EdgeTag*>(t) = newdata;
+    return true;
+  }
+
+  /// f(neighbour id, tag) in increasing neighbour order
+  template <class Function>
+  void for_each_edge(Id v, Function&& f) const {
+    const Row& row = m_rows[v];
+
+    for (Id ii = 0; ii < row.split; ++ii)
+      f(row.nbr[ii], *find_edge(row.nbr[ii], v));
+
+    for (std::size_t ii = row.split; ii < row.nbr.size(); ++ii)
+      f(row.nbr[ii], *row.own_tag(ii));
+  }
+
+  /// Drops the spare capacity left by insertions
+  void shrink_to_fit() {
+    for (Row& row : m_rows) {
+      row.nbr.shrink_to_fit();
+      row.tag.shrink_to_fit();
+    }
+  }
+
+  /// Bytes held by the adjacency (labels and the tag index excluded)
+  std::size_t memory_bytes() const {
+    std::size_t bytes = m_rows.capacity() * sizeof(Row);
+    for (const Row& row : m_rows)
+      bytes += row.nbr.capacity() * sizeof(Id) + row.tag.capacity() * sizeof(EdgeTag);
+    return bytes;
+  }
+
+  /// Snapshot for the algorithms in include/graph, dead ids are
+  /// squeezed out so the CSR ids are dense again
+  CSRGraph<VertexTag, EdgeTag> to_csr() const {
+    std::vector<Id> rename(id_bound(), NONE);
+    std::vector<VertexTag> labels;
+    labels.reserve(no_vertexes());
+
+    for (Id v = 0; v < id_bound(); ++v)
+      if (m_alive[v]) { rename[v] = labels.size(); labels.push_back(m_labels[v]); }
+
+    std::vector<std::size_t> offsets(1, 0);
+    std::vector<Id>          targets;
+    std::vector<EdgeTag>     tags;
+
+    offsets.reserve(labels.size() + 1);
+    targets.reserve(type == DIRECTED ? m_no_edges : 2 * m_no_edges);
+    tags.reserve(targets.capacity());
+
+    for (Id v = 0; v < id_bound(); ++v) {
+      if (!m_alive[v]) continue;
+
+      for_each_edge(v, [&](Id w, const EdgeTag& t) {
+        targets.push_back(rename[w]);
+        tags.push_back(t);
+      });
+      offsets.push_back(targets.size());
+    }
+
+    return CSRGraph<VertexTag, EdgeTag>(std::move(labels), std::move(offsets), std::move(targets),
+                                        std::move(tags), type == DIRECTED);
+  }
+
+  void print(std::ostream& os = std::cout) const {
+    for (Id v = 0; v < id_bound(); ++v) {
+      if (!m_alive[v]) continue;
+      os << "[[" << m_labels[v] << "]] => {";
+
+      bool first = true;
+      for_each_edge(v, [&](Id w, const EdgeTag& t) {
+        os << (first ? "" : ", ") << "(" << t << ", [" << m_labels[w] << "])";
+        first = false;
+      });
+
+      os << "}" << std::endl;
+    }
+  }
+
+private:
+
+  /// Position where lo goes in the no tag half of row
+  static std::size_t lower_half(const Row& row, Id lo) {
+    return std::lower_bound(row.nbr.begin(), row.nbr.begin() + row.split, lo) - row.nbr.begin();
+  }
+
+  /// Removes w from row, own says if w is in the half holding tags
+  static bool erase_from(Row& row, Id w, bool own) {
+    auto first = own ? row.nbr.begin() + row.split : row.nbr.begin();
+    auto last  = own ? row.nbr.end() : row.nbr.begin() + row.split;
+
+    auto it = std::lower_bound(first, last, w);
+    if (it == last || *it != w) return false;
+
+    if (own) {
+      row.tag.erase(row.tag.begin() + (it - row.nbr.begin() - row.split));
+    } else {
+      row.split -= 1;
+    }
+    row.nbr.erase(it);
+    return true;
+  }
+
+};
+
+}
+
+#endif
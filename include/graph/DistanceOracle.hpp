@@ -0,0 +1,361 @@
+#ifndef QAED_DISTANCE_ORACLE_H
+#define QAED_DISTANCE_ORACLE_H
+
+#include <cmath>
+#include <queue>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#include "CSRGraph.hpp"
+#include "../tools/Parallel.hpp"
+
+namespace qaed {
+
+/// Thorup-Zwick approximate distance oracle for weighted UNDIRECTED
+/// graphs. Centers A_0 = V > A_1 > ... > A_{k-1} are sampled with
+/// probability n^(-1/k) per level; every vertex keeps its closest center
+/// of each level (pivots) and its bunch, the centers w of level i closer
+/// than the nearest center of level i + 1. Answers are at most 2k - 1
+/// times the real distance, take O(k) hash lookups and the whole thing
+/// needs O(k n^(1 + 1/k)) space instead of O(n^2).
+/// The shortest path trees of the clusters (the inverse of the bunches)
+/// form a (2k - 1)-spanner, kept if asked for.
+template <class VertexTag, class EdgeTag>
+class DistanceOracle {
+public:
+  using Id     = typename CSRGraph<VertexTag, EdgeTag>::Id;
+  using Offset = typename CSRGraph<VertexTag, EdgeTag>::Offset;
+  using Arc    = typename CSRGraph<VertexTag, EdgeTag>::Arc;
+
+  static constexpr Id      NONE     = CSRGraph<VertexTag, EdgeTag>::NONE;
+  static constexpr EdgeTag INFINITE = std::numeric_limits<EdgeTag>::max();
+
+private:
+  // Bunch (v, w) -> d(v, w), one open addressing table for every vertex
+  struct Slot {
+    std::uint64_t key;
+    EdgeTag       dist;
+  };
+
+  struct Reached {
+    Id      v;
+    Id      center;
+    EdgeTag dist;
+  };
+
+  static constexpr std::uint64_t EMPTY = ~std::uint64_t(0);
+
+  Id                   m_n;
+  unsigned             m_k;
+  std::vector<EdgeTag> m_pivot_dist;   // level * n + v
+  std::vector<Id>      m_pivot;
+  std::vector<Slot>    m_slots;
+  std::size_t          m_entries;
+  int                  m_shift;
+  std::vector<Arc>     m_spanner;
+
+public:
+  /// k >= 1 gives stretch 2k - 1, k = 1 is exact (and quadratic)
+  DistanceOracle(const CSRGraph<VertexTag, EdgeTag>& g, unsigned k, std::uint64_t seed = 1,
+                 unsigned threads = default_threads(), bool keep_spanner = false) :
+    m_n(g.no_vertexes()),
+    m_k(std::max(1u, k)),
+    m_entries(0),
+    m_shift(64) {
+    static_assert(std::is_arithmetic<EdgeTag>::value, "Distance oracles only work for arithmetic EdgeTags.");
+
+    if (g.directed()) throw std::invalid_argument("Distance oracles need an UNDIRECTED graph");
+    for (const EdgeTag& t : g.tags())
+      if (t < EdgeTag()) throw std::invalid_argument("Negative weights aren't supported");
+
+    build(g, sample_levels(seed), std::max(1u, threads), keep_spanner);
+  }
+
+  unsigned k()             const { return m_k; }
+  unsigned stretch_bound() const { return 2 * m_k - 1; }
+
+  /// Bunch entries over every vertex, the O(k n^(1 + 1/k)) part
+  std::size_t bunch_entries() const { return m_entries; }
+
+  std::size_t size_bytes() const {
+    return m_pivot_dist.size() * sizeof(EdgeTag) + m_pivot.size() * sizeof(Id) + m_slots.size() * sizeof(Slot);
+  }
+
+  /// Estimate of d(u, v), d(u, v) <= distance(u, v) <= (2k - 1) d(u, v).
+  /// INFINITE if v can't be reached from u.
+  EdgeTag distance(Id u, Id v) const {
+    if (u == v) return EdgeTag();
+
+    Id       w = u;
+    unsigned i = 0;
+    EdgeTag  to_v;
+
+    while (!bunch(v, w, to_v)) {
+      if (++i == m_k) return INFINITE;
+      std::swap(u, v);
+      w = m_pivot[std::size_t(i) * m_n + u];
+      if (w == NONE) return INFINITE;
+    }
+
+    return m_pivot_dist[std::size_t(i) * m_n + u] + to_v;
+  }
+
+  EdgeTag operator()(Id u, Id v) const { return distance(u, v); }
+
+  /// Spanner arcs (u, v, tag) with u < v, empty unless keep_spanner
+  const std::vector<Arc>& spanner_arcs() const { return m_spanner; }
+
+private:
+
+  /// Highest level of every vertex, A_{k-1} is never left empty
+  std::vector<unsigned> sample_levels(std::uint64_t seed) const {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> coin(0, 1);
+    const double p = m_n ? std::pow(double(m_n), -1.0 / m_k) : 0;
+
+    std::vector<unsigned> level(m_n, 0);
+    for (unsigned i = 1; i < m_k; ++i) {
+      std::vector<Id> previous, kept;
+      for (Id v = 0; v < m_n; ++v) {
+        if (level[v] != i - 1) continue;
+        previous.push_back(v);
+        if (coin(rng) < p) kept.push_back(v);
+      }
+
+      if (kept.empty() && !previous.empty())
+        kept.push_back(previous[std::uniform_int_distribution<std::size_t>(0, previous.size() - 1)(rng)]);
+      for (Id v : kept) level[v] = i;
+    }
+
+    return level;
+  }
+
+  /// d(v, A_i) and p_i(v) for every level, multi source Dijkstra per level
+  void compute_pivots(const CSRGraph<VertexTag, EdgeTag>& g, const std::vector<unsigned>& level) {
+    using Entry = std::pair<EdgeTag, Id>;
+
+    m_pivot_dist.assign(std::size_t(m_k + 1) * m_n, INFINITE);
+    m_pivot.assign(std::size_t(m_k + 1) * m_n, NONE);
+
+    for (Id v = 0; v < m_n; ++v) {
+      m_pivot_dist[v] = EdgeTag();
+      m_pivot[v]      = v;
+    }
+
+    std::vector<Entry> heap;
+    for (unsigned i = 1; i < m_k; ++i) {
+      EdgeTag* dist  = m_pivot_dist.data() + std::size_t(i) * m_n;
+      Id*      pivot = m_pivot.data() + std::size_t(i) * m_n;
+
+      heap.clear();
+      for (Id v = 0; v < m_n; ++v)
+        if (level[v] >= i) { dist[v] = EdgeTag(); pivot[v] = v; heap.emplace_back(EdgeTag(), v); }
+
+      while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        Entry top = heap.back(); heap.pop_back();
+        Id u = top.second;
+        if (top.first != dist[u]) continue;
+
+        for (Offset e = g.offsets()[u]; e < g.offsets()[u + 1]; ++e) {
+          Id      w = g.targets()[e];
+          EdgeTag d = top.first + g.tags()[e];
+          if (d < dist[w]) {
+            dist[w]  = d;
+            pivot[w] = pivot[u];
+            heap.emplace_back(d, w);
+            std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+          }
+        }
+      }
+    }
+
+    // Ties between levels take the pivot of the upper level, so p_i(v)
+    // is always in the bunch of v and queries stop there
+    for (unsigned i = m_k - 1; i-- > 0; ) {
+      for (Id v = 0; v < m_n; ++v) {
+        std::size_t lo = std::size_t(i) * m_n + v, hi = lo + m_n;
+        if (m_pivot[hi] != NONE && !(m_pivot_dist[lo] < m_pivot_dist[hi])) m_pivot[lo] = m_pivot[hi];
+      }
+    }
+  }
+
+  void build(const CSRGraph<VertexTag, EdgeTag>& g, const std::vector<unsigned>& level, unsigned threads, bool keep_spanner) {
+    compute_pivots(g, level);
+
+    // Every thread grows the clusters C(w) = { v : d(w, v) < d(v, A_{i+1}) }
+    // of its centers, a plain Dijkstra pruned by the next level distances
+    std::vector<std::vector<Reached>> found(threads);
+    std::vector<std::vector<Arc>>     tree(threads);
+
+    parallel_for(0, m_n, threads, [&](std::size_t b, std::size_t e, unsigned tid) {
+      using Entry = std::pair<EdgeTag, Id>;
+
+      std::vector<EdgeTag>  dist(m_n);
+      std::vector<Id>       parent(m_n);
+      std::vector<unsigned> seen(m_n, 0);
+      std::vector<Entry>    heap;
+      unsigned              stamp = 0;
+
+      for (Id w = b; w < e; ++w) {
+        const EdgeTag* bound = m_pivot_dist.data() + std::size_t(level[w] + 1) * m_n;
+
+        ++stamp;
+        seen[w] = stamp; dist[w] = EdgeTag(); parent[w] = NONE;
+        heap.assign(1, Entry(EdgeTag(), w));
+
+        while (!heap.empty()) {
+          std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+          Entry top = heap.back(); heap.pop_back();
+          Id u = top.second;
+          if (top.first != dist[u]) continue;
+
+          found[tid].push_back({ u, w, top.first });
+          if (keep_spanner && parent[u] != NONE)
+            tree[tid].emplace_back(std::min(u, parent[u]), std::max(u, parent[u]), top.first - dist[parent[u]]);
+
+          for (Offset a = g.offsets()[u]; a < g.offsets()[u + 1]; ++a) {
+            Id      x = g.targets()[a];
+            EdgeTag d = top.first + g.tags()[a];
+            if (!(d < bound[x])) continue;
+
+            if (seen[x] != stamp || d < dist[x]) {
+              seen[x] = stamp; dist[x] = d; parent[x] = u;
+              heap.emplace_back(d, x);
+              std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+            }
+          }
+        }
+      }
+    });
+
+    fill_table(found);
+
+    for (auto& arcs : tree) {
+      m_spanner.insert(m_spanner.end(), arcs.begin(), arcs.end());
+      std::vector<Arc>().swap(arcs);
+    }
+
+    // Clusters overlap, the same tree arc shows up in many of them
+    std::sort(m_spanner.begin(), m_spanner.end());
+    m_spanner.erase(std::unique(m_spanner.begin(), m_spanner.end(),
+        [](const Arc& x, const Arc& y) { return std::get<0>(x) == std::get<0>(y) && std::get<1>(x) == std::get<1>(y); }),
+        m_spanner.end());
+  }
+
+  void fill_table(std::vector<std::vector<Reached>>& found) {
+    for (auto& list : found) m_entries += list.size();
+
+    std::size_t cap = 16;
+    m_shift = 60;
+    while (cap < m_entries + m_entries / 2) { cap <<= 1; --m_shift; }
+    m_slots.assign(cap, Slot{ EMPTY, EdgeTag() });
+
+    for (auto& list : found) {
+      for (const Reached& r : list) insert(r.v, r.center, r.dist);
+      std::vector<Reached>().swap(list);
+    }
+  }
+
+  std::size_t slot_of(std::uint64_t key) const {
+    return (key * 0x9e3779b97f4a7c15ull) >> m_shift;
+  }
+
+  void insert(Id v, Id w, EdgeTag d) {
+    std::uint64_t key  = (std::uint64_t(v) << 32) | w;
+    std::size_t   mask = m_slots.size() - 1;
+
+    for (std::size_t s = slot_of(key); ; s = (s + 1) & mask) {
+      if (m_slots[s].key == EMPTY) { m_slots[s] = Slot{ key, d }; return; }
+      if (m_slots[s].key == key) return;
+    }
+  }
+
+  bool bunch(Id v, Id w, EdgeTag& d) const {
+    std::uint64_t key  = (std::uint64_t(v) << 32) | w;
+    std::size_t   mask = m_slots.size() - 1;
+
+    for (std::size_t s = slot_of(key); ; s = (s + 1) & mask) {
+      if (m_slots[s].key == key)   { d = m_slots[s].dist; return true; }
+      if (m_slots[s].key == EMPTY) return false;
+    }
+  }
+
+};
+
+/// (2k - 1)-spanner with O(k n^(1 + 1/k)) edges, the union of the
+/// cluster trees of a Thorup-Zwick oracle
+template <class VertexTag, class EdgeTag>
+CSRGraph<VertexTag, EdgeTag> spanner(const CSRGraph<VertexTag, EdgeTag>& g, unsigned k, std::uint64_t seed = 1,
+                                     unsigned threads = default_threads()) {
+  DistanceOracle<VertexTag, EdgeTag> oracle(g, k, seed, threads, true);
+  return CSRGraph<VertexTag, EdgeTag>::from_arcs(g.labels(), oracle.spanner_arcs(), false);
+}
+
+struct StretchReport {
+  std::size_t pairs = 0;
+  double      mean  = 0;
+  double      max   = 0;
+};
+
+/// Compares estimate(u, v), e.g. an oracle, against exact Dijkstra
+/// from `sources` random vertexes to `targets` reachable ones each
+template <class VertexTag, class EdgeTag, class Estimate>
+StretchReport measure_stretch(const CSRGraph<VertexTag, EdgeTag>& g, Estimate&& estimate,
+                              std::size_t sources = 16, std::size_t targets = 64, std::uint64_t seed = 1) {
+  using Id    = typename CSRGraph<VertexTag, EdgeTag>::Id;
+  using Entry = std::pair<EdgeTag, Id>;
+  const EdgeTag INFINITE = DistanceOracle<VertexTag, EdgeTag>::INFINITE;
+
+  StretchReport report;
+  if (!g.no_vertexes()) return report;
+
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<Id> pick(0, g.no_vertexes() - 1);
+
+  std::vector<EdgeTag> dist;
+  std::vector<Id>      reached;
+
+  for (std::size_t s = 0; s < sources; ++s) {
+    Id source = pick(rng);
+
+    dist.assign(g.no_vertexes(), INFINITE);
+    reached.clear();
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    dist[source] = EdgeTag();
+    heap.emplace(EdgeTag(), source);
+
+    while (!heap.empty()) {
+      Entry top = heap.top(); heap.pop();
+      if (top.first != dist[top.second]) continue;
+      reached.push_back(top.second);
+
+      for (auto e = g.offsets()[top.second]; e < g.offsets()[top.second + 1]; ++e) {
+        EdgeTag d = top.first + g.tags()[e];
+        if (d < dist[g.targets()[e]]) { dist[g.targets()[e]] = d; heap.emplace(d, g.targets()[e]); }
+      }
+    }
+
+    for (std::size_t t = 0; t < targets && reached.size() > 1; ++t) {
+      Id target = reached[1 + rng() % (reached.size() - 1)];
+      if (dist[target] == EdgeTag()) continue;
+
+      double stretch = double(estimate(source, target)) / double(dist[target]);
+      report.mean += stretch;
+      report.max   = std::max(report.max, stretch);
+      report.pairs += 1;
+    }
+  }
+
+  if (report.pairs) report.mean /= report.pairs;
+  return report;
+}
+
+}
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef QAED_GENERATORS_H
+#define QAED_GENERATORS_H
+
+#include <cmath>
+#include <tuple>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include "../Graph.hpp"
+
+namespace qaed {
+
+/// Synthetic graphs as plain edge lists over vertexes [0, no_vertexes),
+/// weights are uniform in [1, max_weight]. Self loops are never generated,
+/// duplicated edges may be (Graph keeps only the first one).
+template <class EdgeTag = int>
+struct EdgeList {
+  using Id   = std::uint32_t;
+  using Arc  = std::tuple<Id, Id, EdgeTag>;
+
+  Id               no_vertexes = 0;
+  std::vector<Arc> edges;
+
+  /// Loads the list into g, vertex tags are the ids themselves
+  template <class VertexTag, G_TYPE type>
+  void fill(Graph<VertexTag, EdgeTag, type>& g) const {
+    std::vector<decltype(g.add_vertex(VertexTag()).first)> itr;
+    itr.reserve(no_vertexes);
+
+    for (Id v = 0; v < no_vertexes; ++v)
+      itr.push_back(g.add_vertex(static_cast<VertexTag>(v)).first);
+
+    for (auto& e : edges)
+      g.add_edge(itr[std::get<0>(e)], itr[std::get<1>(e)], std::get<2>(e));
+  }
+};
+
+namespace generators {
+
+template <class EdgeTag>
+EdgeTag random_weight(std::mt19937_64& rng, EdgeTag max_weight) {
+  if constexpr (std::is_integral<EdgeTag>::value)
+    return std::uniform_int_distribution<EdgeTag>(1, max_weight)(rng);
+  else
+    return std::uniform_real_distribution<EdgeTag>(1, max_weight)(rng);
+}
+
+/// Recursive matrix (Kronecker) graph with 2^scale vertexes and
+/// edge_factor * 2^scale edges, defaults are the Graph500 ones
+template <class EdgeTag = int>
+EdgeList<EdgeTag> rmat(unsigned scale, unsigned edge_factor = 16, std::uint64_t seed = 1, EdgeTag max_weight = 100,
+                       double a = 0.57, double b = 0.19, double c = 0.19) {
+  if (scale >= 32) throw std::invalid_argument("R-MAT scale too big for 32 bits ids");
+
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> coin(0, 1);
+
+  EdgeList<EdgeTag> list;
+  list.no_vertexes = std::uint32_t(1) << scale;
+  list.edges.reserve(std::size_t(edge_factor) * list.no_vertexes);
+
+  for (std::size_t ii = 0; ii < std::size_t(edge_factor) * list.no_vertexes; ++ii) {
+    std::uint32_t u = 0, v = 0;
+
+    for (unsigned bit = 0; bit < scale; ++bit) {
+      double r = coin(rng);
+      u <<= 1; v <<= 1;
+
+      if      (r < a)         {}
+      else if (r < a + b)     { v |= 1; }
+      else if (r < a + b + c) { u |= 1; }
+      else                    { u |= 1; v |= 1; }
+    }
+
+    if (u != v) list.edges.emplace_back(u, v, random_weight(rng, max_weight));
+  }
+
+  return list;
+}
+
+/// G(n, p), skips over absent pairs with geometric jumps
+/// (Batagelj-Brandes) so it runs in O(n + m)
+template <class EdgeTag = int>
+EdgeList<EdgeTag> erdos_renyi(std::uint32_t n, double p, std::uint64_t seed = 1, EdgeTag max_weight = 100) {
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> coin(0, 1);
+
+  EdgeList<EdgeTag> list;
+  list.no_vertexes = n;
+  if (p <= 0) return list;
+
+  double lp = std::log(1.0 - std::min(p, 1.0 - 1e-12));
+  std::int64_t v = 1, w = -1;
+
+  while (v < n) {
+    w += 1 + static_cast<std::int64_t>(std::floor(std::log(1.0 - coin(rng)) / lp));
+    while (w >= v && v < n) { w -= v; ++v; }
+    if (v < n) list.edges.emplace_back(v, w, random_weight(rng, max_weight));
+  }
+
+  return list;
+}
+
+/// rows x cols 4-neighbour lattice
+template <class EdgeTag = int>
+EdgeList<EdgeTag> grid(std::uint32_t rows, std::uint32_t cols, std::uint64_t seed = 1, EdgeTag max_weight = 100) {
+  std::mt19937_64 rng(seed);
+
+  EdgeList<EdgeTag> list;
+  list.no_vertexes = rows * cols;
+  list.edges.reserve(2 * std::size_t(rows) * cols);
+
+  for (std::uint32_t r = 0; r < rows; ++r) {
+    for (std::uint32_t c = 0; c < cols; ++c) {
+      std::uint32_t v = r * cols + c;
+      if (c + 1 < cols) list.edges.emplace_back(v, v + 1,    random_weight(rng, max_weight));
+      if (r + 1 < rows) list.edges.emplace_back(v, v + cols, random_weight(rng, max_weight));
+    }
+  }
+
+  return list;
+}
+
+/// Barabasi-Albert preferential attachment, every new vertex links
+/// to m existing ones. Degrees follow a power law with exponent ~3
+template <class EdgeTag = int>
+EdgeList<EdgeTag> power_law(std::uint32_t n, unsigned m = 4, std::uint64_t seed = 1, EdgeTag max_weight = 100) {
+  std::mt19937_64 rng(seed);
+
+  EdgeList<EdgeTag> list;
+  list.no_vertexes = n;
+  if (n <= m) return list;
+
+  list.edges.reserve(std::size_t(n) * m);
+
+  // Every vertex appears here once per incident edge, sampling
+  // uniformly from it is sampling proportionally to degree
+  std::vector<std::uint32_t> endpoints;
+  endpoints.reserve(2 * std::size_t(n) * m);
+
+  for (std::uint32_t v = 0; v <= m; ++v) {
+    for (std::uint32_t u = 0; u < v; ++u) {
+      list.edges.emplace_back(v, u, random_weight(rng, max_weight));
+      endpoints.push_back(u);
+      endpoints.push_back(v);
+    }
+  }
+
+  for (std::uint32_t v = m + 1; v < n; ++v) {
+    std::uniform_int_distribution<std::size_t> pick(0, endpoints.size() - 1);
+    for (unsigned ii = 0; ii < m; ++ii) {
+      std::uint32_t u = endpoints[pick(rng)];
+      list.edges.emplace_back(v, u, random_weight(rng, max_weight));
+      endpoints.push_back(u);
+      endpoints.push_back(v);
+    }
+  }
+
+  return list;
+}
+
+}
+
+}
+
+#endif
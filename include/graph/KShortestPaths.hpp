@@ -0,0 +1,332 @@
+#ifndef QAED_K_SHORTEST_PATHS_H
+#define QAED_K_SHORTEST_PATHS_H
+
+#include <set>
+#include <queue>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <type_traits>
+
+#include "CSRGraph.hpp"
+
+namespace qaed {
+
+template <class EdgeTag>
+struct WeightedPath {
+  std::vector<std::uint32_t> vertexes;
+  EdgeTag                    cost;
+
+  bool operator<(const WeightedPath& p) const {
+    return cost < p.cost || (!(p.cost < cost) && vertexes < p.vertexes);
+  }
+};
+
+/// Point to point shortest paths on a CSRGraph. A reverse Dijkstra
+/// from the target is run once and used as an exact A* heuristic, and
+/// searches can ban vertexes and arcs without copying the graph. When
+/// a search pops a vertex whose path in the reverse shortest path tree
+/// avoids every ban, that tree path completes the answer right away.
+/// Scratch arrays are reused with stamps, so a search only touches the
+/// vertexes it reaches.
+template <class VertexTag, class EdgeTag>
+class PathFinder {
+public:
+  using Id     = typename CSRGraph<VertexTag, EdgeTag>::Id;
+  using Offset = typename CSRGraph<VertexTag, EdgeTag>::Offset;
+  using Path   = WeightedPath<EdgeTag>;
+
+  static constexpr Id NONE = CSRGraph<VertexTag, EdgeTag>::NONE;
+
+private:
+  using Entry = std::pair<EdgeTag, Id>;
+
+  const CSRGraph<VertexTag, EdgeTag>& m_g;
+  Id                                  m_target;
+
+  std::vector<EdgeTag>  m_to_target;
+  std::vector<bool>     m_reaches;
+  std::vector<Id>       m_next;
+  std::vector<Offset>   m_next_arc;
+
+  std::vector<EdgeTag>  m_dist;
+  std::vector<Id>       m_parent;
+  std::vector<unsigned> m_seen;
+  std::vector<unsigned> m_banned_vertex;
+  std::vector<unsigned> m_banned_arc;
+  std::vector<unsigned> m_clean_seen;
+  std::vector<bool>     m_clean;
+  std::vector<Id>       m_chain;
+  std::vector<Entry>    m_heap;
+  unsigned              m_stamp;
+  unsigned              m_ban_stamp;
+
+public:
+  PathFinder(const CSRGraph<VertexTag, EdgeTag>& g, Id target) :
+    m_g(g),
+    m_target(target),
+    m_to_target(g.no_vertexes(), EdgeTag()),
+    m_reaches(g.no_vertexes(), false),
+    m_next(g.no_vertexes(), NONE),
+    m_next_arc(g.no_vertexes(), 0),
+    m_dist(g.no_vertexes()),
+    m_parent(g.no_vertexes(), NONE),
+    m_seen(g.no_vertexes(), 0),
+    m_banned_vertex(g.no_vertexes(), 0),
+    m_banned_arc(g.no_edges(), 0),
+    m_clean_seen(g.no_vertexes(), 0),
+    m_clean(g.no_vertexes(), false),
+    m_stamp(0),
+    m_ban_stamp(1) {
+    static_assert(std::is_arithmetic<EdgeTag>::value, "Shortest paths only work for arithmetic EdgeTags.");
+
+    if (target >= g.no_vertexes()) throw std::out_of_range("Target vertex doesn't exist");
+    reverse_dijkstra();
+  }
+
+  /// Lower bound (exact without bans) from v to the target
+  bool reaches(Id v) const { return m_reaches[v]; }
+  EdgeTag to_target(Id v) const { return m_to_target[v]; }
+
+  /// Drops every ban
+  void clear_bans() { ++m_ban_stamp; }
+
+  void ban_vertex(Id v)  { m_banned_vertex[v] = m_ban_stamp; }
+  void ban_arc(Offset e) { m_banned_arc[e] = m_ban_stamp; }
+  void unban_arc(Offset e) { m_banned_arc[e] = 0; }
+
+  bool banned_arc(Offset e) const { return m_banned_arc[e] == m_ban_stamp; }
+  bool banned_vertex(Id v)  const { return m_banned_vertex[v] == m_ban_stamp; }
+
+  /// Shortest path from source to the target avoiding the bans,
+  /// false if there isn't any
+  bool search(Id source, Path& out) {
+    out.vertexes.clear();
+    if (!m_reaches[source] || banned_vertex(source)) return false;
+
+    ++m_stamp;
+    m_heap.clear();
+
+    touch(source, EdgeTag(), NONE);
+    push(m_to_target[source], source);
+
+    while (!m_heap.empty()) {
+      std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<Entry>());
+      Entry top = m_heap.back(); m_heap.pop_back();
+      Id u = top.second;
+
+      if (top.first != m_dist[u] + m_to_target[u]) continue;
+
+      if (u == m_target || (u != source && clean_tree_path(u, source))) {
+        for (Id v = u; v != NONE; v = m_parent[v])
+          out.vertexes.push_back(v);
+        std::reverse(out.vertexes.begin(), out.vertexes.end());
+
+        for (Id v = m_next[u]; v != NONE; v = m_next[v])
+          out.vertexes.push_back(v);
+
+        out.cost = m_dist[u] + m_to_target[u];
+        return true;
+      }
+
+      for (Offset e = m_g.offsets()[u]; e < m_g.offsets()[u + 1]; ++e) {
+        Id w = m_g.targets()[e];
+        if (!m_reaches[w] || banned_arc(e) || banned_vertex(w)) continue;
+
+        EdgeTag d = m_dist[u] + m_g.tags()[e];
+        if (m_seen[w] != m_stamp || d < m_dist[w]) {
+          touch(w, d, u);
+          push(d + m_to_target[w], w);
+        }
+      }
+    }
+
+    return false;
+  }
+
+  /// Arc u -> v with the smallest tag (the one a shortest path uses)
+  Offset arc(Id u, Id v) const {
+    const Id* it = std::lower_bound(m_g.nbr_begin(u), m_g.nbr_end(u), v);
+    return it - m_g.targets().data();
+  }
+
+private:
+
+  void push(EdgeTag key, Id v) {
+    m_heap.emplace_back(key, v);
+    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<Entry>());
+  }
+
+  /// True if the tree path from v to the target avoids the bans and
+  /// the source, memoized for the current search
+  bool clean_tree_path(Id v, Id source) {
+    m_chain.clear();
+
+    bool clean = true;
+    for (Id x = v; ; x = m_next[x]) {
+      if (m_clean_seen[x] == m_stamp) { clean = m_clean[x]; break; }
+
+      m_chain.push_back(x);
+      if (x == source || banned_vertex(x)) { clean = false; break; }
+      if (x == m_target) break;
+      if (banned_arc(m_next_arc[x])) { clean = false; break; }
+    }
+
+    // Everything before a dirty vertex is dirty too
+    for (Id x : m_chain) {
+      m_clean_seen[x] = m_stamp;
+      m_clean[x]      = clean;
+    }
+
+    return clean;
+  }
+
+  void touch(Id v, EdgeTag d, Id parent) {
+    m_seen[v]   = m_stamp;
+    m_dist[v]   = d;
+    m_parent[v] = parent;
+  }
+
+  void reverse_dijkstra() {
+    CSRGraph<VertexTag, EdgeTag> transposed;
+    if (m_g.directed()) transposed = m_g.transposed();
+    const auto& rev = m_g.directed() ? transposed : m_g;
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    std::vector<bool> done(m_g.no_vertexes(), false);
+
+    m_reaches[m_target] = true;
+    heap.emplace(EdgeTag(), m_target);
+
+    while (!heap.empty()) {
+      auto top = heap.top(); heap.pop();
+      Id u = top.second;
+      if (done[u]) continue;
+      done[u] = true;
+
+      for (Offset e = rev.offsets()[u]; e < rev.offsets()[u + 1]; ++e) {
+        Id w = rev.targets()[e];
+        if (rev.tags()[e] < EdgeTag()) throw std::invalid_argument("Negative weights aren't supported");
+
+        EdgeTag d = top.first + rev.tags()[e];
+        if (!m_reaches[w] || d < m_to_target[w]) {
+          m_reaches[w]   = true;
+          m_to_target[w] = d;
+          m_next[w]      = u;
+          heap.emplace(d, w);
+        }
+      }
+    }
+
+    for (Id v = 0; v < m_g.no_vertexes(); ++v)
+      if (m_next[v] != NONE) m_next_arc[v] = arc(v, m_next[v]);
+  }
+
+};
+
+/// Yen's algorithm: up to k loopless paths from source to target by
+/// increasing cost. Candidates live in an ordered set (priority queue
+/// without duplicates) and spur searches whose result is still valid
+/// under the current bans aren't recomputed. budget
+/// bounds the wall clock time, the paths found so far are returned
+/// when it runs out. Use CSRGraph::id_of to get the ids of tags.
+template <class VertexTag, class EdgeTag>
+std::vector<WeightedPath<EdgeTag>> k_shortest_paths(const CSRGraph<VertexTag, EdgeTag>& g, std::uint32_t source, std::uint32_t target,
+                                                    std::size_t k, std::chrono::microseconds budget = std::chrono::microseconds::max()) {
+  using Finder = PathFinder<VertexTag, EdgeTag>;
+  using Path   = typename Finder::Path;
+  using Id     = typename Finder::Id;
+  using Offset = typename Finder::Offset;
+
+  std::vector<Path> result;
+  if (k == 0 || source >= g.no_vertexes()) return result;
+
+  auto deadline = budget == std::chrono::microseconds::max()
+    ? std::chrono::steady_clock::time_point::max()
+    : std::chrono::steady_clock::now() + budget;
+
+  Finder finder(g, target);
+
+  Path first;
+  if (!finder.search(source, first)) return result;
+  result.push_back(first);
+
+  std::set<Path> candidates;
+
+  // spur_next[p][ii] is the vertex following the spur in the candidate
+  // made from the root result[p][0..ii] (NONE if there wasn't any). While
+  // that arc isn't banned the candidate is still the best for the root
+  // and it's already in candidates, so the spur search is skipped.
+  std::vector<std::vector<Id>> spur_next;
+  std::vector<std::size_t>     common;
+  std::vector<Offset>          banned;
+
+  while (result.size() < k) {
+    const std::size_t last_index = result.size() - 1;
+    const auto&       last       = result.back().vertexes;
+
+    spur_next.emplace_back(last.size(), Finder::NONE);
+
+    common.assign(last_index, 0);
+    for (std::size_t p = 0; p < last_index; ++p) {
+      const auto& v = result[p].vertexes;
+      while (common[p] < std::min(v.size(), last.size()) && v[common[p]] == last[common[p]])
+        ++common[p];
+    }
+
+    finder.clear_bans();
+    EdgeTag root_cost = EdgeTag();
+
+    for (std::size_t ii = 0; ii + 1 < last.size(); ++ii) {
+      if (std::chrono::steady_clock::now() > deadline) return result;
+
+      Id spur = last[ii];
+      if (ii > 0) {
+        finder.ban_vertex(last[ii - 1]);
+        root_cost += g.tags()[finder.arc(last[ii - 1], spur)];
+      }
+
+      for (Offset e : banned) finder.unban_arc(e);
+      banned.clear();
+
+      // Arcs leaving the spur along any accepted path sharing this root,
+      // the first of those paths owns the cache entry of the root
+      std::size_t owner = last_index;
+      for (std::size_t p = 0; p < last_index; ++p) {
+        if (common[p] < ii + 1 || result[p].vertexes.size() <= ii + 1) continue;
+        banned.push_back(finder.arc(spur, result[p].vertexes[ii + 1]));
+        owner = std::min(owner, p);
+      }
+      banned.push_back(finder.arc(spur, last[ii + 1]));
+
+      for (Offset e : banned) finder.ban_arc(e);
+
+      Id& cached = spur_next[owner][ii];
+      if (owner != last_index && (cached == Finder::NONE || !finder.banned_arc(finder.arc(spur, cached))))
+        continue;
+
+      Path spur_path;
+      cached = Finder::NONE;
+      if (!finder.search(spur, spur_path)) continue;
+      cached = spur_path.vertexes[1];
+
+      Path candidate;
+      candidate.vertexes.reserve(ii + spur_path.vertexes.size());
+      candidate.vertexes.assign(last.begin(), last.begin() + ii);
+      candidate.vertexes.insert(candidate.vertexes.end(), spur_path.vertexes.begin(), spur_path.vertexes.end());
+      candidate.cost = root_cost + spur_path.cost;
+      candidates.insert(std::move(candidate));
+    }
+
+    if (candidates.empty()) break;
+
+    result.push_back(*candidates.begin());
+    candidates.erase(candidates.begin());
+  }
+
+  return result;
+}
+
+}
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef QAED_MATCHING_H
+#define QAED_MATCHING_H
+
+#include <queue>
+#include <limits>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+#include "CSRGraph.hpp"
+
+namespace qaed {
+
+/// mate[v] is the vertex matched with v or NONE
+struct Matching {
+  using Id = std::uint32_t;
+
+  std::vector<Id> mate;
+  std::size_t     size   = 0;
+  double          weight = 0;
+
+  template <class VertexTag, class EdgeTag>
+  std::vector<std::pair<VertexTag, VertexTag>> pairs(const CSRGraph<VertexTag, EdgeTag>& g, const std::vector<bool>& left) const {
+    std::vector<std::pair<VertexTag, VertexTag>> result;
+    result.reserve(size);
+
+    for (Id v = 0; v < mate.size(); ++v)
+      if (left[v] && mate[v] != CSRGraph<VertexTag, EdgeTag>::NONE)
+        result.emplace_back(g.label(v), g.label(mate[v]));
+
+    return result;
+  }
+};
+
+/// Maximum cardinality matching, O(E sqrt(V)).
+/// left[v] tells the side of v, arcs between vertexes of the same
+/// side are ignored. For DIRECTED graphs arcs need to go from the
+/// left side to the right side.
+template <class VertexTag, class EdgeTag>
+Matching hopcroft_karp(const CSRGraph<VertexTag, EdgeTag>& g, const std::vector<bool>& left) {
+  using Id     = typename CSRGraph<VertexTag, EdgeTag>::Id;
+  using Offset = typename CSRGraph<VertexTag, EdgeTag>::Offset;
+
+  const Id NONE = CSRGraph<VertexTag, EdgeTag>::NONE;
+  const Id INF  = std::numeric_limits<Id>::max();
+  const Id n    = g.no_vertexes();
+
+  if (left.size() != n) throw std::invalid_argument("Partition size doesn't match the graph");
+
+  Matching m;
+  m.mate.assign(n, NONE);
+
+  std::vector<Id> lefts;
+  for (Id v = 0; v < n; ++v)
+    if (left[v]) lefts.push_back(v);
+
+  // Cheap greedy start, usually leaves few augmenting phases
+  for (Id u : lefts) {
+    for (const Id* w = g.nbr_begin(u); w != g.nbr_end(u); ++w) {
+      if (!left[*w] && m.mate[*w] == NONE) {
+        m.mate[u] = *w; m.mate[*w] = u;
+        ++m.size;
+        break;
+      }
+    }
+  }
+
+  std::vector<Id>     dist(n, INF);
+  std::vector<Id>     queue(lefts.size());
+  std::vector<Offset> arc(n);
+  std::vector<Id>     stack;
+
+  while (true) {
+    // BFS layering from the free left vertexes
+    std::size_t head = 0, tail = 0;
+    for (Id u : lefts) {
+      if (m.mate[u] == NONE) { dist[u] = 0; queue[tail++] = u; }
+      else dist[u] = INF;
+    }
+
+    Id limit = INF;
+    while (head < tail) {
+      Id u = queue[head++];
+      if (dist[u] >= limit) continue;
+
+      for (const Id* w = g.nbr_begin(u); w != g.nbr_end(u); ++w) {
+        if (left[*w]) continue;
+
+        Id x = m.mate[*w];
+        if (x == NONE) {
+          if (limit == INF) limit = dist[u] + 1;
+        } else if (dist[x] == INF) {
+          dist[x] = dist[u] + 1;
+          queue[tail++] = x;
+        }
+      }
+    }
+
+    if (limit == INF) break;
+
+    // DFS augmentation along the layers, arc[] keeps the current
+    // arc of every vertex so each arc is scanned once per phase
+    for (Id u : lefts)
+      arc[u] = g.offsets()[u];
+
+    for (Id root : lefts) {
+      if (m.mate[root] != NONE || dist[root] != 0) continue;
+
+      stack.clear();
+      stack.push_back(root);
+
+      while (!stack.empty()) {
+        Id u = stack.back();
+        Offset end = g.offsets()[u + 1];
+        bool advanced = false;
+
+        for (; arc[u] < end; ++arc[u]) {
+          Id w = g.targets()[arc[u]];
+          if (left[w]) continue;
+
+          Id x = m.mate[w];
+          if (x == NONE) {
+            if (dist[u] + 1 != limit) continue;
+
+            // Augment, the stack holds the alternating path
+            for (std::size_t ii = stack.size(); ii-- > 0;) {
+              Id a  = stack[ii];
+              Id b  = g.targets()[arc[a]];
+              m.mate[a] = b; m.mate[b] = a;
+              dist[a] = INF;
+            }
+            ++m.size;
+            stack.clear();
+            advanced = true;
+            break;
+          }
+
+          if (dist[x] == dist[u] + 1) {
+            stack.push_back(x);
+            advanced = true;
+            break;
+          }
+        }
+
+        if (!advanced) {
+          dist[u] = INF;
+          stack.pop_back();
+          if (!stack.empty()) ++arc[stack.back()];
+        }
+      }
+    }
+  }
+
+  return m;
+}
+
+template <class VertexTag, class EdgeTag>
+Matching hopcroft_karp(const CSRGraph<VertexTag, EdgeTag>& g, const std::function<bool (const VertexTag&)>& is_left) {
+  std::vector<bool> left(g.no_vertexes());
+  for (std::uint32_t v = 0; v < g.no_vertexes(); ++v)
+    left[v] = is_left(g.label(v));
+
+  return hopcroft_karp(g, left);
+}
+
+/// Weighted assignment (sparse Hungarian method, successive shortest
+/// augmenting paths with dual potentials). Every left vertex gets
+/// matched through the cheapest augmenting path available, the ones
+/// without any stay unmatched. Use maximize = true to look for the
+/// heaviest assignment instead.
+template <class VertexTag, class EdgeTag>
+Matching assignment(const CSRGraph<VertexTag, EdgeTag>& g, const std::vector<bool>& left, bool maximize = false) {
+  static_assert(std::is_arithmetic<EdgeTag>::value, "Weighted assignment only works for arithmetic EdgeTags.");
+
+  using Id     = typename CSRGraph<VertexTag, EdgeTag>::Id;
+  using Offset = typename CSRGraph<VertexTag, EdgeTag>::Offset;
+  using Entry  = std::pair<double, Id>;
+
+  const Id     NONE = CSRGraph<VertexTag, EdgeTag>::NONE;
+  const double INF  = std::numeric_limits<double>::infinity();
+  const Id     n    = g.no_vertexes();
+
+  if (left.size() != n) throw std::invalid_argument("Partition size doesn't match the graph");
+
+  auto cost = [&](Offset e) {
+    double c = static_cast<double>(g.tags()[e]);
+    return maximize ? -c : c;
+  };
+
+  Matching m;
+  m.mate.assign(n, NONE);
+
+  // Duals, reduced cost c(u,w) - pot[u] - pot[w] stays >= 0
+  std::vector<double> pot(n, 0);
+  for (Id u = 0; u < n; ++u) {
+    if (!left[u]) continue;
+
+    double best = INF;
+    for (Offset e = g.offsets()[u]; e < g.offsets()[u + 1]; ++e)
+      if (!left[g.targets()[e]]) best = std::min(best, cost(e));
+
+    pot[u] = best == INF ? 0 : best;
+  }
+
+  std::vector<double> dist(n, INF);
+  std::vector<Id>     from(n, NONE);
+  std::vector<bool>   done(n, false);
+  std::vector<Id>     touched;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+
+  for (Id s = 0; s < n; ++s) {
+    if (!left[s]) continue;
+
+    touched.clear();
+    heap = decltype(heap)();
+
+    dist[s] = 0; touched.push_back(s);
+    Id     free_end = NONE;
+    double found    = INF;
+
+    // Dijkstra over right vertexes, a left vertex inherits the
+    // distance of the right vertex it's matched with
+    Id u = s;
+    while (true) {
+      done[u] = true;
+
+      for (Offset e = g.offsets()[u]; e < g.offsets()[u + 1]; ++e) {
+        Id w = g.targets()[e];
+        if (left[w] || done[w]) continue;
+
+        double d = dist[u] + cost(e) - pot[u] - pot[w];
+        if (d < dist[w]) {
+          if (dist[w] == INF) touched.push_back(w);
+          dist[w] = d;
+          from[w] = u;
+          heap.emplace(d, w);
+        }
+      }
+
+      Id w = NONE;
+      while (!heap.empty()) {
+        auto top = heap.top(); heap.pop();
+        if (!done[top.second] && top.first == dist[top.second]) { w = top.second; break; }
+      }
+
+      if (w == NONE) break;
+
+      done[w] = true;
+      if (m.mate[w] == NONE) { free_end = w; found = dist[w]; break; }
+
+      u = m.mate[w];
+      dist[u] = dist[w];
+      touched.push_back(u);
+    }
+
+    if (free_end != NONE) {
+      for (Id v : touched) {
+        if (!done[v] || dist[v] >= found) continue;
+        if (left[v]) pot[v] += found - dist[v];
+        else         pot[v] -= found - dist[v];
+      }
+
+      for (Id w = free_end; w != NONE;) {
+        Id a    = from[w];
+        Id next = m.mate[a];
+        m.mate[w] = a; m.mate[a] = w;
+        w = next;
+      }
+
+      ++m.size;
+    }
+
+    for (Id v : touched) { dist[v] = INF; done[v] = false; from[v] = NONE; }
+  }
+
+  for (Id u = 0; u < n; ++u) {
+    if (!left[u] || m.mate[u] == NONE) continue;
+    m.weight += static_cast<double>(*g.find_edge(u, m.mate[u]));
+  }
+
+  return m;
+}
+
+template <class VertexTag, class EdgeTag>
+Matching assignment(const CSRGraph<VertexTag, EdgeTag>& g, const std::function<bool (const VertexTag&)>& is_left, bool maximize = false) {
+  std::vector<bool> left(g.no_vertexes());
+  for (std::uint32_t v = 0; v < g.no_vertexes(); ++v)
+    left[v] = is_left(g.label(v));
+
+  return assignment(g, left, maximize);
+}
+
+}
+
+#endif
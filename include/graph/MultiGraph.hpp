@@ -0,0 +1,392 @@
+#ifndef QAED_MULTI_GRAPH_H
+#define QAED_MULTI_GRAPH_H
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "CSRGraph.hpp"
+
+namespace qaed {
+
+namespace multigraph {
+
+/// Ready made combiners for MultiGraph::aggregate
+struct Min {
+  template <class T> T operator()(const T& a, const T& b) const { return b < a ? b : a; }
+};
+
+struct Max {
+  template <class T> T operator()(const T& a, const T& b) const { return a < b ? b : a; }
+};
+
+struct Sum {
+  template <class T> T operator()(const T& a, const T& b) const { return a + b; }
+};
+
+}
+
+/// Graph allowing any number of edges between the same vertexes (Graph
+/// keeps one, its EdgeSet is ordered by destination only). Every edge
+/// gets an id when inserted that stays valid until the edge is removed
+/// and is never reused. Rows are sorted by (neighbour, edge id), so the
+/// parallel edges of a pair are contiguous and in insertion order.
+/// UNDIRECTED edges are listed in both rows, a self loop once.
+/// aggregate() collapses the parallel edges into a CSRGraph for the
+/// algorithms in include/graph.
+template <class VertexTag, class EdgeTag, G_TYPE type>
+class MultiGraph {
+public:
+  using Id     = std::uint32_t;
+  using EdgeId = std::uint64_t;
+  using Record = std::tuple<Id, Id, EdgeTag>;
+
+  static constexpr Id     NONE    = ~Id(0);
+  static constexpr EdgeId NO_EDGE = ~EdgeId(0);
+
+  struct EdgeRecord {
+    Id      from;
+    Id      to;
+    EdgeTag tag;
+  };
+
+private:
+  struct Row {
+    std::vector<Id>     nbr;
+    std::vector<EdgeId> ids;
+  };
+
+  std::vector<VertexTag>  m_labels;
+  std::vector<Row>        m_rows;
+  std::vector<bool>       m_alive;
+  std::map<VertexTag, Id> m_ids;
+  std::vector<EdgeRecord> m_edges;        // indexed by edge id
+  std::vector<bool>       m_edge_alive;
+  std::size_t             m_no_edges;
+
+public:
+  MultiGraph() : m_no_edges(0) {
+    static_assert(type == DIRECTED || type == UNDIRECTED,
+                  "Unknown graph type (posible values are {qaed::DIRECTED, qaed::UNDIRECTED})");
+  }
+
+  std::size_t no_vertexes() const { return m_ids.size(); }
+  std::size_t no_edges()    const { return m_no_edges; }
+
+  /// Ids are in [0, id_bound()) and edge ids in [0, edge_bound()),
+  /// removed ones stay dead
+  Id     id_bound()   const { return m_labels.size(); }
+  EdgeId edge_bound() const { return m_edges.size(); }
+
+  bool alive(Id v)           const { return v < m_alive.size() && m_alive[v]; }
+  bool edge_alive(EdgeId e)  const { return e < m_edge_alive.size() && m_edge_alive[e]; }
+
+  const VertexTag& label(Id v) const { return m_labels[v]; }
+
+  /// Returns NONE when the tag isn't in the graph, O(logn)
+  Id id_of(const VertexTag& tag) const {
+    auto it = m_ids.find(tag);
+    return it == m_ids.end() ? NONE : it->second;
+  }
+
+  /// Endpoints and tag of a live edge, from/to as inserted
+  const EdgeRecord& edge(EdgeId e) const {
+    if (!edge_alive(e)) throw std::out_of_range("Edge was not found");
+    return m_edges[e];
+  }
+
+  void set_tag(EdgeId e, const EdgeTag& data) {
+    if (!edge_alive(e)) throw std::out_of_range("Edge was not found");
+    m_edges[e].tag = data;
+  }
+
+  std::size_t degree(Id v) const { return m_rows[v].nbr.size(); }
+
+  const Id* nbr_begin(Id v) const { return m_rows[v].nbr.data(); }
+  const Id* nbr_end(Id v)   const { return m_rows[v].nbr.data() + m_rows[v].nbr.size(); }
+
+  /// Returns {id, inserted}
+  std::pair<Id, bool> add_vertex(const VertexTag& data) {
+    auto result = m_ids.emplace(data, m_labels.size());
+    if (!result.second) return { result.first->second, false };
+
+    m_labels.push_back(data);
+    m_rows.emplace_back();
+    m_alive.push_back(true);
+    return { result.first->second, true };
+  }
+
+  /// Always inserts, returns the id of the new edge
+  EdgeId add_edge(const VertexTag& d1, const VertexTag& d2, const EdgeTag& data) {
+    Id u = id_of(d1), v = id_of(d2);
+    if (u == NONE || v == NONE)
+      throw std::runtime_error("One/two vertex(s) were not found");
+
+    return link(u, v, data);
+  }
+
+  /// Same as add_edge on ids. The new id is the largest one, so it goes
+  /// at the end of the run of v in row u
+  EdgeId link(Id u, Id v, const EdgeTag& data) {
+    if (!alive(u) || !alive(v)) throw std::out_of_range("Vertex id out of range");
+
+    EdgeId e = new_edge(u, v, data);
+    append_to(m_rows[u], v, e);
+    if (type == UNDIRECTED && u != v) append_to(m_rows[v], u, e);
+
+    return e;
+  }
+
+  /// Bulk insertion for large batches, ids are given in order starting
+  /// at the returned one. The batch is bucketed by row (counting sort)
+  /// and every touched row merged once, no per edge shifting.
+  EdgeId add_edges(const std::vector<Record>& records) {
+    for (auto& r : records)
+      if (!alive(std::get<0>(r)) || !alive(std::get<1>(r))) throw std::out_of_range("Vertex id out of range");
+
+    const EdgeId first = m_edges.size();
+    m_edges.reserve(first + records.size());
+    m_edge_alive.reserve(first + records.size());
+
+    std::vector<std::size_t> start(id_bound() + 1, 0);
+    for (auto& r : records) {
+      start[std::get<0>(r) + 1] += 1;
+      if (type == UNDIRECTED && std::get<0>(r) != std::get<1>(r)) start[std::get<1>(r) + 1] += 1;
+    }
+    for (Id v = 0; v < id_bound(); ++v) start[v + 1] += start[v];
+
+    std::vector<std::pair<Id, EdgeId>> bucket(start.back());
+    std::vector<std::size_t> fill(start.begin(), start.end() - 1);
+
+    for (auto& r : records) {
+      Id u = std::get<0>(r), v = std::get<1>(r);
+      EdgeId e = new_edge(u, v, std::get<2>(r));
+
+      bucket[fill[u]++] = std::make_pair(v, e);
+      if (type == UNDIRECTED && u != v) bucket[fill[v]++] = std::make_pair(u, e);
+    }
+
+    for (Id v = 0; v < id_bound(); ++v) {
+      if (start[v] == start[v + 1]) continue;
+
+      // Ids already increase inside the bucket, sorting by neighbour
+      // stably gives (neighbour, id) order
+      auto b = bucket.begin() + start[v], e = bucket.begin() + start[v + 1];
+      std::stable_sort(b, e, [](const std::pair<Id, EdgeId>& x, const std::pair<Id, EdgeId>& y) { return x.first < y.first; });
+      merge_into(m_rows[v], b, e);
+    }
+
+    return first;
+  }
+
+  /// Removes one edge, the other edges keep their ids
+  bool remove_edge(EdgeId e) {
+    if (!edge_alive(e)) return false;
+
+    const EdgeRecord& r = m_edges[e];
+    erase_from(m_rows[r.from], r.to, e);
+    if (type == UNDIRECTED && r.from != r.to) erase_from(m_rows[r.to], r.from, e);
+
+    m_edge_alive[e] = false;
+    m_no_edges -= 1;
+    return true;
+  }
+
+  /// Removes every edge u -> v, returns how many there were
+  std::size_t remove_edges(const VertexTag& d1, const VertexTag& d2) {
+    Id u = id_of(d1), v = id_of(d2);
+    if (u == NONE || v == NONE) return 0;
+
+    auto run = parallel_edges(u, v);
+    std::vector<EdgeId> doomed(run.first, run.second);
+    for (EdgeId e : doomed) remove_edge(e);
+    return doomed.size();
+  }
+
+  bool remove_vertex(const VertexTag& data) {
+    Id v = id_of(data);
+    if (v == NONE) return false;
+
+    std::vector<EdgeId> doomed(m_rows[v].ids);
+
+    if constexpr (type == DIRECTED) {
+      // No reverse adjacency, every row has to be checked
+      for (Id u = 0; u < id_bound(); ++u) {
+        if (u == v || !alive(u)) continue;
+        auto run = run_of(m_rows[u], v);
+        doomed.insert(doomed.end(), m_rows[u].ids.begin() + run.first, m_rows[u].ids.begin() + run.second);
+      }
+    }
+
+    for (EdgeId e : doomed) remove_edge(e);
+
+    m_rows[v] = Row();
+    m_alive[v] = false;
+    m_ids.erase(data);
+    return true;
+  }
+
+  /// Ids of the edges u -> v, contiguous and in insertion order
+  std::pair<const EdgeId*, const EdgeId*> parallel_edges(Id u, Id v) const {
+    if (!alive(u) || !alive(v)) return { nullptr, nullptr };
+
+    const Row& row = m_rows[u];
+    auto run = run_of(row, v);
+    return { row.ids.data() + run.first, row.ids.data() + run.second };
+  }
+
+  std::size_t multiplicity(Id u, Id v) const {
+    auto run = parallel_edges(u, v);
+    return run.second - run.first;
+  }
+
+  /// f(neighbour id, edge id, tag) in increasing (neighbour, edge id) order
+  template <class Function>
+  void for_each_edge(Id v, Function&& f) const {
+    const Row& row = m_rows[v];
+    for (std::size_t ii = 0; ii < row.nbr.size(); ++ii)
+      f(row.nbr[ii], row.ids[ii], m_edges[row.ids[ii]].tag);
+  }
+
+  /// f(neighbour id, combined tag, multiplicity) once per neighbour,
+  /// parallel tags folded left to right with combine
+  template <class Combine, class Function>
+  void for_each_aggregate(Id v, Combine&& combine, Function&& f) const {
+    const Row& row = m_rows[v];
+
+    for (std::size_t ii = 0, jj; ii < row.nbr.size(); ii = jj) {
+      EdgeTag acc = m_edges[row.ids[ii]].tag;
+      for (jj = ii + 1; jj < row.nbr.size() && row.nbr[jj] == row.nbr[ii]; ++jj)
+        acc = combine(acc, m_edges[row.ids[jj]].tag);
+
+      f(row.nbr[ii], acc, jj - ii);
+    }
+  }
+
+  /// Simple graph with one arc per adjacent pair, tagged with the
+  /// parallel tags folded by combine. Dead ids are squeezed out.
+  template <class Combine>
+  CSRGraph<VertexTag, EdgeTag> aggregate(Combine combine) const {
+    return build_csr([&](Id v, std::vector<Id>& targets, std::vector<EdgeTag>& tags, const std::vector<Id>& rename) {
+      for_each_aggregate(v, combine, [&](Id w, const EdgeTag& t, std::size_t) {
+        targets.push_back(rename[w]);
+        tags.push_back(t);
+      });
+    });
+  }
+
+  CSRGraph<VertexTag, EdgeTag> min_view() const { return aggregate(multigraph::Min()); }
+  CSRGraph<VertexTag, EdgeTag> sum_view() const { return aggregate(multigraph::Sum()); }
+
+  /// Every edge as its own arc, parallel arcs next to each other
+  CSRGraph<VertexTag, EdgeTag> to_csr() const {
+    return build_csr([&](Id v, std::vector<Id>& targets, std::vector<EdgeTag>& tags, const std::vector<Id>& rename) {
+      for_each_edge(v, [&](Id w, EdgeId, const EdgeTag& t) {
+        targets.push_back(rename[w]);
+        tags.push_back(t);
+      });
+    });
+  }
+
+  void print(std::ostream& os = std::cout) const {
+    for (Id v = 0; v < id_bound(); ++v) {
+      if (!m_alive[v]) continue;
+      os << "[[" << m_labels[v] << "]] => {";
+
+      bool first = true;
+      for_each_edge(v, [&](Id w, EdgeId e, const EdgeTag& t) {
+        os << (first ? "" : ", ") << "(#" << e << " " << t << ", [" << m_labels[w] << "])";
+        first = false;
+      });
+
+      os << "}" << std::endl;
+    }
+  }
+
+private:
+
+  EdgeId new_edge(Id u, Id v, const EdgeTag& data) {
+    m_edges.push_back(EdgeRecord{ u, v, data });
+    m_edge_alive.push_back(true);
+    m_no_edges += 1;
+    return m_edges.size() - 1;
+  }
+
+  /// [first, last) positions of neighbour w inside row
+  static std::pair<std::size_t, std::size_t> run_of(const Row& row, Id w) {
+    auto range = std::equal_range(row.nbr.begin(), row.nbr.end(), w);
+    return { std::size_t(range.first - row.nbr.begin()), std::size_t(range.second - row.nbr.begin()) };
+  }
+
+  static void append_to(Row& row, Id w, EdgeId e) {
+    std::size_t pos = std::upper_bound(row.nbr.begin(), row.nbr.end(), w) - row.nbr.begin();
+    row.nbr.insert(row.nbr.begin() + pos, w);
+    row.ids.insert(row.ids.begin() + pos, e);
+  }
+
+  static void erase_from(Row& row, Id w, EdgeId e) {
+    auto run = run_of(row, w);
+    std::size_t pos = std::lower_bound(row.ids.begin() + run.first, row.ids.begin() + run.second, e) - row.ids.begin();
+
+    row.nbr.erase(row.nbr.begin() + pos);
+    row.ids.erase(row.ids.begin() + pos);
+  }
+
+  /// Merges a (neighbour, id) sorted batch into row, every id of the
+  /// batch is newer than the ones already there
+  template <class It>
+  static void merge_into(Row& row, It b, It e) {
+    std::vector<Id>     nbr;
+    std::vector<EdgeId> ids;
+    nbr.reserve(row.nbr.size() + (e - b));
+    ids.reserve(nbr.capacity());
+
+    std::size_t ii = 0;
+    for (; b != e; ++b) {
+      for (; ii < row.nbr.size() && !(b->first < row.nbr[ii]); ++ii) {
+        nbr.push_back(row.nbr[ii]);
+        ids.push_back(row.ids[ii]);
+      }
+      nbr.push_back(b->first);
+      ids.push_back(b->second);
+    }
+    nbr.insert(nbr.end(), row.nbr.begin() + ii, row.nbr.end());
+    ids.insert(ids.end(), row.ids.begin() + ii, row.ids.end());
+
+    row.nbr.swap(nbr);
+    row.ids.swap(ids);
+  }
+
+  template <class FillRow>
+  CSRGraph<VertexTag, EdgeTag> build_csr(FillRow fill) const {
+    std::vector<Id> rename(id_bound(), NONE);
+    std::vector<VertexTag> labels;
+    labels.reserve(no_vertexes());
+
+    for (Id v = 0; v < id_bound(); ++v)
+      if (m_alive[v]) { rename[v] = labels.size(); labels.push_back(m_labels[v]); }
+
+    std::vector<std::size_t> offsets(1, 0);
+    std::vector<Id>          targets;
+    std::vector<EdgeTag>     tags;
+    offsets.reserve(labels.size() + 1);
+
+    for (Id v = 0; v < id_bound(); ++v) {
+      if (!m_alive[v]) continue;
+      fill(v, targets, tags, rename);
+      offsets.push_back(targets.size());
+    }
+
+    return CSRGraph<VertexTag, EdgeTag>(std::move(labels), std::move(offsets), std::move(targets),
+                                        std::move(tags), type == DIRECTED);
+  }
+
+};
+
+}
+
+#endif
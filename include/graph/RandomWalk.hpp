@@ -0,0 +1,278 @@
+#ifndef QAED_RANDOM_WALK_H
+#define QAED_RANDOM_WALK_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "CSRGraph.hpp"
+#include "../tools/Parallel.hpp"
+
+namespace qaed {
+
+/// splitmix64, cheap enough to be re-seeded for every walk, which keeps
+/// the output independent of the number of threads
+struct WalkRng {
+  std::uint64_t state;
+
+  explicit WalkRng(std::uint64_t seed = 0) : state(seed) {}
+
+  std::uint64_t next() {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+
+  /// Uniform in [0, n), multiply-shift instead of modulo
+  std::uint64_t below(std::uint64_t n) {
+    return static_cast<std::uint64_t>((static_cast<unsigned __int128>(next()) * n) >> 64);
+  }
+
+  double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+/// Random walks and neighbour sampling over a CSRGraph (the graph
+/// must outlive the walker). Walks are written into one flat buffer,
+/// walk i takes [i * length, (i + 1) * length) and is padded with
+/// NONE when it reaches a vertex without out arcs.
+template <class VertexTag, class EdgeTag>
+class RandomWalker {
+public:
+  using Id     = typename CSRGraph<VertexTag, EdgeTag>::Id;
+  using Offset = typename CSRGraph<VertexTag, EdgeTag>::Offset;
+
+  static constexpr Id NONE = CSRGraph<VertexTag, EdgeTag>::NONE;
+
+  /// Sampled k-hop neighbourhood, hop h added the arcs
+  /// [hop_offsets[h], hop_offsets[h + 1]) of (sources, targets)
+  struct Sample {
+    std::vector<Id>     sources;
+    std::vector<Id>     targets;
+    std::vector<Offset> hop_offsets;
+  };
+
+private:
+  const CSRGraph<VertexTag, EdgeTag>& m_g;
+
+  // Alias tables, one entry per arc laid out like the CSR targets
+  std::vector<double> m_prob;
+  std::vector<Id>     m_alias;
+  unsigned            m_threads;
+
+public:
+  /// weighted = true builds the per vertex alias tables from the
+  /// EdgeTags (needs arithmetic, non negative tags, other tags throw)
+  RandomWalker(const CSRGraph<VertexTag, EdgeTag>& g, bool weighted = false, unsigned threads = default_threads()) :
+    m_g(g),
+    m_threads(std::max(1u, threads)) {
+    if constexpr (std::is_arithmetic<EdgeTag>::value) {
+      if (weighted) build_alias_tables();
+    } else {
+      if (weighted) throw std::invalid_argument("Weighted walks only work for arithmetic EdgeTags");
+    }
+  }
+
+  bool weighted() const { return !m_prob.empty(); }
+
+  std::vector<Id> walks(const std::vector<Id>& starts, unsigned length, std::uint64_t seed = 1) const {
+    std::vector<Id> out(starts.size() * std::size_t(length), NONE);
+    if (!length) return out;
+
+    parallel_for(0, starts.size(), m_threads, [&](std::size_t b, std::size_t e, unsigned) {
+      WalkRng rng;
+      for (std::size_t w = b; w < e; ++w) {
+        rng.state = seed ^ (w * 0xd1b54a32d192ed03ull);
+
+        Id* walk = out.data() + w * length;
+        Id  u    = starts[w];
+        walk[0]  = u;
+
+        for (unsigned step = 1; step < length; ++step) {
+          u = first_order_step(u, rng);
+          if (u == NONE) break;
+          walk[step] = u;
+        }
+      }
+    });
+
+    return out;
+  }
+
+  /// node2vec second order walks: going back has weight 1/p, staying
+  /// at distance 1 of the previous vertex 1, moving away 1/q. Uses
+  /// rejection sampling over the first order distribution, so each
+  /// step costs O(log(degree)) instead of O(degree).
+  std::vector<Id> node2vec_walks(const std::vector<Id>& starts, unsigned length, double p, double q, std::uint64_t seed = 1) const {
+    if (p <= 0 || q <= 0) throw std::invalid_argument("node2vec p and q need to be positive");
+
+    std::vector<Id> out(starts.size() * std::size_t(length), NONE);
+    if (!length) return out;
+
+    const double back  = 1.0 / p;
+    const double away  = 1.0 / q;
+    const double upper = std::max({ back, 1.0, away });
+
+    parallel_for(0, starts.size(), m_threads, [&](std::size_t b, std::size_t e, unsigned) {
+      WalkRng rng;
+      for (std::size_t w = b; w < e; ++w) {
+        rng.state = seed ^ (w * 0xd1b54a32d192ed03ull);
+
+        Id* walk = out.data() + w * length;
+        Id  prev = starts[w];
+        walk[0]  = prev;
+        if (length < 2) continue;
+
+        Id u = first_order_step(prev, rng);
+        if (u == NONE) continue;
+        walk[1] = u;
+
+        for (unsigned step = 2; step < length; ++step) {
+          if (m_g.degree(u) == 0) break;
+
+          Id x;
+          while (true) {
+            x = first_order_step(u, rng);
+
+            double alpha;
+            if      (x == prev)                     alpha = back;
+            else if (m_g.find_edge(prev, x))        alpha = 1.0;
+            else                                    alpha = away;
+
+            if (rng.unit() * upper < alpha) break;
+          }
+
+          walk[step] = x;
+          prev = u;
+          u    = x;
+        }
+      }
+    });
+
+    return out;
+  }
+
+  /// GraphSAGE style sampling, hop h takes up to fanouts[h] distinct
+  /// out neighbours (weighted if the walker is) of every vertex reached
+  /// in the previous hop
+  Sample sample_neighbours(const std::vector<Id>& seeds, const std::vector<unsigned>& fanouts, std::uint64_t seed = 1) const {
+    Sample s;
+    s.hop_offsets.push_back(0);
+
+    std::vector<Id> frontier(seeds), next;
+    std::vector<Id> picked;
+    WalkRng rng(seed);
+
+    for (unsigned fanout : fanouts) {
+      next.clear();
+
+      for (Id u : frontier) {
+        Offset deg = m_g.degree(u);
+        picked.clear();
+
+        if (deg <= fanout) {
+          picked.assign(m_g.nbr_begin(u), m_g.nbr_end(u));
+        } else if (!weighted()) {
+          // Floyd's algorithm, fanout distinct positions
+          for (Offset j = deg - fanout; j < deg; ++j) {
+            Offset t = rng.below(j + 1);
+            Id     x = m_g.nbr_begin(u)[t];
+            if (std::find(picked.begin(), picked.end(), x) != picked.end())
+              x = m_g.nbr_begin(u)[j];
+            picked.push_back(x);
+          }
+        } else {
+          for (unsigned tries = 0; picked.size() < fanout && tries < 8 * fanout; ++tries) {
+            Id x = first_order_step(u, rng);
+            if (std::find(picked.begin(), picked.end(), x) == picked.end())
+              picked.push_back(x);
+          }
+        }
+
+        for (Id x : picked) {
+          s.sources.push_back(u);
+          s.targets.push_back(x);
+          next.push_back(x);
+        }
+      }
+
+      s.hop_offsets.push_back(s.targets.size());
+
+      std::sort(next.begin(), next.end());
+      next.erase(std::unique(next.begin(), next.end()), next.end());
+      frontier.swap(next);
+    }
+
+    return s;
+  }
+
+private:
+
+  Id first_order_step(Id u, WalkRng& rng) const {
+    Offset deg = m_g.degree(u);
+    if (!deg) return NONE;
+
+    Offset beg = m_g.offsets()[u];
+    Offset k   = rng.below(deg);
+
+    if (weighted() && rng.unit() >= m_prob[beg + k])
+      k = m_alias[beg + k];
+
+    return m_g.targets()[beg + k];
+  }
+
+  /// Vose's alias method, built for every vertex in parallel
+  void build_alias_tables() {
+    static_assert(std::is_arithmetic<EdgeTag>::value, "Weighted walks only work for arithmetic EdgeTags.");
+
+    m_prob.assign(m_g.no_edges(), 1.0);
+    m_alias.assign(m_g.no_edges(), 0);
+
+    parallel_for_balanced(m_g.offsets(), m_threads, [&](std::size_t b, std::size_t e, unsigned) {
+      std::vector<Id>     small, large;
+      std::vector<double> scaled;
+
+      for (Id u = b; u < e; ++u) {
+        Offset beg = m_g.offsets()[u];
+        Offset deg = m_g.degree(u);
+        if (!deg) continue;
+
+        double sum = 0;
+        for (Offset k = 0; k < deg; ++k) {
+          double w = static_cast<double>(m_g.tags()[beg + k]);
+          if (w < 0) throw std::invalid_argument("Negative weight in weighted walk");
+          sum += w;
+        }
+
+        small.clear(); large.clear();
+        scaled.resize(deg);
+        for (Offset k = 0; k < deg; ++k) {
+          m_alias[beg + k] = k;
+          scaled[k] = sum > 0 ? static_cast<double>(m_g.tags()[beg + k]) * deg / sum : 1.0;
+          (scaled[k] < 1.0 ? small : large).push_back(k);
+        }
+
+        while (!small.empty() && !large.empty()) {
+          Id s = small.back(); small.pop_back();
+          Id l = large.back();
+
+          m_prob[beg + s]  = scaled[s];
+          m_alias[beg + s] = l;
+
+          scaled[l] -= 1.0 - scaled[s];
+          if (scaled[l] < 1.0) { large.pop_back(); small.push_back(l); }
+        }
+
+        for (Id k : large) m_prob[beg + k] = 1.0;
+        for (Id k : small) m_prob[beg + k] = 1.0;
+      }
+    });
+  }
+
+};
+
+}
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef QAED_REORDER_H
+#define QAED_REORDER_H
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+
+#include "CSRGraph.hpp"
+
+namespace qaed {
+
+enum REORDER_STRATEGY {
+  BFS_ORDER,
+  RCM_ORDER,
+  DEGREE_ORDER,
+  PARTITION_ORDER
+};
+
+/// Vertex orderings for CSRGraph snapshots. Every function returns a
+/// permutation perm[old_id] = new_id ready for CSRGraph::permuted().
+/// DIRECTED graphs are traversed following out arcs only.
+namespace reorder {
+
+using Id = std::uint32_t;
+
+inline std::vector<Id> invert(const std::vector<Id>& order) {
+  std::vector<Id> perm(order.size());
+  for (Id ii = 0; ii < order.size(); ++ii)
+    perm[order[ii]] = ii;
+  return perm;
+}
+
+/// Breadth first order, a new traversal starts from the smallest
+/// unvisited id for every component
+template <class V, class E>
+std::vector<Id> bfs(const CSRGraph<V, E>& g) {
+  const Id n = g.no_vertexes();
+
+  std::vector<Id>   order;
+  std::vector<bool> seen(n, false);
+  order.reserve(n);
+
+  for (Id root = 0; root < n; ++root) {
+    if (seen[root]) continue;
+
+    std::size_t head = order.size();
+    order.push_back(root);
+    seen[root] = true;
+
+    while (head < order.size()) {
+      Id u = order[head++];
+      for (const Id* w = g.nbr_begin(u); w != g.nbr_end(u); ++w)
+        if (!seen[*w]) { seen[*w] = true; order.push_back(*w); }
+    }
+  }
+
+  return invert(order);
+}
+
+/// Reverse Cuthill-McKee, every component starts from a pseudo
+/// peripheral vertex (last vertex of a BFS from its minimum degree one)
+/// and neighbours are visited by increasing degree. Minimizes bandwidth.
+template <class V, class E>
+std::vector<Id> rcm(const CSRGraph<V, E>& g) {
+  const Id n = g.no_vertexes();
+
+  std::vector<Id>   order;
+  std::vector<Id>   level;
+  std::vector<Id>   nbrs;
+  std::vector<bool> seen(n, false);
+  std::vector<bool> probe(n, false);
+  order.reserve(n);
+
+  std::vector<Id> by_degree(n);
+  std::iota(by_degree.begin(), by_degree.end(), 0);
+  std::stable_sort(by_degree.begin(), by_degree.end(),
+      [&g](Id a, Id b) { return g.degree(a) < g.degree(b); });
+
+  // On directed graphs arcs can lead into vertexes already placed, and
+  // the BFS from the root doesn't have to reach back to the candidate,
+  // so a candidate is retried until it is placed itself
+  for (Id candidate : by_degree) {
+    while (!seen[candidate]) {
+      // One BFS sweep over unplaced vertexes to move to the far end
+      // of the component
+      level.assign(1, candidate);
+      probe[candidate] = true;
+      for (std::size_t head = 0; head < level.size(); ++head) {
+        Id u = level[head];
+        for (const Id* w = g.nbr_begin(u); w != g.nbr_end(u); ++w)
+          if (!probe[*w] && !seen[*w]) { probe[*w] = true; level.push_back(*w); }
+      }
+      for (Id v : level) probe[v] = false;
+
+      Id root = level.back();
+      std::size_t head = order.size();
+      order.push_back(root);
+      seen[root] = true;
+
+      while (head < order.size()) {
+        Id u = order[head++];
+
+        nbrs.clear();
+        for (const Id* w = g.nbr_begin(u); w != g.nbr_end(u); ++w)
+          if (!seen[*w]) { seen[*w] = true; nbrs.push_back(*w); }
+
+        std::sort(nbrs.begin(), nbrs.end(),
+            [&g](Id a, Id b) { return g.degree(a) < g.degree(b) || (g.degree(a) == g.degree(b) && a < b); });
+        order.insert(order.end(), nbrs.begin(), nbrs.end());
+      }
+    }
+  }
+
+  std::reverse(order.begin(), order.end());
+  return invert(order);
+}
+
+/// Hubs first (descending = true), counting sort so it's O(n)
+template <class V, class E>
+std::vector<Id> degree(const CSRGraph<V, E>& g, bool descending = true) {
+  const Id n = g.no_vertexes();
+
+  std::size_t max_degree = 0;
+  for (Id v = 0; v < n; ++v)
+    max_degree = std::max(max_degree, g.degree(v));
+
+  std::vector<std::size_t> start(max_degree + 2, 0);
+  for (Id v = 0; v < n; ++v) {
+    std::size_t d = descending ? max_degree - g.degree(v) : g.degree(v);
+    start[d + 1] += 1;
+  }
+  std::partial_sum(start.begin(), start.end(), start.begin());
+
+  std::vector<Id> perm(n);
+  for (Id v = 0; v < n; ++v) {
+    std::size_t d = descending ? max_degree - g.degree(v) : g.degree(v);
+    perm[v] = start[d]++;
+  }
+
+  return perm;
+}
+
+/// Size bounded label propagation, every vertex takes the label that
+/// is most frequent among its neighbours while that part has room.
+/// Returns a part id per vertex (ids aren't contiguous).
+template <class V, class E>
+std::vector<Id> label_propagation(const CSRGraph<V, E>& g, Id max_part_size, unsigned iterations = 10, std::uint64_t seed = 1) {
+  const Id n = g.no_vertexes();
+
+  std::vector<Id> label(n), size(n, 1), visit(n);
+  std::iota(label.begin(), label.end(), 0);
+  std::iota(visit.begin(), visit.end(), 0);
+
+  std::mt19937_64 rng(seed);
+  std::unordered_map<Id, Id> count;
+
+  for (unsigned it = 0; it < iterations; ++it) {
+    std::shuffle(visit.begin(), visit.end(), rng);
+    std::size_t moved = 0;
+
+    for (Id u : visit) {
+      count.clear();
+      for (const Id* w = g.nbr_begin(u); w != g.nbr_end(u); ++w)
+        count[label[*w]] += 1;
+
+      Id best = label[u], best_count = count.count(best) ? count[best] : 0;
+      for (auto& c : count) {
+        if (c.first == label[u] || size[c.first] >= max_part_size) continue;
+        if (c.second > best_count || (c.second == best_count && c.first < best)) {
+          best = c.first; best_count = c.second;
+        }
+      }
+
+      if (best != label[u]) {
+        size[label[u]] -= 1;
+        size[best]     += 1;
+        label[u] = best;
+        ++moved;
+      }
+    }
+
+    if (moved == 0) break;
+  }
+
+  return label;
+}
+
+/// Vertexes grouped by label_propagation part, BFS order inside each part
+template <class V, class E>
+std::vector<Id> partition(const CSRGraph<V, E>& g, Id max_part_size = 4096, unsigned iterations = 10) {
+  auto label = label_propagation(g, max_part_size, iterations);
+  auto local = bfs(g);
+
+  std::vector<Id> order(g.no_vertexes());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+      [&](Id a, Id b) { return label[a] < label[b] || (label[a] == label[b] && local[a] < local[b]); });
+
+  return invert(order);
+}
+
+}
+
+/// avg_nbr_distance is the mean |u - v| over all arcs, edge_cut counts
+/// arcs crossing blocks of `block` consecutive ids (a page/cache proxy)
+struct Locality {
+  double      avg_nbr_distance = 0;
+  std::size_t edge_cut         = 0;
+};
+
+template <class V, class E>
+Locality locality(const CSRGraph<V, E>& g, std::uint32_t block = 1024) {
+  Locality l;
+  double sum = 0;
+
+  for (std::uint32_t u = 0; u < g.no_vertexes(); ++u) {
+    for (const std::uint32_t* w = g.nbr_begin(u); w != g.nbr_end(u); ++w) {
+      sum += u > *w ? u - *w : *w - u;
+      if (u / block != *w / block) ++l.edge_cut;
+    }
+  }
+
+  if (g.no_edges()) l.avg_nbr_distance = sum / g.no_edges();
+  return l;
+}
+
+/// Arcs whose endpoints have different labels
+template <class V, class E>
+std::size_t edge_cut(const CSRGraph<V, E>& g, const std::vector<std::uint32_t>& label) {
+  std::size_t cut = 0;
+  for (std::uint32_t u = 0; u < g.no_vertexes(); ++u)
+    for (const std::uint32_t* w = g.nbr_begin(u); w != g.nbr_end(u); ++w)
+      if (label[u] != label[*w]) ++cut;
+  return cut;
+}
+
+template <class V, class E>
+struct Reordered {
+  CSRGraph<V, E>             graph;
+  std::vector<std::uint32_t> perm;
+  Locality                   before;
+  Locality                   after;
+};
+
+template <class V, class E>
+Reordered<V, E> reorder_graph(const CSRGraph<V, E>& g, REORDER_STRATEGY how, std::uint32_t block = 1024) {
+  Reordered<V, E> r;
+
+  switch (how) {
+    case BFS_ORDER:       r.perm = reorder::bfs(g);            break;
+    case RCM_ORDER:       r.perm = reorder::rcm(g);            break;
+    case DEGREE_ORDER:    r.perm = reorder::degree(g);         break;
+    case PARTITION_ORDER: r.perm = reorder::partition(g, block); break;
+  }
+
+  r.graph  = g.permuted(r.perm);
+  r.before = locality(g, block);
+  r.after  = locality(r.graph, block);
+  return r;
+}
+
+}
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef QAED_SUBGRAPH_H
+#define QAED_SUBGRAPH_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+
+#include "CSRGraph.hpp"
+
+namespace qaed {
+
+/// Read only view of part of a CSRGraph, nothing of the parent is
+/// copied: the view keeps the sorted parent ids of its vertexes and an
+/// optional arc predicate, and filters the parent rows while iterating.
+/// The vertex map is an open addressing table (linear probing, at most
+/// half full) from parent id to local id, so membership and renaming
+/// take O(1) expected per arc.
+/// The parent must outlive the view. materialize() builds a compact
+/// CSRGraph with ids renamed to [0, no_vertexes()).
+template <class VertexTag, class EdgeTag>
+class SubgraphView {
+public:
+  using Id        = typename CSRGraph<VertexTag, EdgeTag>::Id;
+  using Offset    = typename CSRGraph<VertexTag, EdgeTag>::Offset;
+  using ArcFilter = std::function<bool (Id, Id, const EdgeTag&)>;
+
+  static constexpr Id NONE = CSRGraph<VertexTag, EdgeTag>::NONE;
+
+private:
+  const CSRGraph<VertexTag, EdgeTag>* m_g;
+  std::vector<Id>                     m_vertexes;
+  std::vector<std::pair<Id, Id>>      m_slots;
+  Id                                  m_mask;
+  bool                                m_all;
+  ArcFilter                           m_filter;
+
+  SubgraphView(const CSRGraph<VertexTag, EdgeTag>& g, std::vector<Id> vertexes, bool all) :
+    m_g(&g),
+    m_vertexes(std::move(vertexes)),
+    m_mask(0),
+    m_all(all),
+    m_filter() {
+    if (!m_all) build_slots();
+  }
+
+public:
+  /// Subgraph induced by the given parent ids (any order, repeats allowed)
+  static SubgraphView induced(const CSRGraph<VertexTag, EdgeTag>& g, std::vector<Id> vertexes) {
+    std::sort(vertexes.begin(), vertexes.end());
+    vertexes.erase(std::unique(vertexes.begin(), vertexes.end()), vertexes.end());
+
+    if (!vertexes.empty() && vertexes.back() >= g.no_vertexes())
+      throw std::out_of_range("Vertex id out of range");
+
+    return SubgraphView(g, std::move(vertexes), false);
+  }
+
+  /// Every vertex at most `radius` hops away from center following out
+  /// arcs, the BFS stops once max_vertexes were collected
+  static SubgraphView ego(const CSRGraph<VertexTag, EdgeTag>& g, Id center, unsigned radius,
+                          std::size_t max_vertexes = std::size_t(-1)) {
+    if (center >= g.no_vertexes()) throw std::out_of_range("Vertex id out of range");
+
+    std::vector<Id>        found(1, center);
+    std::unordered_set<Id> seen;
+    seen.insert(center);
+
+    std::size_t level_begin = 0;
+    for (unsigned hop = 0; hop < radius && found.size() < max_vertexes; ++hop) {
+      std::size_t level_end = found.size();
+
+      for (std::size_t ii = level_begin; ii < level_end && found.size() < max_vertexes; ++ii) {
+        Id u = found[ii];
+        for (const Id* w = g.nbr_begin(u); w != g.nbr_end(u) && found.size() < max_vertexes; ++w)
+          if (seen.insert(*w).second) found.push_back(*w);
+      }
+
+      if (level_end == found.size()) break;
+      level_begin = level_end;
+    }
+
+    std::sort(found.begin(), found.end());
+    return SubgraphView(g, std::move(found), false);
+  }
+
+  /// Every vertex of the parent, only the arcs accepted by keep
+  static SubgraphView arcs_where(const CSRGraph<VertexTag, EdgeTag>& g, ArcFilter keep) {
+    SubgraphView view(g, std::vector<Id>(), true);
+    view.m_filter = std::move(keep);
+    return view;
+  }
+
+  /// Adds an arc predicate on top of the current one
+  SubgraphView& filter_arcs(ArcFilter keep) {
+    if (m_filter) {
+      ArcFilter prev = std::move(m_filter);
+      m_filter = [prev, keep](Id u, Id v, const EdgeTag& t) { return prev(u, v, t) && keep(u, v, t); };
+    } else {
+      m_filter = std::move(keep);
+    }
+    return *this;
+  }
+
+  const CSRGraph<VertexTag, EdgeTag>& parent() const { return *m_g; }
+
+  Id no_vertexes() const { return m_all ? m_g->no_vertexes() : m_vertexes.size(); }
+
+  /// Parent id of the i-th vertex of the view
+  Id parent_id(Id local) const { return m_all ? local : m_vertexes[local]; }
+
+  /// Position of a parent id inside the view or NONE
+  Id local_id(Id v) const {
+    if (m_all) return v < m_g->no_vertexes() ? v : NONE;
+
+    for (Id slot = hash(v); ; slot = (slot + 1) & m_mask) {
+      if (m_slots[slot].first == v)    return m_slots[slot].second;
+      if (m_slots[slot].first == NONE) return NONE;
+    }
+  }
+
+  bool contains(Id v) const { return local_id(v) != NONE; }
+
+  /// f(parent id of the neighbour, tag) for every arc of the view
+  /// leaving the parent vertex v
+  template <class Function>
+  void for_each_neighbour(Id v, Function&& f) const {
+    const Id*      beg = m_g->nbr_begin(v);
+    const Id*      end = m_g->nbr_end(v);
+    const EdgeTag* tag = m_g->tag_begin(v);
+    const Id*      first = beg;
+
+    auto visit = [&](const Id* w) {
+      if (m_filter && !m_filter(v, *w, tag[w - first])) return;
+      f(*w, tag[w - first]);
+    };
+
+    if (m_all || std::size_t(end - beg) <= m_vertexes.size()) {
+      for (const Id* w = beg; w != end; ++w)
+        if (contains(*w)) visit(w);
+      return;
+    }
+
+    // Row longer than the view (hubs), search the members in the row
+    for (Id x : m_vertexes) {
+      beg = std::lower_bound(beg, end, x);
+      if (beg == end) break;
+      if (*beg == x) visit(beg);
+    }
+  }
+
+  /// One pass over the member rows, rows stay sorted because local
+  /// ids keep the parent order
+  CSRGraph<VertexTag, EdgeTag> materialize() const {
+    const Id n = no_vertexes();
+
+    std::vector<VertexTag> labels;
+    std::vector<Offset>    offsets;
+    std::vector<Id>        targets;
+    std::vector<EdgeTag>   tags;
+
+    labels.reserve(n);
+    offsets.reserve(n + 1);
+    offsets.push_back(0);
+
+    for (Id l = 0; l < n; ++l) {
+      Id v = parent_id(l);
+      labels.push_back(m_g->label(v));
+
+      for_each_neighbour(v, [&](Id w, const EdgeTag& t) {
+        targets.push_back(local_id(w));
+        tags.push_back(t);
+      });
+      offsets.push_back(targets.size());
+    }
+
+    return CSRGraph<VertexTag, EdgeTag>(std::move(labels), std::move(offsets), std::move(targets),
+                                        std::move(tags), m_g->directed());
+  }
+
+private:
+
+  Id hash(Id v) const { return (v * 2654435761u) & m_mask; }
+
+  void build_slots() {
+    std::size_t cap = 16;
+    while (cap < 2 * m_vertexes.size()) cap <<= 1;
+
+    m_mask = cap - 1;
+    m_slots.assign(cap, std::make_pair(NONE, NONE));
+
+    for (Id l = 0; l < m_vertexes.size(); ++l) {
+      Id slot = hash(m_vertexes[l]);
+      while (m_slots[slot].first != NONE) slot = (slot + 1) & m_mask;
+      m_slots[slot] = std::make_pair(m_vertexes[l], l);
+    }
+  }
+
+};
+
+}
+
+#endif
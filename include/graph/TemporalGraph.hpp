@@ -0,0 +1,307 @@
+#ifndef QAED_TEMPORAL_GRAPH_H
+#define QAED_TEMPORAL_GRAPH_H
+
+#include <map>
+#include <cmath>
+#include <queue>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+#include "CSRGraph.hpp"
+
+namespace qaed {
+
+/// Graph whose edges are valid during [begin, end) and take `duration`
+/// to traverse, so leaving u at t in [begin, end) reaches v at
+/// t + duration. Each vertex keeps its edges sorted by begin together
+/// with a running maximum of end: the edges that can be active in a
+/// window [from, to) lie between two binary searches, no per slice
+/// copy of the graph is needed. Vertexes get dense ids in insertion
+/// order like CompactGraph.
+template <class VertexTag, class EdgeTag, G_TYPE type, class Time = long long>
+class TemporalGraph {
+public:
+  using Id = std::uint32_t;
+
+  static constexpr Id   NONE   = ~Id(0);
+  static constexpr Time NEVER  = std::numeric_limits<Time>::max();
+
+  struct TemporalEdge {
+    Id      to;
+    Time    begin;
+    Time    end;
+    Time    duration;
+    EdgeTag tag;
+  };
+
+  /// Result of the time respecting searches, arrival[v] is NEVER for
+  /// unreachable vertexes and parent[v] the previous hop
+  struct Arrivals {
+    std::vector<Time> arrival;
+    std::vector<Id>   parent;
+    Time              departure;
+
+    std::vector<Id> path_to(Id v) const {
+      std::vector<Id> path;
+      if (arrival[v] == NEVER) return path;
+
+      for (; v != NONE; v = parent[v]) path.push_back(v);
+      std::reverse(path.begin(), path.end());
+      return path;
+    }
+  };
+
+  struct TemporalPath {
+    std::vector<Id> vertexes;
+    Time            departure = NEVER;
+    Time            arrival   = NEVER;
+  };
+
+private:
+  struct Row {
+    std::vector<TemporalEdge> edges;     // sorted by begin
+    std::vector<Time>         max_end;   // max_end[i] = max(edges[0..i].end)
+  };
+
+  std::vector<VertexTag>  m_labels;
+  std::vector<Row>        m_rows;
+  std::map<VertexTag, Id> m_ids;
+  std::size_t             m_no_edges;
+
+public:
+  TemporalGraph() : m_no_edges(0) {
+    static_assert(type == DIRECTED || type == UNDIRECTED,
+                  "Unknown graph type (posible values are {qaed::DIRECTED, qaed::UNDIRECTED})");
+    static_assert(std::is_arithmetic<Time>::value, "Time needs to be an arithmetic type.");
+  }
+
+  std::size_t no_vertexes() const { return m_labels.size(); }
+  std::size_t no_edges()    const { return m_no_edges; }
+
+  const VertexTag& label(Id v) const { return m_labels[v]; }
+
+  /// Returns NONE when the tag isn't in the graph, O(logn)
+  Id id_of(const VertexTag& tag) const {
+    auto it = m_ids.find(tag);
+    return it == m_ids.end() ? NONE : it->second;
+  }
+
+  /// Returns {id, inserted}
+  std::pair<Id, bool> add_vertex(const VertexTag& data) {
+    auto result = m_ids.emplace(data, m_labels.size());
+    if (result.second) {
+      m_labels.push_back(data);
+      m_rows.emplace_back();
+    }
+    return { result.first->second, result.second };
+  }
+
+  /// Several edges between the same vertexes are fine, one per interval
+  void add_edge(const VertexTag& a, const VertexTag& b, Time begin, Time end, const EdgeTag& tag, Time duration = 0) {
+    Id u = id_of(a), v = id_of(b);
+    if (u == NONE || v == NONE)
+      throw std::runtime_error("One/two vertex(s) were not found");
+
+    link(u, v, begin, end, tag, duration);
+  }
+
+  /// Same as add_edge on ids
+  void link(Id u, Id v, Time begin, Time end, const EdgeTag& tag, Time duration = 0) {
+    if (u >= no_vertexes() || v >= no_vertexes()) throw std::out_of_range("Vertex id out of range");
+    if (!(begin < end))   throw std::invalid_argument("Empty validity interval");
+    if (duration < Time()) throw std::invalid_argument("Negative duration");
+
+    insert(u, TemporalEdge{ v, begin, end, duration, tag });
+    if (type == UNDIRECTED && u != v)
+      insert(v, TemporalEdge{ u, begin, end, duration, tag });
+
+    m_no_edges += 1;
+  }
+
+  /// Edges of v that can overlap [from, to): begin < to and end > from.
+  /// Both bounds are binary searches, the range can still hold a few
+  /// edges that ended before `from`.
+  std::pair<const TemporalEdge*, const TemporalEdge*> window(Id v, Time from, Time to) const {
+    const Row& row = m_rows[v];
+
+    std::size_t lo = std::upper_bound(row.max_end.begin(), row.max_end.end(), from) - row.max_end.begin();
+    std::size_t hi = std::lower_bound(row.edges.begin(), row.edges.end(), to,
+        [](const TemporalEdge& e, Time t) { return e.begin < t; }) - row.edges.begin();
+
+    const TemporalEdge* base = row.edges.data();
+    return lo < hi ? std::make_pair(base + lo, base + hi) : std::make_pair(base, base);
+  }
+
+  /// f(edge) for every edge of v valid at some point of [from, to)
+  template <class Function>
+  void for_each_edge(Id v, Time from, Time to, Function&& f) const {
+    auto range = window(v, from, to);
+    for (const TemporalEdge* e = range.first; e != range.second; ++e)
+      if (from < e->end) f(*e);
+  }
+
+  /// BFS over the edges valid somewhere in [from, to), timestamps are
+  /// not forced to increase along paths. f(v, hops) in visiting order.
+  void visit_bfs(Id source, Time from, Time to, const std::function<void (Id, std::size_t)>& f) const {
+    std::vector<std::size_t> hops(no_vertexes(), std::size_t(-1));
+    std::queue<Id> queue;
+
+    hops[source] = 0;
+    queue.push(source);
+
+    while (!queue.empty()) {
+      Id u = queue.front(); queue.pop();
+      f(u, hops[u]);
+
+      for_each_edge(u, from, to, [&](const TemporalEdge& e) {
+        if (hops[e.to] != std::size_t(-1)) return;
+        hops[e.to] = hops[u] + 1;
+        queue.push(e.to);
+      });
+    }
+  }
+
+  /// Earliest arrival time at every vertex leaving source at `from`,
+  /// following time respecting paths that arrive before `to`.
+  /// Dijkstra on arrival times, waiting at vertexes is allowed.
+  Arrivals earliest_arrival(Id source, Time from, Time to = NEVER) const {
+    using Entry = std::pair<Time, Id>;
+
+    Arrivals r;
+    r.arrival.assign(no_vertexes(), NEVER);
+    r.parent.assign(no_vertexes(), NONE);
+    r.departure = from;
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    r.arrival[source] = from;
+    heap.emplace(from, source);
+
+    while (!heap.empty()) {
+      Entry top = heap.top(); heap.pop();
+      Id u = top.second;
+      if (top.first != r.arrival[u]) continue;
+
+      for_each_edge(u, top.first, to, [&](const TemporalEdge& e) {
+        Time leave  = std::max(top.first, e.begin);
+        Time arrive = leave + e.duration;
+        if (!(arrive < to) || !(arrive < r.arrival[e.to])) return;
+
+        r.arrival[e.to] = arrive;
+        r.parent[e.to]  = u;
+        heap.emplace(arrive, e.to);
+      });
+    }
+
+    return r;
+  }
+
+  /// Time respecting path from source to target inside [from, to) with
+  /// the smallest arrival - departure. Sweeps the departure time: an
+  /// earliest arrival search from s gives arrival A, walking its path
+  /// back gives the latest departure L that still makes A, the next
+  /// sweep starts right after L. Every Pareto optimal journey is seen.
+  TemporalPath fastest_path(Id source, Id target, Time from, Time to = NEVER) const {
+    TemporalPath best;
+
+    for (Time s = from; s < to; ) {
+      Arrivals r = earliest_arrival(source, s, to);
+      if (r.arrival[target] == NEVER) break;
+
+      std::vector<Id> path = r.path_to(target);
+      Time leave = latest_departure(path, r.arrival[target]);
+
+      if (best.arrival == NEVER || r.arrival[target] - leave < best.arrival - best.departure) {
+        best.vertexes  = std::move(path);
+        best.departure = leave;
+        best.arrival   = r.arrival[target];
+      }
+
+      if (source == target || leave == NEVER) break;
+      s = next_after(leave);
+    }
+
+    return best;
+  }
+
+  /// Static graph of the edges valid somewhere in [from, to), parallel
+  /// edges keep the first tag. Ids are the same as here.
+  CSRGraph<VertexTag, EdgeTag> snapshot(Time from, Time to) const {
+    std::vector<typename CSRGraph<VertexTag, EdgeTag>::Arc> arcs;
+
+    for (Id u = 0; u < no_vertexes(); ++u)
+      for_each_edge(u, from, to, [&](const TemporalEdge& e) { arcs.emplace_back(u, e.to, e.tag); });
+
+    // Both directions are already here for UNDIRECTED graphs
+    return CSRGraph<VertexTag, EdgeTag>::from_arcs(m_labels, arcs, true);
+  }
+
+  void print(std::ostream& os = std::cout) const {
+    for (Id v = 0; v < no_vertexes(); ++v) {
+      os << "[[" << m_labels[v] << "]] => {";
+
+      for (std::size_t ii = 0; ii < m_rows[v].edges.size(); ++ii) {
+        const TemporalEdge& e = m_rows[v].edges[ii];
+        os << (ii ? ", " : "") << "(" << e.tag << " @[" << e.begin << ", " << e.end << ")+" << e.duration
+           << ", [" << m_labels[e.to] << "])";
+      }
+
+      os << "}" << std::endl;
+    }
+  }
+
+private:
+
+  void insert(Id u, const TemporalEdge& e) {
+    Row& row = m_rows[u];
+
+    auto it = std::upper_bound(row.edges.begin(), row.edges.end(), e.begin,
+        [](Time t, const TemporalEdge& x) { return t < x.begin; });
+    std::size_t pos = it - row.edges.begin();
+
+    row.edges.insert(it, e);
+    row.max_end.insert(row.max_end.begin() + pos, e.end);
+
+    for (std::size_t ii = pos; ii < row.edges.size(); ++ii)
+      row.max_end[ii] = ii ? std::max(row.max_end[ii - 1], row.edges[ii].end) : row.edges[ii].end;
+  }
+
+  /// Latest time the source can be left to follow path and still
+  /// reach its end at `arrival`
+  Time latest_departure(const std::vector<Id>& path, Time arrival) const {
+    Time t = arrival;
+
+    for (std::size_t ii = path.size() - 1; ii-- > 0; ) {
+      Time best = NEVER;
+
+      for (const TemporalEdge& e : m_rows[path[ii]].edges) {
+        if (e.to != path[ii + 1] || t - e.duration < e.begin) continue;
+
+        Time leave = std::min(previous(e.end), t - e.duration);
+        if (best == NEVER || best < leave) best = leave;
+      }
+
+      t = best;
+    }
+
+    return t;
+  }
+
+  static Time previous(Time t) {
+    if constexpr (std::is_integral<Time>::value) return t - 1;
+    else return std::nextafter(t, std::numeric_limits<Time>::lowest());
+  }
+
+  static Time next_after(Time t) {
+    if constexpr (std::is_integral<Time>::value) return t + 1;
+    else return std::nextafter(t, std::numeric_limits<Time>::max());
+  }
+
+};
+
+}
+
+#endif
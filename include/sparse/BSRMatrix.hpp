@@ -0,0 +1,314 @@
+#ifndef QAED_BSR_MATRIX_H
+#define QAED_BSR_MATRIX_H
+
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "SpMV.hpp"
+
+namespace qaed {
+
+namespace sparse {
+
+/// acc = sum over the blocks of a block row of block * x segment, the
+/// blocks being B x B column major. The specialisations below keep
+/// acc in one or two AVX registers and broadcast x one value at a
+/// time, so a block costs B loads of its columns and no gather.
+template <class Type, std::size_t B>
+struct BlockKernel {
+  template <class Index>
+  static void row(const Index* idx, const Type* val, std::size_t blocks, const Type* x, Type* acc) {
+    for (std::size_t i = 0; i < B; ++i) acc[i] = Type();
+
+    for (std::size_t k = 0; k < blocks; ++k, val += B * B) {
+      const Type* xb = x + std::size_t(idx[k]) * B;
+      for (std::size_t j = 0; j < B; ++j)
+        for (std::size_t i = 0; i < B; ++i) acc[i] += val[j * B + i] * xb[j];
+    }
+  }
+};
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+template <>
+struct BlockKernel<double, 4> {
+  template <class Index>
+  static void row(const Index* idx, const double* val, std::size_t blocks, const double* x, double* acc) {
+    __m256d a = _mm256_setzero_pd();
+
+    for (std::size_t k = 0; k < blocks; ++k, val += 16) {
+      const double* xb = x + std::size_t(idx[k]) * 4;
+      a = _mm256_fmadd_pd(_mm256_loadu_pd(val),      _mm256_broadcast_sd(xb),     a);
+      a = _mm256_fmadd_pd(_mm256_loadu_pd(val + 4),  _mm256_broadcast_sd(xb + 1), a);
+      a = _mm256_fmadd_pd(_mm256_loadu_pd(val + 8),  _mm256_broadcast_sd(xb + 2), a);
+      a = _mm256_fmadd_pd(_mm256_loadu_pd(val + 12), _mm256_broadcast_sd(xb + 3), a);
+    }
+
+    _mm256_storeu_pd(acc, a);
+  }
+};
+
+template <>
+struct BlockKernel<double, 8> {
+  template <class Index>
+  static void row(const Index* idx, const double* val, std::size_t blocks, const double* x, double* acc) {
+#if defined(__AVX512F__)
+    __m512d a = _mm512_setzero_pd();
+
+    for (std::size_t k = 0; k < blocks; ++k, val += 64) {
+      const double* xb = x + std::size_t(idx[k]) * 8;
+      for (std::size_t j = 0; j < 8; ++j)
+        a = _mm512_fmadd_pd(_mm512_loadu_pd(val + 8 * j), _mm512_set1_pd(xb[j]), a);
+    }
+
+    _mm512_storeu_pd(acc, a);
+#else
+    __m256d lo = _mm256_setzero_pd(), hi = _mm256_setzero_pd();
+
+    for (std::size_t k = 0; k < blocks; ++k, val += 64) {
+      const double* xb = x + std::size_t(idx[k]) * 8;
+      for (std::size_t j = 0; j < 8; ++j) {
+        __m256d xj = _mm256_broadcast_sd(xb + j);
+        lo = _mm256_fmadd_pd(_mm256_loadu_pd(val + 8 * j),     xj, lo);
+        hi = _mm256_fmadd_pd(_mm256_loadu_pd(val + 8 * j + 4), xj, hi);
+      }
+    }
+
+    _mm256_storeu_pd(acc, lo);
+    _mm256_storeu_pd(acc + 4, hi);
+#endif
+  }
+};
+
+template <>
+struct BlockKernel<float, 4> {
+  template <class Index>
+  static void row(const Index* idx, const float* val, std::size_t blocks, const float* x, float* acc) {
+    __m128 a = _mm_setzero_ps();
+
+    for (std::size_t k = 0; k < blocks; ++k, val += 16) {
+      const float* xb = x + std::size_t(idx[k]) * 4;
+      a = _mm_fmadd_ps(_mm_loadu_ps(val),      _mm_broadcast_ss(xb),     a);
+      a = _mm_fmadd_ps(_mm_loadu_ps(val + 4),  _mm_broadcast_ss(xb + 1), a);
+      a = _mm_fmadd_ps(_mm_loadu_ps(val + 8),  _mm_broadcast_ss(xb + 2), a);
+      a = _mm_fmadd_ps(_mm_loadu_ps(val + 12), _mm_broadcast_ss(xb + 3), a);
+    }
+
+    _mm_storeu_ps(acc, a);
+  }
+};
+
+template <>
+struct BlockKernel<float, 8> {
+  template <class Index>
+  static void row(const Index* idx, const float* val, std::size_t blocks, const float* x, float* acc) {
+    __m256 a = _mm256_setzero_ps();
+
+    for (std::size_t k = 0; k < blocks; ++k, val += 64) {
+      const float* xb = x + std::size_t(idx[k]) * 8;
+      for (std::size_t j = 0; j < 8; ++j)
+        a = _mm256_fmadd_ps(_mm256_loadu_ps(val + 8 * j), _mm256_broadcast_ss(xb + j), a);
+    }
+
+    _mm256_storeu_ps(acc, a);
+  }
+};
+
+#endif
+
+/// Distinct block columns of every block row of a CSR matrix, sorted,
+/// passed to f(block_row, first, last). Every thread marks the block
+/// columns it has seen in an array of no_cols / B entries.
+template <std::size_t B, class Type, class Index, class Function>
+void for_each_block_row(const CSRMatrix<Type, Index>& a, unsigned threads, Function&& f) {
+  const std::size_t brows = (a.no_rows() + B - 1) / B;
+  const std::size_t bcols = (a.no_cols() + B - 1) / B;
+
+  std::vector<typename CSRMatrix<Type, Index>::Offset> work(brows + 1);
+  for (std::size_t br = 0; br <= brows; ++br) work[br] = a.pointers()[std::min(br * B, a.no_rows())];
+
+  threads = threads_for(a.nnz(), threads);
+  std::vector<std::vector<std::size_t>> seen(threads);
+  std::vector<std::vector<Index>>       cols(threads);
+
+  parallel_for_balanced(work, threads, [&](std::size_t b, std::size_t e, unsigned tid) {
+    auto& mark = seen[tid];
+    auto& list = cols[tid];
+    mark.assign(bcols, ~std::size_t(0));
+
+    for (std::size_t br = b; br < e; ++br) {
+      list.clear();
+      for (std::size_t r = br * B; r < std::min((br + 1) * B, a.no_rows()); ++r)
+        for (const Index* c = a.idx_begin(r); c != a.idx_end(r); ++c)
+          if (mark[*c / B] != br) {
+            mark[*c / B] = br;
+            list.push_back(Index(*c / B));
+          }
+
+      std::sort(list.begin(), list.end());
+      f(br, list.data(), list.data() + list.size());
+    }
+  });
+}
+
+}
+
+/// Block sparse row matrix: the matrix is cut in B x B tiles and every
+/// tile holding a nonzero is stored dense (column major), one block
+/// column index per tile. Pays off when the nonzeros come in dense
+/// patches: one index for B * B values and SpMV in registers. The
+/// last block row and column are padded with zeros.
+template <class Type, std::size_t B, class Index = std::uint32_t>
+class BSRMatrix {
+  static_assert(B == 2 || B == 4 || B == 8, "BSR blocks are 2x2, 4x4 or 8x8");
+
+public:
+  using Size_t = std::size_t;
+  using Offset = std::size_t;
+
+  static constexpr std::size_t BLOCK = B;
+
+private:
+  Size_t              m_no_rows;
+  Size_t              m_no_cols;
+  Offset              m_nnz;
+  std::vector<Offset> m_ptr;   // by block row
+  std::vector<Index>  m_idx;   // block columns
+  std::vector<Type>   m_val;   // B * B per block
+
+public:
+  BSRMatrix() : m_no_rows(0), m_no_cols(0), m_nnz(0), m_ptr(1, 0) {}
+
+  /// Two passes over a: block columns of every block row, then the
+  /// values, both split between threads by block rows
+  explicit BSRMatrix(const CSRMatrix<Type, Index>& a, unsigned threads = default_threads()) :
+    m_no_rows(a.no_rows()), m_no_cols(a.no_cols()), m_nnz(a.nnz()), m_ptr(block_rows() + 1, 0) {
+
+    sparse::for_each_block_row<B>(a, threads, [&](std::size_t br, const Index* first, const Index* last) {
+      m_ptr[br + 1] = last - first;
+    });
+    std::partial_sum(m_ptr.begin(), m_ptr.end(), m_ptr.begin());
+
+    m_idx.resize(m_ptr.back());
+    m_val.assign(m_ptr.back() * B * B, Type());
+
+    sparse::for_each_block_row<B>(a, threads, [&](std::size_t br, const Index* first, const Index* last) {
+      std::copy(first, last, m_idx.begin() + m_ptr[br]);
+
+      for (std::size_t r = br * B; r < std::min((br + 1) * B, m_no_rows); ++r) {
+        const Index* at = m_idx.data() + m_ptr[br];
+        const Type*  v  = a.val_begin(r);
+
+        // Row entries and block columns are both sorted, walk together
+        for (const Index* c = a.idx_begin(r); c != a.idx_end(r); ++c, ++v) {
+          while (*at != *c / B) ++at;
+          m_val[(at - m_idx.data()) * B * B + (*c % B) * B + r % B] = *v;
+        }
+      }
+    });
+  }
+
+  Size_t no_rows() const { return m_no_rows; }
+  Size_t no_cols() const { return m_no_cols; }
+
+  Size_t block_rows() const { return (m_no_rows + B - 1) / B; }
+  Size_t block_cols() const { return (m_no_cols + B - 1) / B; }
+
+  /// Entries of the source matrix, stored blocks and stored values
+  Offset nnz()    const { return m_nnz; }
+  Offset blocks() const { return m_idx.size(); }
+  Offset stored() const { return m_val.size(); }
+
+  /// Share of the stored values that are real entries
+  double fill() const { return stored() ? double(m_nnz) / stored() : 1.0; }
+
+  const std::vector<Offset>& pointers() const { return m_ptr; }
+  const std::vector<Index>&  indices()  const { return m_idx; }
+  const std::vector<Type>&   values()   const { return m_val; }
+
+  Offset lane_size(Size_t br) const { return m_ptr[br + 1] - m_ptr[br]; }
+
+  const Index* idx_begin(Size_t br) const { return m_idx.data() + m_ptr[br]; }
+  const Type*  val_begin(Size_t br) const { return m_val.data() + m_ptr[br] * B * B; }
+
+  /// Value at (row, col), def outside the stored blocks
+  Type at(Size_t row, Size_t col, const Type& def = Type()) const {
+    if (row >= m_no_rows || col >= m_no_cols) return def;
+
+    const Index* first = idx_begin(row / B);
+    const Index* last  = first + lane_size(row / B);
+    const Index* it    = std::lower_bound(first, last, Index(col / B));
+
+    if (it == last || *it != col / B) return def;
+    return m_val[(it - m_idx.data()) * B * B + (col % B) * B + row % B];
+  }
+
+  /// Back to CSR, zeros inside the blocks are dropped (explicit zeros
+  /// of the source included)
+  CSRMatrix<Type, Index> to_csr() const {
+    std::vector<Offset> ptr(m_no_rows + 1, 0);
+    std::vector<Index>  idx;
+    std::vector<Type>   val;
+    idx.reserve(m_nnz);
+    val.reserve(m_nnz);
+
+    for (Size_t r = 0; r < m_no_rows; ++r) {
+      const Size_t br = r / B;
+      for (Offset k = m_ptr[br]; k < m_ptr[br + 1]; ++k)
+        for (Size_t j = 0; j < B; ++j) {
+          const Type& v = m_val[k * B * B + j * B + r % B];
+          if (v == Type()) continue;
+          idx.push_back(Index(m_idx[k] * B + j));
+          val.push_back(v);
+        }
+      ptr[r + 1] = idx.size();
+    }
+
+    return CSRMatrix<Type, Index>(m_no_rows, m_no_cols, std::move(ptr), std::move(idx), std::move(val));
+  }
+
+};
+
+/// y = alpha * A * x + beta * y, block rows split between threads by
+/// blocks. x is copied to a padded buffer when no_cols() isn't a
+/// multiple of B.
+template <class Type, std::size_t B, class Index>
+void spmv(const BSRMatrix<Type, B, Index>& a, const Type* x, Type* y,
+          Type alpha = Type(1), Type beta = Type(), unsigned threads = default_threads()) {
+  std::vector<Type> padded;
+  if (a.no_cols() % B) {
+    padded.assign(a.block_cols() * B, Type());
+    std::copy(x, x + a.no_cols(), padded.begin());
+    x = padded.data();
+  }
+
+  parallel_for_balanced(a.pointers(), sparse::threads_for(a.stored(), threads), [&](std::size_t b, std::size_t e, unsigned) {
+    alignas(64) Type acc[B];
+
+    for (std::size_t br = b; br < e; ++br) {
+      sparse::BlockKernel<Type, B>::row(a.idx_begin(br), a.val_begin(br), a.lane_size(br), x, acc);
+
+      const std::size_t rows = std::min(B, a.no_rows() - br * B);
+      Type* yb = y + br * B;
+      for (std::size_t i = 0; i < rows; ++i)
+        yb[i] = beta == Type() ? alpha * acc[i] : alpha * acc[i] + beta * yb[i];
+    }
+  });
+}
+
+template <class Type, std::size_t B, class Index>
+std::vector<Type> spmv(const BSRMatrix<Type, B, Index>& a, const std::vector<Type>& x,
+                       unsigned threads = default_threads()) {
+  if (x.size() != a.no_cols()) throw std::invalid_argument("Vector size doesn't match the matrix columns");
+
+  std::vector<Type> y(a.no_rows());
+  spmv(a, x.data(), y.data(), Type(1), Type(), threads);
+  return y;
+}
+
+}
+
+#endif
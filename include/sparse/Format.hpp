@@ -0,0 +1,125 @@
+#ifndef QAED_SPARSE_FORMAT_H
+#define QAED_SPARSE_FORMAT_H
+
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <ostream>
+#include <algorithm>
+#include <functional>
+
+#include "BSRMatrix.hpp"
+#include "SellMatrix.hpp"
+
+namespace qaed {
+
+enum SPARSE_FORMAT {
+  CSR,
+  BSR_2,
+  BSR_4,
+  BSR_8,
+  SELL
+};
+
+inline const char* format_name(SPARSE_FORMAT f) {
+  switch (f) {
+    case BSR_2: return "BSR 2x2";
+    case BSR_4: return "BSR 4x4";
+    case BSR_8: return "BSR 8x8";
+    case SELL:  return "SELL-8-256";
+    default:    return "CSR";
+  }
+}
+
+/// What choose_format saw in the pattern. Fills are the share of the
+/// stored values that are real entries, bytes the traffic of the
+/// matrix per entry in one SpMV.
+struct FormatAdvice {
+  SPARSE_FORMAT format    = CSR;
+  double        row_mean  = 0;     // entries per row
+  double        row_cv    = 0;     // their deviation over the mean
+  double        bsr_fill[3] = { 1, 1, 1 };   // 2x2, 4x4, 8x8
+  double        sell_fill = 1;
+  double        bytes[5]  = { 0, 0, 0, 0, 0 };   // by SPARSE_FORMAT
+
+  friend std::ostream& operator<<(std::ostream& os, const FormatAdvice& a) {
+    os << format_name(a.format) << " (rows " << a.row_mean << " +- " << a.row_cv * a.row_mean
+       << ", fill bsr " << a.bsr_fill[0] << ' ' << a.bsr_fill[1] << ' ' << a.bsr_fill[2]
+       << ", sell " << a.sell_fill << ", bytes/entry";
+    for (double b : a.bytes) os << ' ' << b;
+    return os << ')';
+  }
+};
+
+namespace sparse {
+
+/// Stored blocks of BSRMatrix<Type, B>(a), without building it
+template <std::size_t B, class Type, class Index>
+std::size_t count_blocks(const CSRMatrix<Type, Index>& a, unsigned threads) {
+  std::vector<std::size_t> blocks((a.no_rows() + B - 1) / B);
+  for_each_block_row<B>(a, threads, [&](std::size_t br, const Index* first, const Index* last) {
+    blocks[br] = last - first;
+  });
+  return std::accumulate(blocks.begin(), blocks.end(), std::size_t(0));
+}
+
+/// Stored slots of SellMatrix<Type, C>(a, sigma), without building it
+template <std::size_t C, class Type, class Index>
+std::size_t count_sell(const CSRMatrix<Type, Index>& a, std::size_t sigma) {
+  std::vector<std::size_t> len(a.no_rows());
+  for (std::size_t r = 0; r < a.no_rows(); ++r) len[r] = a.lane_size(r);
+
+  for (std::size_t w = 0; w < len.size(); w += sigma)
+    std::sort(len.begin() + w, len.begin() + std::min(w + sigma, len.size()), std::greater<std::size_t>());
+
+  std::size_t stored = 0;
+  for (std::size_t ch = 0; ch < len.size(); ch += C)
+    stored += C * *std::max_element(len.begin() + ch, len.begin() + std::min(ch + C, len.size()));
+  return stored;
+}
+
+}
+
+/// Picks the format with the least memory traffic per entry for SpMV,
+/// which is what bounds it. CSR moves a value and an index per entry,
+/// BSR an index per B x B block but also the zeros inside the blocks,
+/// SELL the same as CSR plus its padding. BSR has to beat CSR by 10%
+/// to pay for its conversion. SELL wins on short rows only: there CSR
+/// loses most to loop overhead, long rows vectorise in CSR already.
+template <class Type, class Index>
+FormatAdvice choose_format(const CSRMatrix<Type, Index>& a, unsigned threads = default_threads()) {
+  FormatAdvice advice;
+  if (!a.no_rows() || !a.nnz()) return advice;
+
+  advice.row_mean = double(a.nnz()) / a.no_rows();
+  double var = 0;
+  for (std::size_t r = 0; r < a.no_rows(); ++r) {
+    double d = a.lane_size(r) - advice.row_mean;
+    var += d * d;
+  }
+  advice.row_cv = std::sqrt(var / a.no_rows()) / advice.row_mean;
+
+  const double nnz = a.nnz(), value = sizeof(Type), index = sizeof(Index);
+  advice.bsr_fill[0] = nnz / (4  * sparse::count_blocks<2>(a, threads));
+  advice.bsr_fill[1] = nnz / (16 * sparse::count_blocks<4>(a, threads));
+  advice.bsr_fill[2] = nnz / (64 * sparse::count_blocks<8>(a, threads));
+  advice.sell_fill   = nnz / sparse::count_sell<8>(a, 256);
+
+  advice.bytes[CSR]   = value + index;
+  advice.bytes[BSR_2] = (value + index / 4)  / advice.bsr_fill[0];
+  advice.bytes[BSR_4] = (value + index / 16) / advice.bsr_fill[1];
+  advice.bytes[BSR_8] = (value + index / 64) / advice.bsr_fill[2];
+  advice.bytes[SELL]  = (value + index) / advice.sell_fill;
+
+  const SPARSE_FORMAT bsr = SPARSE_FORMAT(std::min_element(advice.bytes + BSR_2, advice.bytes + SELL) - advice.bytes);
+  if (advice.bytes[bsr] < 0.9 * advice.bytes[CSR])
+    advice.format = bsr;
+  else if (advice.row_mean < 8 && advice.sell_fill >= 0.8)
+    advice.format = SELL;
+
+  return advice;
+}
+
+}
+
+#endif
@@ -0,0 +1,528 @@
+#ifndef QAED_KRYLOV_H
+#define QAED_KRYLOV_H
+
+#include <array>
+#include <cmath>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+#include "SpMV.hpp"
+
+namespace qaed {
+
+struct SolverOptions {
+  double      tolerance      = 1e-8;   // on ||b - A x|| / ||b||
+  std::size_t max_iterations = 1000;
+  std::size_t restart        = 30;     // GMRES only
+  unsigned    threads        = default_threads();
+
+  /// Called after every iteration with the relative residual
+  std::function<void (std::size_t, double)> monitor;
+};
+
+struct SolverResult {
+  bool        converged  = false;
+  std::size_t iterations = 0;
+  double      residual   = 0;          // relative, as the method tracks it
+
+  friend std::ostream& operator<<(std::ostream& os, const SolverResult& r) {
+    return os << (r.converged ? "converged" : "not converged") << " after " << r.iterations
+              << " iterations, residual " << r.residual;
+  }
+};
+
+namespace sparse {
+
+/// Vector kernels of the solvers, split between threads like the
+/// products (below PARALLEL_NNZ entries everything stays in the
+/// calling thread). Each one makes a single pass over its vectors,
+/// the dots come out of the same pass as the update before them.
+
+template <class Function>
+void vector_for(std::size_t n, unsigned threads, Function&& f) {
+  parallel_for(0, n, threads_for(n, threads), [&](std::size_t b, std::size_t e, unsigned) { f(b, e); });
+}
+
+/// Sums the N partial sums f(b, e) returns for each chunk
+template <std::size_t N, class Type, class Function>
+std::array<Type, N> vector_sums(std::size_t n, unsigned threads, Function&& f) {
+  threads = threads_for(n, threads);
+
+  std::vector<std::array<Type, N>> part(threads);
+  parallel_for(0, n, threads, [&](std::size_t b, std::size_t e, unsigned tid) { part[tid] = f(b, e); });
+
+  std::array<Type, N> sum{};
+  for (auto& p : part)
+    for (std::size_t k = 0; k < N; ++k) sum[k] += p[k];
+  return sum;
+}
+
+template <class Type>
+Type dot(const Type* x, const Type* y, std::size_t n, unsigned threads) {
+  return vector_sums<1, Type>(n, threads, [&](std::size_t b, std::size_t e) {
+    Type s = Type();
+    for (std::size_t i = b; i < e; ++i) s += x[i] * y[i];
+    return std::array<Type, 1>{ s };
+  })[0];
+}
+
+/// r = b - A x
+template <class Matrix, class Type>
+void residual(const Matrix& a, const Type* b, const Type* x, Type* r, unsigned threads) {
+  std::copy(b, b + a.no_rows(), r);
+  spmv(a, x, r, Type(-1), Type(1), threads);
+}
+
+}
+
+/// z = r, no preconditioning
+class IdentityPreconditioner {
+public:
+  /// z = M^-1 r, returns r . z
+  template <class Type>
+  Type apply(const Type* r, Type* z, std::size_t n, unsigned threads) const {
+    return sparse::vector_sums<1, Type>(n, threads, [&](std::size_t b, std::size_t e) {
+      Type s = Type();
+      for (std::size_t i = b; i < e; ++i) { z[i] = r[i]; s += r[i] * r[i]; }
+      return std::array<Type, 1>{ s };
+    })[0];
+  }
+};
+
+/// z = D^-1 r with D the diagonal of A
+template <class Type>
+class JacobiPreconditioner {
+private:
+  std::vector<Type> m_inv_diag;
+
+public:
+  template <MAJOR major, class Index>
+  explicit JacobiPreconditioner(const CompressedMatrix<Type, major, Index>& a) : m_inv_diag(a.no_rows()) {
+    if (a.no_rows() != a.no_cols()) throw std::invalid_argument("Preconditioner needs a square matrix");
+
+    for (std::size_t i = 0; i < a.no_rows(); ++i) {
+      Type d = a.at(i, i);
+      if (d == Type()) throw std::runtime_error("Zero diagonal at row " + std::to_string(i));
+      m_inv_diag[i] = Type(1) / d;
+    }
+  }
+
+  Type apply(const Type* r, Type* z, std::size_t n, unsigned threads) const {
+    return sparse::vector_sums<1, Type>(n, threads, [&](std::size_t b, std::size_t e) {
+      Type s = Type();
+      for (std::size_t i = b; i < e; ++i) { z[i] = m_inv_diag[i] * r[i]; s += r[i] * z[i]; }
+      return std::array<Type, 1>{ s };
+    })[0];
+  }
+};
+
+/// Incomplete LU without fill in: L and U keep the pattern of A (L
+/// with a unit diagonal, both stored in one CSR copy). Every row
+/// needs a nonzero diagonal. The triangular solves are sequential,
+/// only the rest of the solver runs in parallel.
+template <class Type, class Index = std::uint32_t>
+class ILU0Preconditioner {
+public:
+  using Offset = typename CSRMatrix<Type, Index>::Offset;
+
+private:
+  CSRMatrix<Type, Index> m_lu;
+  std::vector<Offset>    m_diag;   // position of (i, i)
+
+public:
+  explicit ILU0Preconditioner(CSRMatrix<Type, Index> a) : m_lu(std::move(a)), m_diag(m_lu.no_rows()) {
+    if (m_lu.no_rows() != m_lu.no_cols()) throw std::invalid_argument("Preconditioner needs a square matrix");
+
+    const std::size_t n   = m_lu.no_rows();
+    const auto&       ptr = m_lu.pointers();
+    const auto&       idx = m_lu.indices();
+    auto&             val = m_lu.values();
+
+    for (std::size_t i = 0; i < n; ++i) {
+      Offset d = std::lower_bound(idx.begin() + ptr[i], idx.begin() + ptr[i + 1], Index(i)) - idx.begin();
+      if (d == ptr[i + 1] || idx[d] != i) throw std::runtime_error("Zero diagonal at row " + std::to_string(i));
+      m_diag[i] = d;
+    }
+
+    // IKJ order: row i is final once the rows above it are. The update
+    // of row i by row k walks both sorted rows past column k together
+    // and only touches columns row i already has.
+    for (std::size_t i = 0; i < n; ++i) {
+      for (Offset ik = ptr[i]; ik < m_diag[i]; ++ik) {
+        const std::size_t k = idx[ik];
+        val[ik] /= val[m_diag[k]];
+
+        Offset ij = ik + 1, kj = m_diag[k] + 1;
+        while (ij < ptr[i + 1] && kj < ptr[k + 1]) {
+          if      (idx[ij] < idx[kj]) ++ij;
+          else if (idx[kj] < idx[ij]) ++kj;
+          else    val[ij++] -= val[ik] * val[kj++];
+        }
+      }
+
+      if (val[m_diag[i]] == Type()) throw std::runtime_error("Zero pivot in ILU(0) at row " + std::to_string(i));
+    }
+  }
+
+  template <MAJOR major>
+  explicit ILU0Preconditioner(const CompressedMatrix<Type, major, Index>& a) : ILU0Preconditioner(a.to_csr()) {}
+
+  /// L U z = r, the dot comes out of the backward sweep
+  Type apply(const Type* r, Type* z, std::size_t n, unsigned) const {
+    const auto& ptr = m_lu.pointers();
+    const auto& idx = m_lu.indices();
+    const auto& val = m_lu.values();
+
+    for (std::size_t i = 0; i < n; ++i) {
+      Type s = r[i];
+      for (Offset k = ptr[i]; k < m_diag[i]; ++k) s -= val[k] * z[idx[k]];
+      z[i] = s;
+    }
+
+    Type rz = Type();
+    for (std::size_t i = n; i-- > 0;) {
+      Type s = z[i];
+      for (Offset k = m_diag[i] + 1; k < ptr[i + 1]; ++k) s -= val[k] * z[idx[k]];
+      z[i] = s / val[m_diag[i]];
+      rz += r[i] * z[i];
+    }
+    return rz;
+  }
+};
+
+/// Preconditioned conjugate gradient, A symmetric positive definite
+/// (and the preconditioner too). x holds the initial guess and gets
+/// the solution. Matrix is anything spmv takes (CSR, CSC, mapped).
+template <class Matrix, class Type, class Preconditioner = IdentityPreconditioner>
+SolverResult cg(const Matrix& a, const Type* b, Type* x, const Preconditioner& m = Preconditioner(),
+                const SolverOptions& options = SolverOptions()) {
+  static_assert(std::is_floating_point<Type>::value, "Solvers need a floating point type");
+  if (a.no_rows() != a.no_cols()) throw std::invalid_argument("Solvers need a square matrix");
+
+  const std::size_t n       = a.no_rows();
+  const unsigned    threads = options.threads;
+  SolverResult      result;
+
+  std::vector<Type> r(n), z(n), p(n), q(n);
+
+  const double bnorm = std::sqrt(double(sparse::dot(b, b, n, threads)));
+  if (bnorm == 0) {
+    std::fill(x, x + n, Type());
+    result.converged = true;
+    return result;
+  }
+
+  sparse::residual(a, b, x, r.data(), threads);
+  Type rz = m.apply(r.data(), z.data(), n, threads);
+  p = z;
+
+  result.residual  = std::sqrt(double(sparse::dot(r.data(), r.data(), n, threads))) / bnorm;
+  result.converged = result.residual <= options.tolerance;
+
+  while (!result.converged && result.iterations < options.max_iterations) {
+    spmv(a, p.data(), q.data(), Type(1), Type(), threads);
+
+    Type pq = sparse::dot(p.data(), q.data(), n, threads);
+    if (pq == Type()) break;
+    Type alpha = rz / pq;
+
+    // x += alpha p, r -= alpha q and r . r in one pass
+    Type rr = sparse::vector_sums<1, Type>(n, threads, [&](std::size_t b0, std::size_t e) {
+      Type s = Type();
+      for (std::size_t i = b0; i < e; ++i) {
+        x[i] += alpha * p[i];
+        r[i] -= alpha * q[i];
+        s    += r[i] * r[i];
+      }
+      return std::array<Type, 1>{ s };
+    })[0];
+
+    ++result.iterations;
+    result.residual  = std::sqrt(double(rr)) / bnorm;
+    result.converged = result.residual <= options.tolerance;
+    if (options.monitor) options.monitor(result.iterations, result.residual);
+    if (result.converged) break;
+
+    Type rz_next = m.apply(r.data(), z.data(), n, threads);
+    Type beta    = rz_next / rz;
+    rz = rz_next;
+
+    sparse::vector_for(n, threads, [&](std::size_t b0, std::size_t e) {
+      for (std::size_t i = b0; i < e; ++i) p[i] = z[i] + beta * p[i];
+    });
+  }
+
+  return result;
+}
+
+/// BiCGSTAB for general nonsymmetric matrices, right preconditioned so
+/// the tracked residual is the one of the original system. Convergence
+/// is checked on the true residual. Stops early (not converged) on a
+/// breakdown.
+template <class Matrix, class Type, class Preconditioner = IdentityPreconditioner>
+SolverResult bicgstab(const Matrix& a, const Type* b, Type* x, const Preconditioner& m = Preconditioner(),
+                      const SolverOptions& options = SolverOptions()) {
+  static_assert(std::is_floating_point<Type>::value, "Solvers need a floating point type");
+  if (a.no_rows() != a.no_cols()) throw std::invalid_argument("Solvers need a square matrix");
+
+  const std::size_t n       = a.no_rows();
+  const unsigned    threads = options.threads;
+  SolverResult      result;
+
+  std::vector<Type> r(n), r0(n), p(n, Type()), v(n, Type()), ph(n), s(n), sh(n), t(n);
+
+  const double bnorm = std::sqrt(double(sparse::dot(b, b, n, threads)));
+  if (bnorm == 0) {
+    std::fill(x, x + n, Type());
+    result.converged = true;
+    return result;
+  }
+
+  Type rho, alpha, omega, rho_r;   // rho_r = r0 . r
+
+  // Starts over from the true residual b - A x. The updated r drifts
+  // away from it, so when r says converged the true one decides, and
+  // the method restarts from it if it isn't there yet.
+  auto restart = [&]() {
+    sparse::residual(a, b, x, r.data(), threads);
+    r0 = r;
+    std::fill(p.begin(), p.end(), Type());
+    std::fill(v.begin(), v.end(), Type());
+
+    rho = alpha = omega = 1;
+    rho_r = sparse::dot(r.data(), r.data(), n, threads);
+
+    result.residual  = std::sqrt(double(rho_r)) / bnorm;
+    result.converged = result.residual <= options.tolerance;
+  };
+
+  restart();
+
+  while (!result.converged && result.iterations < options.max_iterations) {
+    Type rho_next = rho_r;
+    if (rho_next == Type()) break;
+
+    Type beta = (rho_next / rho) * (alpha / omega);
+    rho = rho_next;
+
+    sparse::vector_for(n, threads, [&](std::size_t b0, std::size_t e) {
+      for (std::size_t i = b0; i < e; ++i) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    });
+
+    m.apply(p.data(), ph.data(), n, threads);
+    spmv(a, ph.data(), v.data(), Type(1), Type(), threads);
+
+    Type r0v = sparse::dot(r0.data(), v.data(), n, threads);
+    if (r0v == Type()) break;
+    alpha = rho / r0v;
+
+    // s = r - alpha v and s . s
+    Type ss = sparse::vector_sums<1, Type>(n, threads, [&](std::size_t b0, std::size_t e) {
+      Type sum = Type();
+      for (std::size_t i = b0; i < e; ++i) { s[i] = r[i] - alpha * v[i]; sum += s[i] * s[i]; }
+      return std::array<Type, 1>{ sum };
+    })[0];
+
+    ++result.iterations;
+
+    if (std::sqrt(double(ss)) / bnorm <= options.tolerance) {
+      sparse::vector_for(n, threads, [&](std::size_t b0, std::size_t e) {
+        for (std::size_t i = b0; i < e; ++i) x[i] += alpha * ph[i];
+      });
+
+      restart();
+      if (options.monitor) options.monitor(result.iterations, result.residual);
+      continue;
+    }
+
+    m.apply(s.data(), sh.data(), n, threads);
+    spmv(a, sh.data(), t.data(), Type(1), Type(), threads);
+
+    auto ts_tt = sparse::vector_sums<2, Type>(n, threads, [&](std::size_t b0, std::size_t e) {
+      std::array<Type, 2> sum{};
+      for (std::size_t i = b0; i < e; ++i) { sum[0] += t[i] * s[i]; sum[1] += t[i] * t[i]; }
+      return sum;
+    });
+    if (ts_tt[1] == Type()) break;
+    omega = ts_tt[0] / ts_tt[1];
+
+    // x += alpha ph + omega sh, r = s - omega t, r . r and r0 . r
+    auto rr_r0r = sparse::vector_sums<2, Type>(n, threads, [&](std::size_t b0, std::size_t e) {
+      std::array<Type, 2> sum{};
+      for (std::size_t i = b0; i < e; ++i) {
+        x[i] += alpha * ph[i] + omega * sh[i];
+        r[i]  = s[i] - omega * t[i];
+        sum[0] += r[i] * r[i];
+        sum[1] += r0[i] * r[i];
+      }
+      return sum;
+    });
+    rho_r = rr_r0r[1];
+
+    result.residual  = std::sqrt(double(rr_r0r[0])) / bnorm;
+    if (result.residual <= options.tolerance) restart();
+    if (options.monitor) options.monitor(result.iterations, result.residual);
+
+    if (omega == Type() && !result.converged) break;
+  }
+
+  return result;
+}
+
+/// Restarted GMRES(options.restart), right preconditioned. Arnoldi
+/// uses modified Gram-Schmidt, each projection pass also computes the
+/// dot for the next basis vector. Givens rotations give the residual
+/// at every step without forming x, x is updated at each restart.
+template <class Matrix, class Type, class Preconditioner = IdentityPreconditioner>
+SolverResult gmres(const Matrix& a, const Type* b, Type* x, const Preconditioner& m = Preconditioner(),
+                   const SolverOptions& options = SolverOptions()) {
+  static_assert(std::is_floating_point<Type>::value, "Solvers need a floating point type");
+  if (a.no_rows() != a.no_cols()) throw std::invalid_argument("Solvers need a square matrix");
+
+  const std::size_t n       = a.no_rows();
+  const std::size_t dim     = std::max<std::size_t>(1, options.restart);
+  const unsigned    threads = options.threads;
+  SolverResult      result;
+
+  const double bnorm = std::sqrt(double(sparse::dot(b, b, n, threads)));
+  if (bnorm == 0) {
+    std::fill(x, x + n, Type());
+    result.converged = true;
+    return result;
+  }
+
+  std::vector<Type> basis((dim + 1) * n), w(n), z(n);
+  std::vector<Type> h((dim + 1) * dim), cs(dim), sn(dim), g(dim + 1), y(dim);
+
+  auto V = [&](std::size_t j) { return basis.data() + j * n; };
+  auto H = [&](std::size_t i, std::size_t j) -> Type& { return h[i * dim + j]; };
+
+  while (true) {
+    Type* v0 = V(0);
+    sparse::residual(a, b, x, v0, threads);
+
+    Type beta = std::sqrt(sparse::dot(v0, v0, n, threads));
+    result.residual  = double(beta) / bnorm;
+    result.converged = result.residual <= options.tolerance;
+    if (result.converged || result.iterations >= options.max_iterations) break;
+
+    sparse::vector_for(n, threads, [&](std::size_t b0, std::size_t e) {
+      for (std::size_t i = b0; i < e; ++i) v0[i] /= beta;
+    });
+    std::fill(g.begin(), g.end(), Type());
+    g[0] = beta;
+
+    std::size_t k = 0;
+    bool done = false;
+
+    while (k < dim && !done) {
+      const std::size_t j = k++;
+
+      m.apply(V(j), z.data(), n, threads);
+      spmv(a, z.data(), w.data(), Type(1), Type(), threads);
+
+      // w -= H(i, j) V(i) for i = 0 .. j, each pass also gives the
+      // next projection (or |w|^2 after the last one)
+      Type proj = sparse::dot(w.data(), V(0), n, threads);
+      for (std::size_t i = 0; i <= j; ++i) {
+        const Type  hij  = H(i, j) = proj;
+        const Type* vi   = V(i);
+        const Type* next = i < j ? V(i + 1) : w.data();
+
+        proj = sparse::vector_sums<1, Type>(n, threads, [&](std::size_t b0, std::size_t e) {
+          Type s = Type();
+          for (std::size_t l = b0; l < e; ++l) { w[l] -= hij * vi[l]; s += w[l] * next[l]; }
+          return std::array<Type, 1>{ s };
+        })[0];
+      }
+
+      Type wnorm = std::sqrt(std::max(proj, Type()));
+      H(j + 1, j) = wnorm;
+
+      for (std::size_t i = 0; i < j; ++i) {
+        Type t      =  cs[i] * H(i, j) + sn[i] * H(i + 1, j);
+        H(i + 1, j) = -sn[i] * H(i, j) + cs[i] * H(i + 1, j);
+        H(i, j)     = t;
+      }
+
+      Type rad = std::hypot(H(j, j), H(j + 1, j));
+      cs[j] = rad == Type() ? Type(1) : H(j, j) / rad;
+      sn[j] = rad == Type() ? Type()  : H(j + 1, j) / rad;
+      H(j, j)     = rad;
+      H(j + 1, j) = Type();
+      g[j + 1]    = -sn[j] * g[j];
+      g[j]        =  cs[j] * g[j];
+
+      ++result.iterations;
+      result.residual  = std::abs(double(g[j + 1])) / bnorm;
+      result.converged = result.residual <= options.tolerance;
+      if (options.monitor) options.monitor(result.iterations, result.residual);
+
+      done = result.converged || wnorm == Type() || result.iterations >= options.max_iterations;
+
+      if (!done) {
+        Type* vn = V(j + 1);
+        sparse::vector_for(n, threads, [&](std::size_t b0, std::size_t e) {
+          for (std::size_t l = b0; l < e; ++l) vn[l] = w[l] / wnorm;
+        });
+      }
+    }
+
+    // H y = g on the first k columns, then x += M^-1 (V y)
+    for (std::size_t i = k; i-- > 0;) {
+      Type s = g[i];
+      for (std::size_t l = i + 1; l < k; ++l) s -= H(i, l) * y[l];
+      y[i] = H(i, i) == Type() ? Type() : s / H(i, i);
+    }
+
+    sparse::vector_for(n, threads, [&](std::size_t b0, std::size_t e) {
+      for (std::size_t l = b0; l < e; ++l) {
+        Type s = Type();
+        for (std::size_t i = 0; i < k; ++i) s += y[i] * basis[i * n + l];
+        w[l] = s;
+      }
+    });
+    m.apply(w.data(), z.data(), n, threads);
+    sparse::vector_for(n, threads, [&](std::size_t b0, std::size_t e) {
+      for (std::size_t l = b0; l < e; ++l) x[l] += z[l];
+    });
+
+    if (result.converged || result.iterations >= options.max_iterations) break;
+  }
+
+  return result;
+}
+
+/// std::vector versions, x is the initial guess (resized with zeros
+/// if needed) and gets the solution
+template <class Matrix, class Type, class Preconditioner = IdentityPreconditioner>
+SolverResult cg(const Matrix& a, const std::vector<Type>& b, std::vector<Type>& x,
+                const Preconditioner& m = Preconditioner(), const SolverOptions& options = SolverOptions()) {
+  if (b.size() != a.no_rows()) throw std::invalid_argument("Vector size doesn't match the matrix rows");
+  x.resize(a.no_cols(), Type());
+  return cg(a, b.data(), x.data(), m, options);
+}
+
+template <class Matrix, class Type, class Preconditioner = IdentityPreconditioner>
+SolverResult bicgstab(const Matrix& a, const std::vector<Type>& b, std::vector<Type>& x,
+                      const Preconditioner& m = Preconditioner(), const SolverOptions& options = SolverOptions()) {
+  if (b.size() != a.no_rows()) throw std::invalid_argument("Vector size doesn't match the matrix rows");
+  x.resize(a.no_cols(), Type());
+  return bicgstab(a, b.data(), x.data(), m, options);
+}
+
+template <class Matrix, class Type, class Preconditioner = IdentityPreconditioner>
+SolverResult gmres(const Matrix& a, const std::vector<Type>& b, std::vector<Type>& x,
+                   const Preconditioner& m = Preconditioner(), const SolverOptions& options = SolverOptions()) {
+  if (b.size() != a.no_rows()) throw std::invalid_argument("Vector size doesn't match the matrix rows");
+  x.resize(a.no_cols(), Type());
+  return gmres(a, b.data(), x.data(), m, options);
+}
+
+}
+
+#endif
@@ -0,0 +1,293 @@
+#ifndef QAED_MAPPED_MATRIX_H
+#define QAED_MAPPED_MATRIX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SpMV.hpp"
+
+namespace qaed {
+
+namespace mapped {
+
+/// File layout: this header, then the row pointers (Offset), the column
+/// indices (Index) and the values (Type), each array starting at a
+/// multiple of ALIGN. Everything in the byte order of the writer.
+struct Header {
+  char          magic[8];      // "QAEDCSR"
+  std::uint32_t version;
+  std::uint8_t  byte_order;    // 1 little, 2 big endian
+  std::uint8_t  offset_size;
+  std::uint8_t  index_size;
+  std::uint8_t  value_size;
+  std::uint64_t rows;
+  std::uint64_t cols;
+  std::uint64_t nnz;
+  std::uint64_t ptr_at;
+  std::uint64_t idx_at;
+  std::uint64_t val_at;
+};
+
+constexpr char          MAGIC[8] = "QAEDCSR";
+constexpr std::uint32_t VERSION  = 1;
+constexpr std::uint64_t ALIGN    = 64;
+
+inline std::uint8_t byte_order() {
+  const std::uint16_t probe = 1;
+  return *reinterpret_cast<const unsigned char*>(&probe) == 1 ? 1 : 2;
+}
+
+inline std::uint64_t aligned(std::uint64_t at) { return (at + ALIGN - 1) / ALIGN * ALIGN; }
+
+}
+
+/// Writes a CSR matrix in the layout MappedMatrix maps
+template <class Type, class Index>
+void write_mapped(const CSRMatrix<Type, Index>& a, const std::string& filename) {
+  using Offset = typename CSRMatrix<Type, Index>::Offset;
+
+  mapped::Header h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, mapped::MAGIC, sizeof(h.magic));
+  h.version     = mapped::VERSION;
+  h.byte_order  = mapped::byte_order();
+  h.offset_size = sizeof(Offset);
+  h.index_size  = sizeof(Index);
+  h.value_size  = sizeof(Type);
+  h.rows        = a.no_rows();
+  h.cols        = a.no_cols();
+  h.nnz         = a.nnz();
+  h.ptr_at      = mapped::aligned(sizeof(h));
+  h.idx_at      = mapped::aligned(h.ptr_at + (h.rows + 1) * sizeof(Offset));
+  h.val_at      = mapped::aligned(h.idx_at + h.nnz * sizeof(Index));
+
+  std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out) throw std::runtime_error("Cannot open " + filename);
+
+  std::uint64_t at = 0;
+  auto put = [&](const void* data, std::uint64_t bytes, std::uint64_t where) {
+    static const char zeros[mapped::ALIGN] = {};
+    out.write(zeros, where - at);
+    out.write(static_cast<const char*>(data), bytes);
+    at = where + bytes;
+  };
+
+  put(&h, sizeof(h), 0);
+  put(a.pointers().data(), (h.rows + 1) * sizeof(Offset), h.ptr_at);
+  put(a.indices().data(), h.nnz * sizeof(Index), h.idx_at);
+  put(a.values().data(), h.nnz * sizeof(Type), h.val_at);
+
+  if (!out) throw std::runtime_error("Cannot write " + filename);
+}
+
+/// Read only CSR matrix living in a file written by write_mapped. The
+/// arrays are used where mmap puts them, nothing is deserialised, so
+/// every process mapping the same file shares one page cache copy.
+/// Same lane accessors as CSRMatrix, so the SpMV kernels work on it.
+/// The file has to come from a machine with the same byte order.
+template <class Type, class Index = std::uint32_t>
+class MappedMatrix {
+public:
+  using Size_t = std::size_t;
+  using Offset = std::size_t;
+
+private:
+  int               m_fd;
+  void*             m_base;
+  std::size_t       m_bytes;
+  mapped::Header    m_header;
+  const Offset*     m_ptr;
+  const Index*      m_idx;
+  const Type*       m_val;
+
+public:
+  explicit MappedMatrix(const std::string& filename) : m_fd(-1), m_base(MAP_FAILED), m_bytes(0) {
+    m_fd = ::open(filename.c_str(), O_RDONLY);
+    if (m_fd < 0) throw std::runtime_error("Cannot open " + filename);
+
+    try {
+      struct stat st;
+      if (::fstat(m_fd, &st) != 0) throw std::runtime_error("Cannot stat " + filename);
+
+      m_bytes = st.st_size;
+      if (m_bytes < sizeof(mapped::Header)) throw std::runtime_error(filename + " is not a mapped matrix");
+
+      m_base = ::mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, m_fd, 0);
+      if (m_base == MAP_FAILED) throw std::runtime_error("Cannot map " + filename);
+
+      std::memcpy(&m_header, m_base, sizeof(m_header));
+      check(filename);
+    } catch (...) {
+      release();
+      throw;
+    }
+
+    const char* base = static_cast<const char*>(m_base);
+    m_ptr = reinterpret_cast<const Offset*>(base + m_header.ptr_at);
+    m_idx = reinterpret_cast<const Index*>(base + m_header.idx_at);
+    m_val = reinterpret_cast<const Type*>(base + m_header.val_at);
+  }
+
+  MappedMatrix(const MappedMatrix&) = delete;
+  MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+  MappedMatrix(MappedMatrix&& m) noexcept :
+    m_fd(m.m_fd), m_base(m.m_base), m_bytes(m.m_bytes), m_header(m.m_header),
+    m_ptr(m.m_ptr), m_idx(m.m_idx), m_val(m.m_val) {
+    m.m_fd   = -1;
+    m.m_base = MAP_FAILED;
+  }
+
+ ~MappedMatrix() { release(); }
+
+  Size_t no_rows() const { return m_header.rows; }
+  Size_t no_cols() const { return m_header.cols; }
+  Offset nnz()     const { return m_header.nnz; }
+
+  Size_t outer_size() const { return no_rows(); }
+  Size_t inner_size() const { return no_cols(); }
+
+  /// Raw arrays inside the mapping
+  const Offset* pointers() const { return m_ptr; }
+  const Index*  indices()  const { return m_idx; }
+  const Type*   values()   const { return m_val; }
+
+  Offset lane_size(Size_t r) const { return m_ptr[r + 1] - m_ptr[r]; }
+
+  const Index* idx_begin(Size_t r) const { return m_idx + m_ptr[r]; }
+  const Index* idx_end(Size_t r)   const { return m_idx + m_ptr[r + 1]; }
+  const Type*  val_begin(Size_t r) const { return m_val + m_ptr[r]; }
+
+  /// Stored value at (row, col) or nullptr, binary search in the row
+  const Type* find(Size_t row, Size_t col) const {
+    if (row >= no_rows() || col >= no_cols()) return nullptr;
+
+    const Index* it = std::lower_bound(idx_begin(row), idx_end(row), Index(col));
+    if (it == idx_end(row) || *it != col) return nullptr;
+    return m_val + (it - m_idx);
+  }
+
+  const Type& get(Size_t row, Size_t col) const {
+    if (row >= no_rows()) throw std::out_of_range("rows out of range");
+    if (col >= no_cols()) throw std::out_of_range("cols out of range");
+
+    const Type* v = find(row, col);
+    if (!v) throw std::runtime_error("Cannot find element at pos " + std::to_string(row) + ", " + std::to_string(col));
+    return *v;
+  }
+
+  Type at(Size_t row, Size_t col, const Type& def = Type()) const {
+    const Type* v = find(row, col);
+    return v ? *v : def;
+  }
+
+  /// f(col, value) by increasing col
+  template <class Function>
+  void for_each_in_row(Size_t row, Function&& f) const {
+    if (row >= no_rows()) throw std::out_of_range("rows out of range");
+    for (Offset k = m_ptr[row]; k < m_ptr[row + 1]; ++k)
+      f(Size_t(m_idx[k]), m_val[k]);
+  }
+
+  /// f(row, col, value) for every stored entry
+  template <class Function>
+  void for_each(Function&& f) const {
+    for (Size_t r = 0; r < no_rows(); ++r)
+      for (Offset k = m_ptr[r]; k < m_ptr[r + 1]; ++k)
+        f(r, Size_t(m_idx[k]), m_val[k]);
+  }
+
+  /// Asks the kernel to start reading the whole file in
+  void prefetch() const { ::madvise(m_base, m_bytes, MADV_WILLNEED); }
+
+  /// Private, modifiable copy
+  CSRMatrix<Type, Index> to_csr() const {
+    return CSRMatrix<Type, Index>(no_rows(), no_cols(), std::vector<Offset>(m_ptr, m_ptr + no_rows() + 1),
+                                  std::vector<Index>(m_idx, m_idx + nnz()), std::vector<Type>(m_val, m_val + nnz()));
+  }
+
+private:
+
+  void release() {
+    if (m_base != MAP_FAILED) ::munmap(m_base, m_bytes);
+    if (m_fd >= 0) ::close(m_fd);
+    m_base = MAP_FAILED;
+    m_fd   = -1;
+  }
+
+  /// The header is trusted for nothing, every array has to fit in the file
+  void check(const std::string& filename) const {
+    const mapped::Header& h = m_header;
+
+    if (std::memcmp(h.magic, mapped::MAGIC, sizeof(h.magic)) != 0)
+      throw std::runtime_error(filename + " is not a mapped matrix");
+    if (h.version != mapped::VERSION)
+      throw std::runtime_error("Unsupported mapped matrix version in " + filename);
+    if (h.byte_order != mapped::byte_order())
+      throw std::runtime_error(filename + " was written with another byte order");
+    if (h.offset_size != sizeof(Offset) || h.index_size != sizeof(Index) || h.value_size != sizeof(Type))
+      throw std::runtime_error(filename + " holds other offset, index or value types");
+
+    auto fits = [&](std::uint64_t at, std::uint64_t count, std::uint64_t size) {
+      return at % mapped::ALIGN == 0 && at <= m_bytes && count <= (m_bytes - at) / size;
+    };
+
+    if (h.rows >= m_bytes || !fits(h.ptr_at, h.rows + 1, sizeof(Offset)) || !fits(h.idx_at, h.nnz, sizeof(Index)) ||
+        !fits(h.val_at, h.nnz, sizeof(Type)))
+      throw std::runtime_error("Truncated mapped matrix " + filename);
+
+    // Row pointers in O(rows), the kernels index the arrays with them.
+    // Column indices would cost a pass over the whole file and are not
+    // checked.
+    const Offset* ptr = reinterpret_cast<const Offset*>(static_cast<const char*>(m_base) + h.ptr_at);
+    if (ptr[0] != 0 || ptr[h.rows] != h.nnz)
+      throw std::runtime_error("Inconsistent row pointers in " + filename);
+    for (std::uint64_t r = 0; r < h.rows; ++r)
+      if (ptr[r] > ptr[r + 1] || ptr[r + 1] > h.nnz)
+        throw std::runtime_error("Inconsistent row pointers in " + filename);
+  }
+
+};
+
+/// SpMV on the mapped arrays, same semantics as for CSRMatrix
+template <class Type, class Index>
+void spmv(const MappedMatrix<Type, Index>& a, const Type* x, Type* y,
+          Type alpha = Type(1), Type beta = Type(), unsigned threads = default_threads()) {
+  sparse::gather(a, x, y, alpha, beta, threads);
+}
+
+template <class Type, class Index>
+std::vector<Type> spmv(const MappedMatrix<Type, Index>& a, const std::vector<Type>& x,
+                       unsigned threads = default_threads()) {
+  if (x.size() != a.no_cols()) throw std::invalid_argument("Vector size doesn't match the matrix columns");
+
+  std::vector<Type> y(a.no_rows());
+  spmv(a, x.data(), y.data(), Type(1), Type(), threads);
+  return y;
+}
+
+template <class Type, class Index>
+void spmv_transposed(const MappedMatrix<Type, Index>& a, const Type* x, Type* y,
+                     Type alpha = Type(1), Type beta = Type(), unsigned threads = default_threads()) {
+  sparse::scatter(a, x, y, alpha, beta, threads);
+}
+
+template <class Type, class Index>
+void spmm(const MappedMatrix<Type, Index>& a, const Type* x, std::size_t k, Type* y,
+          Type alpha = Type(1), Type beta = Type(), unsigned threads = default_threads()) {
+  sparse::gather_block(a, x, k, y, alpha, beta, threads);
+}
+
+}
+
+#endif
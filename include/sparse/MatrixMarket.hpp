@@ -0,0 +1,208 @@
+#ifndef QAED_MATRIX_MARKET_H
+#define QAED_MATRIX_MARKET_H
+
+#include <string>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <charconv>
+#include <stdexcept>
+#include <type_traits>
+
+#include "TripletBuilder.hpp"
+#include "../tools/StreamWriter.hpp"
+
+namespace qaed {
+
+namespace mm {
+
+/// Reads whitespace separated numbers out of one line
+class LineScanner {
+private:
+  const char* m_at;
+  const char* m_end;
+
+public:
+  explicit LineScanner(const std::string& line) : m_at(line.data()), m_end(line.data() + line.size()) {}
+
+  template <class T>
+  bool next(T& value) {
+    while (m_at < m_end && std::isspace(static_cast<unsigned char>(*m_at))) ++m_at;
+    if (m_at < m_end && *m_at == '+') ++m_at;   // from_chars doesn't take a plus sign
+
+    auto r = std::from_chars(m_at, m_end, value);
+    if (r.ec != std::errc()) return false;
+    m_at = r.ptr;
+    return true;
+  }
+};
+
+inline std::string lower(std::string s) {
+  for (char& c : s) c = std::tolower(static_cast<unsigned char>(c));
+  return s;
+}
+
+/// Skips comments and blank lines, false at the end of the stream
+inline bool data_line(std::istream& in, std::string& line, std::size_t& line_no) {
+  while (std::getline(in, line)) {
+    ++line_no;
+
+    std::size_t first = line.find_first_not_of(" \t\r");
+    if (first != std::string::npos && line[first] != '%') return true;
+  }
+  return false;
+}
+
+}
+
+/// Triplets of a Matrix Market file, read line by line. Handles the
+/// coordinate and array formats, real, integer and pattern fields
+/// (pattern entries get Type(1)) and general, symmetric and
+/// skew-symmetric matrices, the mirrored half is added explicitly.
+/// Complex and hermitian matrices are refused.
+template <class Type, class Index = std::uint32_t>
+TripletBuilder<Type, Index> read_matrix_market_triplets(std::istream& in) {
+  std::string line;
+  std::size_t line_no = 1;
+
+  if (!std::getline(in, line)) throw std::runtime_error("Empty Matrix Market file");
+
+  std::istringstream banner(line);
+  std::string magic, object, format, field, symmetry;
+  banner >> magic >> object >> format >> field >> symmetry;
+
+  object = mm::lower(object); format = mm::lower(format); field = mm::lower(field); symmetry = mm::lower(symmetry);
+
+  if (magic != "%%MatrixMarket" || object != "matrix")
+    throw std::runtime_error("Not a Matrix Market matrix file");
+  if (format != "coordinate" && format != "array")
+    throw std::runtime_error("Unknown Matrix Market format " + format);
+  if (field != "real" && field != "double" && field != "integer" && field != "pattern")
+    throw std::runtime_error("Unsupported Matrix Market field " + field);
+  if (symmetry != "general" && symmetry != "symmetric" && symmetry != "skew-symmetric")
+    throw std::runtime_error("Unsupported Matrix Market symmetry " + symmetry);
+
+  const bool coordinate = format == "coordinate";
+  const bool pattern    = field == "pattern";
+  const bool integer    = field == "integer";
+  const bool mirror     = symmetry != "general";
+  const bool skew       = symmetry == "skew-symmetric";
+
+  if (pattern && !coordinate) throw std::runtime_error("Matrix Market pattern needs the coordinate format");
+
+  auto bad = [&](const char* what) {
+    return std::runtime_error(std::string(what) + " in Matrix Market file at line " + std::to_string(line_no));
+  };
+
+  std::size_t rows = 0, cols = 0, entries = 0;
+  if (!mm::data_line(in, line, line_no)) throw std::runtime_error("Missing Matrix Market size line");
+
+  mm::LineScanner size(line);
+  if (!size.next(rows) || !size.next(cols) || (coordinate && !size.next(entries))) throw bad("Bad size line");
+  if (mirror && rows != cols) throw bad("Non square symmetric matrix");
+
+  if (!coordinate) entries = !mirror ? rows * cols : skew ? rows * (rows - 1) / 2 : rows * (rows + 1) / 2;
+
+  TripletBuilder<Type, Index> triplets(rows, cols);
+  triplets.reserve(mirror ? 2 * entries : entries);
+
+  auto value = [&](mm::LineScanner& s, Type& v) {
+    if (pattern) { v = Type(1); return true; }
+    if (integer) { long long x; if (!s.next(x)) return false; v = Type(x); return true; }
+    double x;
+    if (!s.next(x)) return false;
+    v = Type(x);
+    return true;
+  };
+
+  auto put = [&](std::size_t r, std::size_t c, const Type& v) {
+    triplets.add(r, c, v);
+    if (mirror && r != c) triplets.add(c, r, skew ? Type(-v) : v);
+  };
+
+  // Array files list the columns top to bottom, symmetric ones only
+  // the lower triangle. Zeros are not stored.
+  std::size_t r = 0, c = 0;
+  if (!coordinate && skew) r = 1;
+
+  for (std::size_t k = 0; k < entries; ++k) {
+    if (!mm::data_line(in, line, line_no)) throw std::runtime_error("Truncated Matrix Market file");
+    mm::LineScanner s(line);
+    Type v;
+
+    if (coordinate) {
+      std::size_t i, j;
+      if (!s.next(i) || !s.next(j) || !value(s, v)) throw bad("Bad entry");
+      if (i == 0 || j == 0 || i > rows || j > cols)  throw bad("Entry out of range");
+      if (mirror && j > i)                           throw bad("Entry above the diagonal of a symmetric matrix");
+      put(i - 1, j - 1, v);
+      continue;
+    }
+
+    if (!value(s, v)) throw bad("Bad entry");
+    if (v != Type()) put(r, c, v);
+
+    if (++r == rows) {
+      ++c;
+      r = mirror ? c + (skew ? 1 : 0) : 0;
+    }
+  }
+
+  return triplets;
+}
+
+/// CSR matrix of a Matrix Market stream, repeated coordinates are
+/// merged with combine
+template <class Type, class Index = std::uint32_t>
+CSRMatrix<Type, Index> read_matrix_market(std::istream& in, COMBINE combine = SUM,
+                                          unsigned threads = default_threads()) {
+  return read_matrix_market_triplets<Type, Index>(in).to_csr(combine, threads);
+}
+
+template <class Type, class Index = std::uint32_t>
+CSRMatrix<Type, Index> read_matrix_market(const std::string& filename, COMBINE combine = SUM,
+                                          unsigned threads = default_threads()) {
+  std::ifstream in(filename);
+  if (!in) throw std::runtime_error("Cannot open " + filename);
+  return read_matrix_market<Type, Index>(in, combine, threads);
+}
+
+/// Coordinate Matrix Market, integer field for integral types and real
+/// otherwise. symmetric = true writes only the lower triangle and tags
+/// the file symmetric, the matrix is taken to be symmetric as it is.
+template <class Type, MAJOR major, class Index>
+void write_matrix_market(const CompressedMatrix<Type, major, Index>& a, std::ostream& os, bool symmetric = false) {
+  if (symmetric && a.no_rows() != a.no_cols()) throw std::invalid_argument("Non square matrix can't be symmetric");
+
+  std::size_t entries = a.nnz();
+  if (symmetric) {
+    entries = 0;
+    a.for_each([&](std::size_t r, std::size_t c, const Type&) { entries += r >= c; });
+  }
+
+  StreamWriter out(os);
+  out.put("%%MatrixMarket matrix coordinate ")
+     .put(std::is_integral<Type>::value ? "integer" : "real")
+     .put(symmetric ? " symmetric\n" : " general\n");
+  out.value(a.no_rows()).put(' ').value(a.no_cols()).put(' ').value(entries).put('\n');
+
+  a.for_each([&](std::size_t r, std::size_t c, const Type& v) {
+    if (symmetric && r < c) return;
+    out.value(r + 1).put(' ').value(c + 1).put(' ').value(v).put('\n');
+  });
+}
+
+template <class Type, MAJOR major, class Index>
+void write_matrix_market(const CompressedMatrix<Type, major, Index>& a, const std::string& filename,
+                         bool symmetric = false) {
+  std::ofstream out(filename);
+  if (!out) throw std::runtime_error("Cannot open " + filename);
+
+  write_matrix_market(a, out, symmetric);
+  out.flush();
+  if (!out) throw std::runtime_error("Cannot write " + filename);
+}
+
+}
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef QAED_SPARSE_OPERATIONS_H
+#define QAED_SPARSE_OPERATIONS_H
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "SpMV.hpp"
+
+namespace qaed {
+
+namespace sparse {
+
+/// Lane by lane merge of two matrices with the same layout. Both
+/// lanes are sorted, so one pass over them finds the common indices.
+/// With union_of = true an index present in one matrix only gives
+/// op(v, 0) or op(0, v), otherwise only common indices are kept. A
+/// symbolic pass sizes the result, the numeric pass fills it, lanes
+/// split between threads by the entries of both operands.
+template <class Type, MAJOR major, class Index, class Op>
+CompressedMatrix<Type, major, Index> merge(const CompressedMatrix<Type, major, Index>& a,
+                                           const CompressedMatrix<Type, major, Index>& b,
+                                           bool union_of, Op op, unsigned threads) {
+  if (a.no_rows() != b.no_rows() || a.no_cols() != b.no_cols())
+    throw std::invalid_argument("Matrix sizes don't match");
+
+  using Offset = typename CompressedMatrix<Type, major, Index>::Offset;
+  const std::size_t outer = a.outer_size();
+
+  std::vector<Offset> work(outer + 1);
+  for (std::size_t o = 0; o <= outer; ++o) work[o] = a.pointers()[o] + b.pointers()[o];
+  threads = threads_for(work.back(), threads);
+
+  // Calls emit(index, value) for every entry of lane o of the result
+  auto lane = [&](std::size_t o, auto&& emit) {
+    const Index* ia = a.idx_begin(o); const Index* ea = a.idx_end(o); const Type* va = a.val_begin(o);
+    const Index* ib = b.idx_begin(o); const Index* eb = b.idx_end(o); const Type* vb = b.val_begin(o);
+
+    while (ia != ea && ib != eb) {
+      if      (*ia < *ib) { if (union_of) emit(*ia, op(*va, Type())); ++ia; ++va; }
+      else if (*ib < *ia) { if (union_of) emit(*ib, op(Type(), *vb)); ++ib; ++vb; }
+      else                { emit(*ia, op(*va, *vb)); ++ia; ++va; ++ib; ++vb; }
+    }
+
+    if (union_of) {
+      for (; ia != ea; ++ia, ++va) emit(*ia, op(*va, Type()));
+      for (; ib != eb; ++ib, ++vb) emit(*ib, op(Type(), *vb));
+    }
+  };
+
+  std::vector<Offset> ptr(outer + 1, 0);
+  parallel_for_balanced(work, threads, [&](std::size_t o0, std::size_t o1, unsigned) {
+    for (std::size_t o = o0; o < o1; ++o) {
+      Offset n = 0;
+      lane(o, [&](Index, const Type&) { ++n; });
+      ptr[o + 1] = n;
+    }
+  });
+  std::partial_sum(ptr.begin(), ptr.end(), ptr.begin());
+
+  std::vector<Index> idx(ptr.back());
+  std::vector<Type>  val(ptr.back());
+  parallel_for_balanced(work, threads, [&](std::size_t o0, std::size_t o1, unsigned) {
+    for (std::size_t o = o0; o < o1; ++o) {
+      Offset k = ptr[o];
+      lane(o, [&](Index i, const Type& v) { idx[k] = i; val[k] = v; ++k; });
+    }
+  });
+
+  return CompressedMatrix<Type, major, Index>(a.no_rows(), a.no_cols(), std::move(ptr), std::move(idx), std::move(val));
+}
+
+}
+
+/// A^T in the same layout as A, O(nnz + rows + cols). A parallel
+/// counting sort on the inner indices: each thread counts its block of
+/// lanes, then writes its entries after those of the blocks before it,
+/// so the new lanes come out sorted.
+template <class Type, MAJOR major, class Index>
+CompressedMatrix<Type, major, Index> transpose(const CompressedMatrix<Type, major, Index>& a,
+                                               unsigned threads = default_threads()) {
+  using Offset = typename CompressedMatrix<Type, major, Index>::Offset;
+
+  const std::size_t outer = a.outer_size();
+  const std::size_t inner = a.inner_size();
+  const auto&       src   = a.pointers();
+
+  // One histogram of the inner dimension per thread, keep them small
+  // next to the matrix itself
+  threads = sparse::threads_for(a.nnz(), threads);
+  if (inner) threads = std::min<unsigned>(threads, std::max<std::size_t>(1, a.nnz() / inner));
+  threads = std::max(1u, std::min<unsigned>(threads, std::max<std::size_t>(1, outer)));
+
+  // Lane blocks balanced by entries, fixed once for both passes
+  std::vector<std::size_t> cut(threads + 1, outer);
+  cut[0] = 0;
+  for (unsigned t = 1; t < threads; ++t) {
+    cut[t] = std::lower_bound(src.begin(), src.end() - 1, a.nnz() / threads * t) - src.begin();
+    cut[t] = std::max(cut[t], cut[t - 1]);
+  }
+
+  std::vector<Offset> count(std::size_t(threads) * inner, 0);
+  parallel_for(0, threads, threads, [&](std::size_t t0, std::size_t t1, unsigned) {
+    for (std::size_t t = t0; t < t1; ++t) {
+      Offset* c = count.data() + t * inner;
+      for (Offset k = src[cut[t]]; k < src[cut[t + 1]]; ++k) ++c[a.indices()[k]];
+    }
+  });
+
+  std::vector<Offset> ptr(inner + 1, 0);
+  Offset running = 0;
+  for (std::size_t i = 0; i < inner; ++i) {
+    ptr[i] = running;
+    for (unsigned t = 0; t < threads; ++t) {
+      Offset c = count[std::size_t(t) * inner + i];
+      count[std::size_t(t) * inner + i] = running;
+      running += c;
+    }
+  }
+  ptr[inner] = running;
+
+  std::vector<Index> idx(a.nnz());
+  std::vector<Type>  val(a.nnz());
+  parallel_for(0, threads, threads, [&](std::size_t t0, std::size_t t1, unsigned) {
+    for (std::size_t t = t0; t < t1; ++t) {
+      Offset* fill = count.data() + t * inner;
+      for (std::size_t o = cut[t]; o < cut[t + 1]; ++o)
+        for (Offset k = src[o]; k < src[o + 1]; ++k) {
+          Offset p = fill[a.indices()[k]]++;
+          idx[p] = Index(o);
+          val[p] = a.values()[k];
+        }
+    }
+  });
+
+  return CompressedMatrix<Type, major, Index>(a.no_cols(), a.no_rows(), std::move(ptr), std::move(idx), std::move(val));
+}
+
+/// A + B, entries that cancel out are kept
+template <class Type, MAJOR major, class Index>
+CompressedMatrix<Type, major, Index> add(const CompressedMatrix<Type, major, Index>& a,
+                                         const CompressedMatrix<Type, major, Index>& b,
+                                         unsigned threads = default_threads()) {
+  return sparse::merge(a, b, true, [](const Type& x, const Type& y) { return x + y; }, threads);
+}
+
+/// A - B, entries that cancel out are kept
+template <class Type, MAJOR major, class Index>
+CompressedMatrix<Type, major, Index> subtract(const CompressedMatrix<Type, major, Index>& a,
+                                              const CompressedMatrix<Type, major, Index>& b,
+                                              unsigned threads = default_threads()) {
+  return sparse::merge(a, b, true, [](const Type& x, const Type& y) { return x - y; }, threads);
+}
+
+/// Element wise product, only positions stored in both
+template <class Type, MAJOR major, class Index>
+CompressedMatrix<Type, major, Index> hadamard(const CompressedMatrix<Type, major, Index>& a,
+                                              const CompressedMatrix<Type, major, Index>& b,
+                                              unsigned threads = default_threads()) {
+  return sparse::merge(a, b, false, [](const Type& x, const Type& y) { return x * y; }, threads);
+}
+
+/// A *= alpha in place, the structure doesn't change
+template <class Type, MAJOR major, class Index>
+void scale(CompressedMatrix<Type, major, Index>& a, const Type& alpha, unsigned threads = default_threads()) {
+  std::vector<Type>& val = a.values();
+  parallel_for(0, val.size(), sparse::threads_for(val.size(), threads), [&](std::size_t b, std::size_t e, unsigned) {
+    for (std::size_t k = b; k < e; ++k) val[k] *= alpha;
+  });
+}
+
+/// Sum of every row, A 1 through the SpMV kernels
+template <class Type, MAJOR major, class Index>
+std::vector<Type> row_sums(const CompressedMatrix<Type, major, Index>& a, unsigned threads = default_threads()) {
+  return spmv(a, std::vector<Type>(a.no_cols(), Type(1)), threads);
+}
+
+/// Sum of every column, A^T 1
+template <class Type, MAJOR major, class Index>
+std::vector<Type> col_sums(const CompressedMatrix<Type, major, Index>& a, unsigned threads = default_threads()) {
+  return spmv_transposed(a, std::vector<Type>(a.no_rows(), Type(1)), threads);
+}
+
+}
+
+#endif
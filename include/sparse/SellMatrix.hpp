@@ -0,0 +1,270 @@
+#ifndef QAED_SELL_MATRIX_H
+#define QAED_SELL_MATRIX_H
+
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "SpMV.hpp"
+
+namespace qaed {
+
+namespace sparse {
+
+/// acc[lane] = sum over j < width of val[j * C + lane] * x[idx[j * C + lane]],
+/// one chunk of C rows stored column by column
+template <std::size_t C, class Type, class Index>
+void sell_chunk(const Index* idx, const Type* val, std::size_t width, const Type* x, Type* acc) {
+  for (std::size_t l = 0; l < C; ++l) acc[l] = Type();
+
+  for (std::size_t j = 0; j < width; ++j, idx += C, val += C)
+    for (std::size_t l = 0; l < C; ++l) acc[l] += val[l] * x[idx[l]];
+}
+
+/// The specialisations keep the C sums in AVX registers, every step is
+/// one load of values, one gather of x and one fma for the C rows
+/// together. The gathers take 32 bit indices, other index types go
+/// through sell_chunk.
+template <class Type, std::size_t C>
+struct SellKernel {
+  template <class Index>
+  static void chunk(const Index* idx, const Type* val, std::size_t width, const Type* x, Type* acc) {
+    sell_chunk<C>(idx, val, width, x, acc);
+  }
+};
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+template <>
+struct SellKernel<double, 8> {
+  template <class Index>
+  static void chunk(const Index* idx, const double* val, std::size_t width, const double* x, double* acc) {
+    sell_chunk<8>(idx, val, width, x, acc);
+  }
+
+  static void chunk(const std::uint32_t* idx, const double* val, std::size_t width, const double* x, double* acc) {
+#if defined(__AVX512F__)
+    const __m512d zero = _mm512_setzero_pd();
+    __m512d a = zero;
+
+    for (std::size_t j = 0; j < width; ++j, idx += 8, val += 8) {
+      __m256i i = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx));
+      a = _mm512_fmadd_pd(_mm512_loadu_pd(val), _mm512_mask_i32gather_pd(zero, 0xFF, i, x, 8), a);
+    }
+
+    _mm512_storeu_pd(acc, a);
+#else
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d ones = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d lo = zero, hi = zero;
+
+    for (std::size_t j = 0; j < width; ++j, idx += 8, val += 8) {
+      __m128i il = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx));
+      __m128i ih = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + 4));
+      lo = _mm256_fmadd_pd(_mm256_loadu_pd(val),     _mm256_mask_i32gather_pd(zero, x, il, ones, 8), lo);
+      hi = _mm256_fmadd_pd(_mm256_loadu_pd(val + 4), _mm256_mask_i32gather_pd(zero, x, ih, ones, 8), hi);
+    }
+
+    _mm256_storeu_pd(acc, lo);
+    _mm256_storeu_pd(acc + 4, hi);
+#endif
+  }
+};
+
+template <>
+struct SellKernel<float, 8> {
+  template <class Index>
+  static void chunk(const Index* idx, const float* val, std::size_t width, const float* x, float* acc) {
+    sell_chunk<8>(idx, val, width, x, acc);
+  }
+
+  static void chunk(const std::uint32_t* idx, const float* val, std::size_t width, const float* x, float* acc) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 ones = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    __m256 a = zero;
+
+    for (std::size_t j = 0; j < width; ++j, idx += 8, val += 8) {
+      __m256i i = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx));
+      a = _mm256_fmadd_ps(_mm256_loadu_ps(val), _mm256_mask_i32gather_ps(zero, x, i, ones, 4), a);
+    }
+
+    _mm256_storeu_ps(acc, a);
+  }
+};
+
+#if defined(__AVX512F__)
+
+template <>
+struct SellKernel<float, 16> {
+  template <class Index>
+  static void chunk(const Index* idx, const float* val, std::size_t width, const float* x, float* acc) {
+    sell_chunk<16>(idx, val, width, x, acc);
+  }
+
+  static void chunk(const std::uint32_t* idx, const float* val, std::size_t width, const float* x, float* acc) {
+    const __m512 zero = _mm512_setzero_ps();
+    __m512 a = zero;
+
+    for (std::size_t j = 0; j < width; ++j, idx += 16, val += 16) {
+      __m512i i = _mm512_loadu_si512(idx);
+      a = _mm512_fmadd_ps(_mm512_loadu_ps(val), _mm512_mask_i32gather_ps(zero, 0xFFFF, i, x, 4), a);
+    }
+
+    _mm512_storeu_ps(acc, a);
+  }
+};
+
+#endif
+
+#endif
+
+}
+
+/// SELL-C-sigma: rows are sorted by length inside windows of sigma
+/// rows, then cut in chunks of C rows. A chunk is padded to its
+/// longest row and stored column by column, so the C rows advance
+/// together and SpMV runs C wide with gathers of x. Sorting keeps the
+/// padding small, the window keeps rows close to where they were.
+/// sigma below C means no sorting.
+template <class Type, std::size_t C = 8, class Index = std::uint32_t>
+class SellMatrix {
+  static_assert(C == 4 || C == 8 || C == 16, "SELL chunks are 4, 8 or 16 rows");
+
+public:
+  using Size_t = std::size_t;
+  using Offset = std::size_t;
+
+  static constexpr std::size_t CHUNK = C;
+
+private:
+  Size_t              m_no_rows;
+  Size_t              m_no_cols;
+  Size_t              m_sigma;
+  Offset              m_nnz;
+  std::vector<Offset> m_ptr;    // by chunk, width = size / C
+  std::vector<Index>  m_row;    // row in each slot, C per chunk
+  std::vector<Index>  m_len;    // entries of that row
+  std::vector<Index>  m_idx;
+  std::vector<Type>   m_val;
+
+public:
+  SellMatrix() : m_no_rows(0), m_no_cols(0), m_sigma(1), m_nnz(0), m_ptr(1, 0) {}
+
+  explicit SellMatrix(const CSRMatrix<Type, Index>& a, Size_t sigma = 32 * C, unsigned threads = default_threads()) :
+    m_no_rows(a.no_rows()), m_no_cols(a.no_cols()), m_sigma(sigma < C ? 1 : (sigma + C - 1) / C * C),
+    m_nnz(a.nnz()), m_ptr(chunks() + 1, 0), m_row(chunks() * C, 0), m_len(chunks() * C, 0) {
+
+    if (m_no_rows > Size_t(~Index(0))) throw std::invalid_argument("Matrix rows don't fit in Index");
+
+    std::iota(m_row.begin(), m_row.begin() + m_no_rows, Index(0));
+    if (m_sigma > 1)
+      for (Size_t w = 0; w < m_no_rows; w += m_sigma)
+        std::stable_sort(m_row.begin() + w, m_row.begin() + std::min(w + m_sigma, m_no_rows),
+                         [&](Index r, Index s) { return a.lane_size(r) > a.lane_size(s); });
+
+    for (Size_t slot = 0; slot < m_no_rows; ++slot) m_len[slot] = Index(a.lane_size(m_row[slot]));
+
+    for (Size_t ch = 0; ch < chunks(); ++ch)
+      m_ptr[ch + 1] = m_ptr[ch] + C * *std::max_element(m_len.begin() + ch * C, m_len.begin() + (ch + 1) * C);
+
+    // Padding reads x[0] and adds 0 times it
+    m_idx.assign(m_ptr.back(), Index(0));
+    m_val.assign(m_ptr.back(), Type());
+
+    parallel_for_balanced(m_ptr, sparse::threads_for(m_ptr.back(), threads), [&](std::size_t b, std::size_t e, unsigned) {
+      for (std::size_t ch = b; ch < e; ++ch)
+        for (std::size_t l = 0; l < C; ++l) {
+          const Size_t slot = ch * C + l;
+          if (slot >= m_no_rows) break;
+
+          const Index* c = a.idx_begin(m_row[slot]);
+          const Type*  v = a.val_begin(m_row[slot]);
+          for (std::size_t j = 0; j < m_len[slot]; ++j) {
+            m_idx[m_ptr[ch] + j * C + l] = c[j];
+            m_val[m_ptr[ch] + j * C + l] = v[j];
+          }
+        }
+    });
+  }
+
+  Size_t no_rows() const { return m_no_rows; }
+  Size_t no_cols() const { return m_no_cols; }
+  Size_t sigma()   const { return m_sigma; }
+  Size_t chunks()  const { return (m_no_rows + C - 1) / C; }
+
+  /// Entries of the source matrix and stored slots, padding included
+  Offset nnz()    const { return m_nnz; }
+  Offset stored() const { return m_val.size(); }
+
+  /// Share of the stored slots that are real entries
+  double fill() const { return stored() ? double(m_nnz) / stored() : 1.0; }
+
+  const std::vector<Offset>& pointers() const { return m_ptr; }
+  const std::vector<Index>&  rows()     const { return m_row; }
+  const std::vector<Index>&  indices()  const { return m_idx; }
+  const std::vector<Type>&   values()   const { return m_val; }
+
+  Offset width(Size_t ch) const { return (m_ptr[ch + 1] - m_ptr[ch]) / C; }
+
+  const Index* idx_begin(Size_t ch) const { return m_idx.data() + m_ptr[ch]; }
+  const Type*  val_begin(Size_t ch) const { return m_val.data() + m_ptr[ch]; }
+
+  /// Back to CSR, exactly the source matrix
+  CSRMatrix<Type, Index> to_csr() const {
+    std::vector<Offset> ptr(m_no_rows + 1, 0);
+    for (Size_t slot = 0; slot < m_no_rows; ++slot) ptr[m_row[slot] + 1] = m_len[slot];
+    std::partial_sum(ptr.begin(), ptr.end(), ptr.begin());
+
+    std::vector<Index> idx(m_nnz);
+    std::vector<Type>  val(m_nnz);
+    for (Size_t slot = 0; slot < m_no_rows; ++slot) {
+      const Size_t ch = slot / C, l = slot % C;
+      for (std::size_t j = 0; j < m_len[slot]; ++j) {
+        idx[ptr[m_row[slot]] + j] = m_idx[m_ptr[ch] + j * C + l];
+        val[ptr[m_row[slot]] + j] = m_val[m_ptr[ch] + j * C + l];
+      }
+    }
+
+    return CSRMatrix<Type, Index>(m_no_rows, m_no_cols, std::move(ptr), std::move(idx), std::move(val));
+  }
+
+};
+
+/// y = alpha * A * x + beta * y, chunks split between threads by
+/// stored slots. The gathers read indices as signed, so past 2^31
+/// columns the chunks run scalar.
+template <class Type, std::size_t C, class Index>
+void spmv(const SellMatrix<Type, C, Index>& a, const Type* x, Type* y,
+          Type alpha = Type(1), Type beta = Type(), unsigned threads = default_threads()) {
+  const bool simd = a.no_cols() <= std::size_t(INT32_MAX);
+
+  parallel_for_balanced(a.pointers(), sparse::threads_for(a.stored(), threads), [&](std::size_t b, std::size_t e, unsigned) {
+    alignas(64) Type acc[C];
+
+    for (std::size_t ch = b; ch < e; ++ch) {
+      if (simd) sparse::SellKernel<Type, C>::chunk(a.idx_begin(ch), a.val_begin(ch), a.width(ch), x, acc);
+      else      sparse::sell_chunk<C>(a.idx_begin(ch), a.val_begin(ch), a.width(ch), x, acc);
+
+      const std::size_t rows = std::min(C, a.no_rows() - ch * C);
+      const Index*      row  = a.rows().data() + ch * C;
+      for (std::size_t l = 0; l < rows; ++l)
+        y[row[l]] = beta == Type() ? alpha * acc[l] : alpha * acc[l] + beta * y[row[l]];
+    }
+  });
+}
+
+template <class Type, std::size_t C, class Index>
+std::vector<Type> spmv(const SellMatrix<Type, C, Index>& a, const std::vector<Type>& x,
+                       unsigned threads = default_threads()) {
+  if (x.size() != a.no_cols()) throw std::invalid_argument("Vector size doesn't match the matrix columns");
+
+  std::vector<Type> y(a.no_rows());
+  spmv(a, x.data(), y.data(), Type(1), Type(), threads);
+  return y;
+}
+
+}
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef QAED_SPGEMM_H
+#define QAED_SPGEMM_H
+
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../CompressedMatrix.hpp"
+#include "../tools/Parallel.hpp"
+
+namespace qaed {
+
+namespace sparse {
+
+/// Row accumulator for Gustavson's algorithm. Rows touching a good
+/// part of the columns use a dense array (stamped, so it is never
+/// cleared), short rows use a small open addressing table that stays
+/// in cache. One per thread, reused for every row.
+template <class Type, class Index>
+class Accumulator {
+public:
+  static constexpr Index EMPTY = ~Index(0);
+
+  /// A row goes dense when its flops reach width / DENSE_RATIO
+  static constexpr std::size_t DENSE_RATIO = 32;
+
+private:
+  std::size_t                m_width;
+  bool                       m_dense;
+  std::vector<std::uint32_t> m_stamp;
+  std::uint32_t              m_now;
+  std::vector<Index>         m_key;
+  std::size_t                m_mask;
+  std::vector<Type>          m_sum;     // by column (dense) or by slot (hash)
+  std::vector<Index>         m_used;    // touched columns (dense) or slots (hash)
+
+public:
+  explicit Accumulator(std::size_t width) : m_width(width), m_dense(false), m_now(0), m_mask(0) {}
+
+  /// flops is an upper bound of the entries the row can get
+  void begin_row(std::size_t flops) {
+    m_used.clear();
+    m_dense = flops * DENSE_RATIO >= m_width;
+
+    if (m_dense) {
+      if (m_stamp.size() < m_width) {
+        m_stamp.assign(m_width, 0);
+        m_sum.resize(std::max(m_sum.size(), m_width));
+      }
+      if (++m_now == 0) { std::fill(m_stamp.begin(), m_stamp.end(), 0); m_now = 1; }
+    } else {
+      std::size_t cap = 16;
+      while (cap < 2 * flops) cap <<= 1;
+
+      if (m_key.size() < cap) m_key.resize(cap, EMPTY);
+      if (m_sum.size() < cap) m_sum.resize(cap);
+      m_mask = cap - 1;
+    }
+  }
+
+  /// Adds v to column c, numeric = false only counts the columns
+  template <bool numeric>
+  void add(Index c, const Type& v) {
+    if (m_dense) {
+      if (m_stamp[c] != m_now) {
+        m_stamp[c] = m_now;
+        m_used.push_back(c);
+        if (numeric) m_sum[c] = v;
+      } else if (numeric) {
+        m_sum[c] += v;
+      }
+      return;
+    }
+
+    std::size_t slot = (std::size_t(c) * 2654435761u) & m_mask;
+    while (m_key[slot] != c && m_key[slot] != EMPTY) slot = (slot + 1) & m_mask;
+
+    if (m_key[slot] == EMPTY) {
+      m_key[slot] = c;
+      m_used.push_back(Index(slot));
+      if (numeric) m_sum[slot] = v;
+    } else if (numeric) {
+      m_sum[slot] += v;
+    }
+  }
+
+  std::size_t size() const { return m_used.size(); }
+
+  /// Writes the row sorted by column and leaves the table empty
+  void end_row(Index* idx, Type* val) {
+    if (m_dense) {
+      std::sort(m_used.begin(), m_used.end());
+      for (std::size_t k = 0; k < m_used.size(); ++k) {
+        idx[k] = m_used[k];
+        val[k] = m_sum[m_used[k]];
+      }
+      return;
+    }
+
+    std::sort(m_used.begin(), m_used.end(), [this](Index s, Index t) { return m_key[s] < m_key[t]; });
+    for (std::size_t k = 0; k < m_used.size(); ++k) {
+      idx[k] = m_key[m_used[k]];
+      val[k] = m_sum[m_used[k]];
+    }
+    clear();
+  }
+
+  /// Forgets the row (symbolic phase)
+  void clear() {
+    if (!m_dense)
+      for (Index s : m_used) m_key[s] = EMPTY;
+    m_used.clear();
+  }
+};
+
+}
+
+/// C = A * B with Gustavson's row by row algorithm. A symbolic pass
+/// counts the entries of every row of C so the arrays are allocated
+/// once and exactly, the numeric pass fills them. Rows are split
+/// between threads by flops (sum of the B rows each A row touches).
+/// Entries that cancel out to zero are kept.
+template <class Type, class Index>
+CSRMatrix<Type, Index> multiply(const CSRMatrix<Type, Index>& a, const CSRMatrix<Type, Index>& b,
+                                unsigned threads = default_threads()) {
+  if (a.no_cols() != b.no_rows()) throw std::invalid_argument("Matrix sizes don't match for a product");
+
+  using Offset = typename CSRMatrix<Type, Index>::Offset;
+  const std::size_t rows = a.no_rows();
+  threads = std::max(1u, threads);
+
+  std::vector<Offset> flops(rows + 1, 0);
+  parallel_for(0, rows, threads, [&](std::size_t r0, std::size_t r1, unsigned) {
+    for (std::size_t r = r0; r < r1; ++r)
+      for (const Index* k = a.idx_begin(r); k != a.idx_end(r); ++k)
+        flops[r + 1] += b.lane_size(*k);
+  });
+  std::partial_sum(flops.begin(), flops.end(), flops.begin());
+
+  std::vector<sparse::Accumulator<Type, Index>> acc(threads, sparse::Accumulator<Type, Index>(b.no_cols()));
+
+  // Symbolic
+  std::vector<Offset> ptr(rows + 1, 0);
+  parallel_for_balanced(flops, threads, [&](std::size_t r0, std::size_t r1, unsigned tid) {
+    auto& row = acc[tid];
+
+    for (std::size_t r = r0; r < r1; ++r) {
+      row.begin_row(flops[r + 1] - flops[r]);
+      for (const Index* k = a.idx_begin(r); k != a.idx_end(r); ++k)
+        for (const Index* c = b.idx_begin(*k); c != b.idx_end(*k); ++c)
+          row.template add<false>(*c, Type());
+
+      ptr[r + 1] = row.size();
+      row.clear();
+    }
+  });
+  std::partial_sum(ptr.begin(), ptr.end(), ptr.begin());
+
+  // Numeric
+  std::vector<Index> idx(ptr.back());
+  std::vector<Type>  val(ptr.back());
+
+  parallel_for_balanced(flops, threads, [&](std::size_t r0, std::size_t r1, unsigned tid) {
+    auto& row = acc[tid];
+
+    for (std::size_t r = r0; r < r1; ++r) {
+      row.begin_row(flops[r + 1] - flops[r]);
+
+      const Type* av = a.val_begin(r);
+      for (const Index* k = a.idx_begin(r); k != a.idx_end(r); ++k, ++av) {
+        const Type* bv = b.val_begin(*k);
+        for (const Index* c = b.idx_begin(*k); c != b.idx_end(*k); ++c, ++bv)
+          row.template add<true>(*c, *av * *bv);
+      }
+
+      row.end_row(idx.data() + ptr[r], val.data() + ptr[r]);
+    }
+  });
+
+  return CSRMatrix<Type, Index>(rows, b.no_cols(), std::move(ptr), std::move(idx), std::move(val));
+}
+
+/// CSC arrays of a matrix are the CSR arrays of its transpose, and
+/// (A B)^T = B^T A^T, so the CSR product gives the CSC result directly
+template <class Type, class Index>
+CSCMatrix<Type, Index> multiply(const CSCMatrix<Type, Index>& a, const CSCMatrix<Type, Index>& b,
+                                unsigned threads = default_threads()) {
+  if (a.no_cols() != b.no_rows()) throw std::invalid_argument("Matrix sizes don't match for a product");
+
+  CSRMatrix<Type, Index> at(a.no_cols(), a.no_rows(), a.pointers(), a.indices(), a.values());
+  CSRMatrix<Type, Index> bt(b.no_cols(), b.no_rows(), b.pointers(), b.indices(), b.values());
+  CSRMatrix<Type, Index> ct = multiply(bt, at, threads);
+
+  return CSCMatrix<Type, Index>(a.no_rows(), b.no_cols(), ct.pointers(), ct.indices(), ct.values());
+}
+
+/// FastMatrix operands go through CSR (O(nnz) each), the product stays
+/// in CSR, to_fast_matrix() brings it back if needed
+template <class Type, Type def, class SizeT>
+CSRMatrix<Type> multiply(const FastMatrix<Type, def, SizeT>& a, const FastMatrix<Type, def, SizeT>& b,
+                         unsigned threads = default_threads()) {
+  return multiply(CSRMatrix<Type>(a), CSRMatrix<Type>(b), threads);
+}
+
+}
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef QAED_SPMV_H
+#define QAED_SPMV_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+#include "../CompressedMatrix.hpp"
+#include "../tools/Parallel.hpp"
+
+namespace qaed {
+
+namespace sparse {
+
+/// Below this many entries a product runs in the calling thread,
+/// starting threads costs more than the product itself
+constexpr std::size_t PARALLEL_NNZ = 1 << 15;
+
+template <class Type, class Index>
+inline Type dot_scalar(const Index* idx, const Type* val, std::size_t n, const Type* x) {
+  Type s = Type();
+  for (std::size_t k = 0; k < n; ++k)
+    s += val[k] * x[idx[k]];
+  return s;
+}
+
+/// sum of val[k] * x[idx[k]], the overloads below gather x with AVX
+/// when the build allows it (indices are read as signed 32 bit ints).
+/// The masked gathers only keep -Wmaybe-uninitialized quiet.
+template <class Type, class Index>
+inline Type dot(const Index* idx, const Type* val, std::size_t n, const Type* x) {
+  return dot_scalar(idx, val, n, x);
+}
+
+#if defined(__AVX512F__)
+
+inline double dot(const std::uint32_t* idx, const double* val, std::size_t n, const double* x) {
+  const __m512d zero = _mm512_setzero_pd();
+  __m512d acc = zero;
+  std::size_t k = 0;
+
+  for (; k + 8 <= n; k += 8) {
+    __m256i i = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + k));
+    acc = _mm512_fmadd_pd(_mm512_loadu_pd(val + k), _mm512_mask_i32gather_pd(zero, 0xFF, i, x, 8), acc);
+  }
+
+  // _mm512_reduce_add_* trips -Wmaybe-uninitialized in GCC 12 headers
+  alignas(64) double lanes[8];
+  _mm512_store_pd(lanes, acc);
+
+  double s = 0;
+  for (double l : lanes) s += l;
+  for (; k < n; ++k) s += val[k] * x[idx[k]];
+  return s;
+}
+
+inline float dot(const std::uint32_t* idx, const float* val, std::size_t n, const float* x) {
+  const __m512 zero = _mm512_setzero_ps();
+  __m512 acc = zero;
+  std::size_t k = 0;
+
+  for (; k + 16 <= n; k += 16) {
+    __m512i i = _mm512_loadu_si512(idx + k);
+    acc = _mm512_fmadd_ps(_mm512_loadu_ps(val + k), _mm512_mask_i32gather_ps(zero, 0xFFFF, i, x, 4), acc);
+  }
+
+  alignas(64) float lanes[16];
+  _mm512_store_ps(lanes, acc);
+
+  float s = 0;
+  for (float l : lanes) s += l;
+  for (; k < n; ++k) s += val[k] * x[idx[k]];
+  return s;
+}
+
+#elif defined(__AVX2__) && defined(__FMA__)
+
+inline double dot(const std::uint32_t* idx, const double* val, std::size_t n, const double* x) {
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d ones = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  __m256d acc = zero;
+  std::size_t k = 0;
+
+  for (; k + 4 <= n; k += 4) {
+    __m128i i = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + k));
+    acc = _mm256_fmadd_pd(_mm256_loadu_pd(val + k), _mm256_mask_i32gather_pd(zero, x, i, ones, 8), acc);
+  }
+
+  __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+  double s = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+
+  for (; k < n; ++k) s += val[k] * x[idx[k]];
+  return s;
+}
+
+inline float dot(const std::uint32_t* idx, const float* val, std::size_t n, const float* x) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 ones = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+  __m256 acc = zero;
+  std::size_t k = 0;
+
+  for (; k + 8 <= n; k += 8) {
+    __m256i i = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + k));
+    acc = _mm256_fmadd_ps(_mm256_loadu_ps(val + k), _mm256_mask_i32gather_ps(zero, x, i, ones, 4), acc);
+  }
+
+  __m128 q = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  q = _mm_add_ps(q, _mm_movehl_ps(q, q));
+  float s = _mm_cvtss_f32(_mm_add_ss(q, _mm_movehdup_ps(q)));
+
+  for (; k < n; ++k) s += val[k] * x[idx[k]];
+  return s;
+}
+
+#endif
+
+inline unsigned threads_for(std::size_t nnz, unsigned threads) {
+  return nnz < PARALLEL_NNZ ? 1u : std::max(1u, threads);
+}
+
+/// y[o] = alpha * lane(o) . x + beta * y[o] for every lane, lanes are
+/// split between threads by nonzeros. beta = 0 doesn't read y.
+/// Matrix is anything with the lane accessors of CompressedMatrix.
+template <class Matrix, class Type>
+void gather(const Matrix& a, const Type* x, Type* y, Type alpha, Type beta, unsigned threads) {
+  const bool simd = a.inner_size() <= std::size_t(INT32_MAX);
+
+  parallel_for_balanced(&a.pointers()[0], a.outer_size(), threads_for(a.nnz(), threads), [&](std::size_t b, std::size_t e, unsigned) {
+    for (std::size_t o = b; o < e; ++o) {
+      Type s = simd ? dot(a.idx_begin(o), a.val_begin(o), a.lane_size(o), x)
+                    : dot_scalar(a.idx_begin(o), a.val_begin(o), a.lane_size(o), x);
+      y[o] = beta == Type() ? alpha * s : alpha * s + beta * y[o];
+    }
+  });
+}
+
+/// y = alpha * sum over lanes o of lane(o) * x[o] + beta * y, y is
+/// indexed by the inner dimension. Every thread scatters its lanes in
+/// a private copy of y, the copies are added at the end.
+template <class Matrix, class Type>
+void scatter(const Matrix& a, const Type* x, Type* y, Type alpha, Type beta, unsigned threads) {
+  const std::size_t n = a.inner_size();
+  threads = threads_for(a.nnz(), threads);
+
+  for (std::size_t ii = 0; ii < n; ++ii)
+    y[ii] = beta == Type() ? Type() : beta * y[ii];
+
+  std::vector<std::vector<Type>> partial(threads - 1);
+
+  parallel_for_balanced(&a.pointers()[0], a.outer_size(), threads, [&](std::size_t b, std::size_t e, unsigned tid) {
+    Type* out = y;
+    if (tid) { partial[tid - 1].assign(n, Type()); out = partial[tid - 1].data(); }
+
+    for (std::size_t o = b; o < e; ++o) {
+      Type s = alpha * x[o];
+      const auto* idx = a.idx_begin(o);
+      const Type* val = a.val_begin(o);
+
+      for (std::size_t k = 0; k < a.lane_size(o); ++k)
+        out[idx[k]] += val[k] * s;
+    }
+  });
+
+  parallel_for(0, n, threads, [&](std::size_t b, std::size_t e, unsigned) {
+    for (auto& p : partial)
+      if (!p.empty())
+        for (std::size_t ii = b; ii < e; ++ii) y[ii] += p[ii];
+  });
+}
+
+/// Block versions, x and y are row major with k columns
+template <class Matrix, class Type>
+void gather_block(const Matrix& a, const Type* x, std::size_t k, Type* y,
+                  Type alpha, Type beta, unsigned threads) {
+  parallel_for_balanced(&a.pointers()[0], a.outer_size(), threads_for(a.nnz() * k, threads), [&](std::size_t b, std::size_t e, unsigned) {
+    std::vector<Type> acc(k);
+
+    for (std::size_t o = b; o < e; ++o) {
+      std::fill(acc.begin(), acc.end(), Type());
+
+      // Contiguous rows of x, the inner loop vectorizes on its own
+      for (std::size_t p = 0; p < a.lane_size(o); ++p) {
+        const Type  v   = a.val_begin(o)[p];
+        const Type* row = x + std::size_t(a.idx_begin(o)[p]) * k;
+        for (std::size_t j = 0; j < k; ++j) acc[j] += v * row[j];
+      }
+
+      Type* out = y + o * k;
+      for (std::size_t j = 0; j < k; ++j)
+        out[j] = beta == Type() ? alpha * acc[j] : alpha * acc[j] + beta * out[j];
+    }
+  });
+}
+
+template <class Matrix, class Type>
+void scatter_block(const Matrix& a, const Type* x, std::size_t k, Type* y,
+                   Type alpha, Type beta, unsigned threads) {
+  const std::size_t n = a.inner_size() * k;
+  threads = threads_for(a.nnz() * k, threads);
+
+  for (std::size_t ii = 0; ii < n; ++ii)
+    y[ii] = beta == Type() ? Type() : beta * y[ii];
+
+  std::vector<std::vector<Type>> partial(threads - 1);
+
+  parallel_for_balanced(&a.pointers()[0], a.outer_size(), threads, [&](std::size_t b, std::size_t e, unsigned tid) {
+    Type* out = y;
+    if (tid) { partial[tid - 1].assign(n, Type()); out = partial[tid - 1].data(); }
+
+    for (std::size_t o = b; o < e; ++o)
+      for (std::size_t p = 0; p < a.lane_size(o); ++p) {
+        const Type  v   = alpha * a.val_begin(o)[p];
+        const Type* src = x + o * k;
+        Type*       dst = out + std::size_t(a.idx_begin(o)[p]) * k;
+        for (std::size_t j = 0; j < k; ++j) dst[j] += v * src[j];
+      }
+  });
+
+  parallel_for(0, n, threads, [&](std::size_t b, std::size_t e, unsigned) {
+    for (auto& p : partial)
+      if (!p.empty())
+        for (std::size_t ii = b; ii < e; ++ii) y[ii] += p[ii];
+  });
+}
+
+}
+
+/// y = alpha * A * x + beta * y. x has no_cols() entries and y no_rows().
+/// CSR gathers row by row, CSC scatters column by column.
+template <class Type, MAJOR major, class Index>
+void spmv(const CompressedMatrix<Type, major, Index>& a, const Type* x, Type* y,
+          Type alpha = Type(1), Type beta = Type(), unsigned threads = default_threads()) {
+  if (major == ROW_MAJOR) sparse::gather(a, x, y, alpha, beta, threads);
+  else                    sparse::scatter(a, x, y, alpha, beta, threads);
+}
+
+template <class Type, MAJOR major, class Index>
+std::vector<Type> spmv(const CompressedMatrix<Type, major, Index>& a, const std::vector<Type>& x,
+                       unsigned threads = default_threads()) {
+  if (x.size() != a.no_cols()) throw std::invalid_argument("Vector size doesn't match the matrix columns");
+
+  std::vector<Type> y(a.no_rows());
+  spmv(a, x.data(), y.data(), Type(1), Type(), threads);
+  return y;
+}
+
+/// y = alpha * A^T * x + beta * y. x has no_rows() entries and y no_cols().
+template <class Type, MAJOR major, class Index>
+void spmv_transposed(const CompressedMatrix<Type, major, Index>& a, const Type* x, Type* y,
+                     Type alpha = Type(1), Type beta = Type(), unsigned threads = default_threads()) {
+  if (major == COL_MAJOR) sparse::gather(a, x, y, alpha, beta, threads);
+  else                    sparse::scatter(a, x, y, alpha, beta, threads);
+}
+
+template <class Type, MAJOR major, class Index>
+std::vector<Type> spmv_transposed(const CompressedMatrix<Type, major, Index>& a, const std::vector<Type>& x,
+                                  unsigned threads = default_threads()) {
+  if (x.size() != a.no_rows()) throw std::invalid_argument("Vector size doesn't match the matrix rows");
+
+  std::vector<Type> y(a.no_cols());
+  spmv_transposed(a, x.data(), y.data(), Type(1), Type(), threads);
+  return y;
+}
+
+/// Y = alpha * A * X + beta * Y for k vectors at once, X is no_cols() x k
+/// and Y no_rows() x k, both row major. Every entry of A is read once
+/// for the k vectors.
+template <class Type, MAJOR major, class Index>
+void spmm(const CompressedMatrix<Type, major, Index>& a, const Type* x, std::size_t k, Type* y,
+          Type alpha = Type(1), Type beta = Type(), unsigned threads = default_threads()) {
+  if (major == ROW_MAJOR) sparse::gather_block(a, x, k, y, alpha, beta, threads);
+  else                    sparse::scatter_block(a, x, k, y, alpha, beta, threads);
+}
+
+template <class Type, MAJOR major, class Index>
+std::vector<Type> spmm(const CompressedMatrix<Type, major, Index>& a, const std::vector<Type>& x, std::size_t k,
+                       unsigned threads = default_threads()) {
+  if (k == 0 || x.size() != a.no_cols() * k) throw std::invalid_argument("Block size doesn't match the matrix columns");
+
+  std::vector<Type> y(a.no_rows() * k);
+  spmm(a, x.data(), k, y.data(), Type(1), Type(), threads);
+  return y;
+}
+
+}
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef QAED_TRIPLET_BUILDER_H
+#define QAED_TRIPLET_BUILDER_H
+
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../CompressedMatrix.hpp"
+#include "../tools/Parallel.hpp"
+
+namespace qaed {
+
+/// What to do with entries added more than once at the same position.
+/// LAST keeps the one added last.
+enum COMBINE {
+  SUM,
+  LAST,
+  MIN,
+  MAX
+};
+
+/// Collects (row, col, value) triplets in any order, three flat arrays
+/// and no per entry allocation, then builds a compressed matrix in one
+/// go: counting sort by lane, sort inside each lane and merge of the
+/// repeated positions, all split between threads.
+template <class Type, class Index = std::uint32_t>
+class TripletBuilder {
+public:
+  using Size_t = std::size_t;
+  using Offset = std::size_t;
+
+private:
+  struct Entry {
+    Index inner;
+    Type  value;
+  };
+
+  Size_t             m_no_rows;
+  Size_t             m_no_cols;
+  std::vector<Index> m_rows;
+  std::vector<Index> m_cols;
+  std::vector<Type>  m_vals;
+
+public:
+  TripletBuilder(Size_t rows, Size_t cols) : m_no_rows(rows), m_no_cols(cols) {
+    if (rows > Size_t(~Index(0)) || cols > Size_t(~Index(0)))
+      throw std::invalid_argument("Matrix dimensions don't fit in Index");
+  }
+
+  Size_t no_rows() const { return m_no_rows; }
+  Size_t no_cols() const { return m_no_cols; }
+
+  /// Triplets added so far, repeats included
+  Size_t size() const { return m_vals.size(); }
+
+  void reserve(Size_t n) {
+    m_rows.reserve(n);
+    m_cols.reserve(n);
+    m_vals.reserve(n);
+  }
+
+  void clear() {
+    m_rows.clear();
+    m_cols.clear();
+    m_vals.clear();
+  }
+
+  void add(Size_t row, Size_t col, const Type& value) {
+    if (row >= m_no_rows) throw std::out_of_range("rows out of range");
+    if (col >= m_no_cols) throw std::out_of_range("cols out of range");
+
+    m_rows.push_back(Index(row));
+    m_cols.push_back(Index(col));
+    m_vals.push_back(value);
+  }
+
+  /// A batch of n triplets given as three parallel arrays
+  void add(const Index* rows, const Index* cols, const Type* vals, Size_t n) {
+    for (Size_t k = 0; k < n; ++k) {
+      if (rows[k] >= m_no_rows) throw std::out_of_range("rows out of range");
+      if (cols[k] >= m_no_cols) throw std::out_of_range("cols out of range");
+    }
+
+    m_rows.insert(m_rows.end(), rows, rows + n);
+    m_cols.insert(m_cols.end(), cols, cols + n);
+    m_vals.insert(m_vals.end(), vals, vals + n);
+  }
+
+  /// The matrix of the triplets, the builder is left untouched and can
+  /// take more triplets for another build
+  template <MAJOR major = ROW_MAJOR>
+  CompressedMatrix<Type, major, Index> build(COMBINE combine = SUM, unsigned threads = default_threads()) const {
+    const std::vector<Index>& outer_of = major == ROW_MAJOR ? m_rows : m_cols;
+    const std::vector<Index>& inner_of = major == ROW_MAJOR ? m_cols : m_rows;
+
+    const Size_t outer = major == ROW_MAJOR ? m_no_rows : m_no_cols;
+    const Size_t n     = m_vals.size();
+
+    // One histogram per thread, so cap the threads to keep them small
+    // next to the triplets themselves
+    threads = std::max(1u, threads);
+    if (outer) threads = std::min<unsigned>(threads, std::max<Size_t>(1, n / outer));
+
+    // Per thread and lane counts, then where each thread starts
+    // writing in each lane. Chunks keep the input order inside a lane,
+    // which is what LAST relies on.
+    std::vector<Offset> count(Size_t(threads) * outer, 0);
+    parallel_for(0, n, threads, [&](Size_t b, Size_t e, unsigned tid) {
+      Offset* c = count.data() + Size_t(tid) * outer;
+      for (Size_t k = b; k < e; ++k) ++c[outer_of[k]];
+    });
+
+    std::vector<Offset> start(outer + 1, 0);
+    Offset running = 0;
+    for (Size_t o = 0; o < outer; ++o) {
+      start[o] = running;
+      for (unsigned tid = 0; tid < threads; ++tid) {
+        Offset c = count[Size_t(tid) * outer + o];
+        count[Size_t(tid) * outer + o] = running;
+        running += c;
+      }
+    }
+    start[outer] = running;
+
+    std::vector<Entry> sorted(n);
+    parallel_for(0, n, threads, [&](Size_t b, Size_t e, unsigned tid) {
+      Offset* pos = count.data() + Size_t(tid) * outer;
+      for (Size_t k = b; k < e; ++k) sorted[pos[outer_of[k]]++] = Entry{ inner_of[k], m_vals[k] };
+    });
+    std::vector<Offset>().swap(count);
+
+    // Sort and merge every lane in place, ptr gets the merged sizes
+    std::vector<Offset> ptr(outer + 1, 0);
+    parallel_for_balanced(start, threads, [&](Size_t b, Size_t e, unsigned) {
+      for (Size_t o = b; o < e; ++o)
+        ptr[o + 1] = merge_lane(sorted.data() + start[o], sorted.data() + start[o + 1], combine);
+    });
+    std::partial_sum(ptr.begin(), ptr.end(), ptr.begin());
+
+    std::vector<Index> idx(ptr.back());
+    std::vector<Type>  val(ptr.back());
+    parallel_for_balanced(ptr, threads, [&](Size_t b, Size_t e, unsigned) {
+      for (Size_t o = b; o < e; ++o) {
+        const Entry* from = sorted.data() + start[o];
+        for (Offset k = ptr[o]; k < ptr[o + 1]; ++k, ++from) {
+          idx[k] = from->inner;
+          val[k] = from->value;
+        }
+      }
+    });
+
+    return CompressedMatrix<Type, major, Index>(m_no_rows, m_no_cols, std::move(ptr), std::move(idx), std::move(val));
+  }
+
+  CSRMatrix<Type, Index> to_csr(COMBINE combine = SUM, unsigned threads = default_threads()) const {
+    return build<ROW_MAJOR>(combine, threads);
+  }
+
+  CSCMatrix<Type, Index> to_csc(COMBINE combine = SUM, unsigned threads = default_threads()) const {
+    return build<COL_MAJOR>(combine, threads);
+  }
+
+private:
+
+  /// Stable sort by inner index (lanes are usually short, insertion
+  /// sort then) and merge of the repeats to the front, returns how
+  /// many entries are left
+  static Offset merge_lane(Entry* first, Entry* last, COMBINE combine) {
+    if (first == last) return 0;
+
+    auto less = [](const Entry& a, const Entry& b) { return a.inner < b.inner; };
+    if (last - first <= 32) {
+      for (Entry* i = first + 1; i < last; ++i) {
+        Entry e = *i;
+        Entry* j = i;
+        for (; j > first && e.inner < (j - 1)->inner; --j) *j = *(j - 1);
+        *j = e;
+      }
+    } else {
+      std::stable_sort(first, last, less);
+    }
+
+    Entry* out = first;
+    for (Entry* i = first + 1; i < last; ++i) {
+      if (i->inner != out->inner) { *++out = *i; continue; }
+
+      switch (combine) {
+        case SUM:  out->value += i->value; break;
+        case LAST: out->value = i->value; break;
+        case MIN:  if (i->value < out->value) out->value = i->value; break;
+        case MAX:  if (out->value < i->value) out->value = i->value; break;
+      }
+    }
+
+    return out - first + 1;
+  }
+
+};
+
+}
+
+#endif
@@ -44,6 +44,13 @@ public:
     return m_graph; 
   }
 
+  /// Parses a graph written in DOT (e.g. by Graph::write_dot)
+  Agraph_t* readGraph(const std::string& dot) {
+    m_graph = agmemread(dot.c_str());
+    if (!m_graph) throw std::runtime_error("Failed to parse DOT graph");
+    return m_graph;
+  }
+
   Agraph_t* resetGraph(const std::string& name, Agdesc_t desc, Agdisc_t* disc = 0) {
     clearGraph();
     return createGraph(name, desc, disc);
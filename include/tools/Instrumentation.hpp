@@ -0,0 +1,137 @@
+#ifndef QAED_INSTRUMENTATION_H
+#define QAED_INSTRUMENTATION_H
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <functional>
+
+namespace qaed {
+
+/// Counters of one algorithm run. Filled only when compiled with
+/// -DQAED_INSTRUMENT, otherwise the hooks expand to nothing.
+struct AlgoStats {
+  const char*   algorithm        = "";
+  std::uint64_t edges_relaxed    = 0;
+  std::uint64_t heap_pushes      = 0;
+  std::uint64_t heap_pops        = 0;
+  std::uint64_t vertexes_visited = 0;
+  std::uint64_t mark_resets      = 0;   // every reset walks all the vertexes
+  double        seconds          = 0;
+
+  /// Wall clock per phase in order of first appearance, repeated
+  /// phases are added up
+  std::vector<std::pair<const char*, double>> phases;
+
+  friend std::ostream& operator<<(std::ostream& os, const AlgoStats& s) {
+    os << s.algorithm << ": " << s.seconds * 1e3 << " ms, relaxed " << s.edges_relaxed
+       << ", heap +" << s.heap_pushes << "/-" << s.heap_pops << ", visited " << s.vertexes_visited
+       << ", mark resets " << s.mark_resets;
+
+    for (auto& p : s.phases)
+      os << "\n  " << p.first << ": " << p.second * 1e3 << " ms";
+    return os;
+  }
+};
+
+using StatsSink = std::function<void (const AlgoStats&)>;
+
+namespace instrument {
+
+using Clock = std::chrono::steady_clock;
+
+struct State {
+  AlgoStats* current = nullptr;
+  AlgoStats  last;
+  StatsSink  sink;
+};
+
+/// Per thread, algorithms running in different threads don't mix
+inline State& state() {
+  static thread_local State s;
+  return s;
+}
+
+/// Called with the stats of every finished run of this thread
+inline void set_sink(StatsSink sink) { state().sink = std::move(sink); }
+
+/// Stats of the last finished run of this thread
+inline const AlgoStats& last() { return state().last; }
+
+inline void add(std::uint64_t AlgoStats::* field, std::uint64_t n) {
+  if (AlgoStats* s = state().current) s->*field += n;
+}
+
+/// Stats of one run. A run started inside another one (the visit_dfs
+/// behind mst_kruskal's cycle checks, the mst graph being filled...)
+/// adds to the outer run instead of reporting on its own.
+class Scope {
+private:
+  AlgoStats         m_stats;
+  bool              m_owner;
+  Clock::time_point m_start;
+
+public:
+  explicit Scope(const char* algorithm) : m_owner(state().current == nullptr), m_start(Clock::now()) {
+    m_stats.algorithm = algorithm;
+    if (m_owner) state().current = &m_stats;
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ ~Scope() {
+    if (!m_owner) return;
+
+    m_stats.seconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+
+    State& s = state();
+    s.current = nullptr;
+    s.last    = std::move(m_stats);
+    if (s.sink) s.sink(s.last);
+  }
+};
+
+/// Times the rest of the enclosing block as a phase of the current run
+class Phase {
+private:
+  const char*       m_name;
+  Clock::time_point m_start;
+
+public:
+  explicit Phase(const char* name) : m_name(name), m_start(Clock::now()) {}
+
+  Phase(const Phase&) = delete;
+  Phase& operator=(const Phase&) = delete;
+
+ ~Phase() {
+    AlgoStats* s = state().current;
+    if (!s) return;
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - m_start).count();
+    for (auto& p : s->phases)
+      if (std::strcmp(p.first, m_name) == 0) { p.second += elapsed; return; }
+    s->phases.emplace_back(m_name, elapsed);
+  }
+};
+
+}
+
+}
+
+#define QAED_CONCAT_(a, b) a##b
+#define QAED_CONCAT(a, b)  QAED_CONCAT_(a, b)
+
+#ifdef QAED_INSTRUMENT
+#define QAED_STATS_SCOPE(name)   ::qaed::instrument::Scope QAED_CONCAT(qaed_scope_, __LINE__)(name)
+#define QAED_STATS_PHASE(name)   ::qaed::instrument::Phase QAED_CONCAT(qaed_phase_, __LINE__)(name)
+#define QAED_STATS_ADD(field, n) ::qaed::instrument::add(&::qaed::AlgoStats::field, (n))
+#else
+#define QAED_STATS_SCOPE(name)   ((void)0)
+#define QAED_STATS_PHASE(name)   ((void)0)
+#define QAED_STATS_ADD(field, n) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef QAED_NODE_POOL_H
+#define QAED_NODE_POOL_H
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace qaed {
+
+/// Allocates nodes of one type out of big slabs instead of one heap
+/// block per node. Freed nodes go to a free list and are reused
+/// first. Slabs double in size up to MAX_SLAB nodes, release() gives
+/// them all back at once.
+template <class Node>
+class NodePool {
+public:
+  static constexpr std::size_t MAX_SLAB = 1 << 16;
+
+private:
+  union Slot {
+    Slot* next;
+    alignas(Node) unsigned char storage[sizeof(Node)];
+  };
+
+  std::vector<std::unique_ptr<Slot[]>> m_slabs;
+  Slot*       m_free;
+  std::size_t m_slab_size;   // of the last slab
+  std::size_t m_slab_used;   // slots of the last slab handed out
+  std::size_t m_live;
+  std::size_t m_first_slab;
+
+public:
+  explicit NodePool(std::size_t first_slab = 64) :
+    m_free(nullptr), m_slab_size(0), m_slab_used(0), m_live(0), m_first_slab(std::max<std::size_t>(1, first_slab)) {}
+
+  NodePool(const NodePool&) = delete;
+  NodePool& operator=(const NodePool&) = delete;
+
+  NodePool(NodePool&& p) noexcept { *this = std::move(p); }
+
+  NodePool& operator=(NodePool&& p) noexcept {
+    m_slabs      = std::move(p.m_slabs);
+    m_free       = p.m_free;
+    m_slab_size  = p.m_slab_size;
+    m_slab_used  = p.m_slab_used;
+    m_live       = p.m_live;
+    m_first_slab = p.m_first_slab;
+
+    p.m_slabs.clear();
+    p.m_free      = nullptr;
+    p.m_slab_size = p.m_slab_used = p.m_live = 0;
+    return *this;
+  }
+
+  /// Nodes created and not destroyed
+  std::size_t size() const { return m_live; }
+
+  template <class... Args>
+  Node* create(Args&&... args) {
+    Slot* s = take();
+    try {
+      Node* n = new (s->storage) Node(std::forward<Args>(args)...);
+      ++m_live;
+      return n;
+    } catch (...) {
+      s->next = m_free;
+      m_free  = s;
+      throw;
+    }
+  }
+
+  void destroy(Node* n) {
+    n->~Node();
+
+    Slot* s = reinterpret_cast<Slot*>(n);
+    s->next = m_free;
+    m_free  = s;
+    --m_live;
+  }
+
+  /// Frees every slab in O(slabs). Nodes still alive are not
+  /// destroyed, the owner does it first when Node needs it.
+  void release() {
+    m_slabs.clear();
+    m_free      = nullptr;
+    m_slab_size = m_slab_used = m_live = 0;
+  }
+
+private:
+
+  Slot* take() {
+    if (m_free) {
+      Slot* s = m_free;
+      m_free  = s->next;
+      return s;
+    }
+
+    if (m_slab_used == m_slab_size) {
+      m_slab_size = m_slabs.empty() ? m_first_slab : std::min(2 * m_slab_size, MAX_SLAB);
+      m_slabs.emplace_back(new Slot[m_slab_size]);
+      m_slab_used = 0;
+    }
+
+    return &m_slabs.back()[m_slab_used++];
+  }
+
+};
+
+}
+
+#endif
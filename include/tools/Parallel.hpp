@@ -0,0 +1,86 @@
+#ifndef QAED_PARALLEL_H
+#define QAED_PARALLEL_H
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <exception>
+
+namespace qaed {
+
+inline unsigned default_threads() {
+  unsigned t = std::thread::hardware_concurrency();
+  return t ? t : 1;
+}
+
+/// Splits [begin, end) in `threads` contiguous chunks and calls
+/// f(chunk_begin, chunk_end, thread_id) on each, chunk 0 runs in the
+/// calling thread. The first exception thrown by any chunk is rethrown.
+template <class Function>
+void parallel_for(std::size_t begin, std::size_t end, unsigned threads, Function&& f) {
+  if (end <= begin) return;
+
+  std::size_t total = end - begin;
+  threads = std::max(1u, std::min<unsigned>(threads, total));
+
+  if (threads == 1) { f(begin, end, 0u); return; }
+
+  std::exception_ptr error;
+  std::mutex         error_mutex;
+
+  auto run = [&](std::size_t b, std::size_t e, unsigned tid) {
+    try { f(b, e, tid); }
+    catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) error = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+
+  for (unsigned tid = 1; tid < threads; ++tid)
+    pool.emplace_back(run, begin + total * tid / threads, begin + total * (tid + 1) / threads, tid);
+
+  run(begin, begin + total / threads, 0);
+
+  for (auto& t : pool) t.join();
+  if (error) std::rethrow_exception(error);
+}
+
+/// Same as parallel_for but chunks hold about the same weight, where
+/// prefix is a prefix sum of weights (items + 1 values), e.g. the row
+/// offsets of a CSR structure to balance by nonzeros
+template <class Offset, class Function>
+void parallel_for_balanced(const Offset* prefix, std::size_t items, unsigned threads, Function&& f) {
+  if (items == 0) return;
+
+  threads = std::max(1u, std::min<unsigned>(threads, items));
+
+  std::vector<std::size_t> cut(threads + 1, items);
+  cut[0] = 0;
+
+  Offset total = prefix[items] - prefix[0];
+  for (unsigned tid = 1; tid < threads; ++tid) {
+    Offset target = prefix[0] + total / threads * tid;
+    cut[tid] = std::lower_bound(prefix, prefix + items, target) - prefix;
+    cut[tid] = std::max(cut[tid], cut[tid - 1]);
+  }
+
+  parallel_for(0, threads, threads, [&](std::size_t b, std::size_t e, unsigned) {
+    for (std::size_t tid = b; tid < e; ++tid)
+      f(cut[tid], cut[tid + 1], static_cast<unsigned>(tid));
+  });
+}
+
+template <class Offset, class Function>
+void parallel_for_balanced(const std::vector<Offset>& prefix, unsigned threads, Function&& f) {
+  if (prefix.size() < 2) return;
+  parallel_for_balanced(prefix.data(), prefix.size() - 1, threads, std::forward<Function>(f));
+}
+
+}
+
+#endif
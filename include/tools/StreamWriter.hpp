@@ -0,0 +1,118 @@
+#ifndef QAED_STREAM_WRITER_H
+#define QAED_STREAM_WRITER_H
+
+#include <string>
+#include <charconv>
+#include <ostream>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+
+namespace qaed {
+
+/// Accumulates output in a fixed size block and hands it to the
+/// stream with one write() per block, values are formatted with
+/// std::to_chars when possible instead of going through operator<<
+class StreamWriter {
+private:
+  std::ostream& m_os;
+  std::string   m_buffer;
+  std::size_t   m_used;
+
+public:
+  explicit StreamWriter(std::ostream& os, std::size_t block = 1 << 16) :
+    m_os(os),
+    m_buffer(block, '\0'),
+    m_used(0) {}
+
+  StreamWriter(const StreamWriter&) = delete;
+  StreamWriter& operator=(const StreamWriter&) = delete;
+
+ ~StreamWriter() { flush(); }
+
+  void flush() {
+    if (m_used) m_os.write(m_buffer.data(), m_used);
+    m_used = 0;
+  }
+
+  StreamWriter& put(char c) {
+    if (m_used == m_buffer.size()) flush();
+    m_buffer[m_used++] = c;
+    return *this;
+  }
+
+  StreamWriter& put(std::string_view s) {
+    if (s.size() > m_buffer.size() - m_used) {
+      flush();
+      if (s.size() > m_buffer.size()) {
+        m_os.write(s.data(), s.size());
+        return *this;
+      }
+    }
+
+    s.copy(m_buffer.data() + m_used, s.size());
+    m_used += s.size();
+    return *this;
+  }
+
+  /// Writes a value, quoted and escaped (valid for DOT and JSON
+  /// strings) when quote = true
+  template <class T>
+  StreamWriter& value(const T& v, bool quote = false) {
+    if constexpr (std::is_same<T, bool>::value) {
+      put(v ? "true" : "false");
+    } else if constexpr (std::is_arithmetic<T>::value && !std::is_same<T, char>::value) {
+      char tmp[32];
+      auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+      if (quote) put('"');
+      put(std::string_view(tmp, r.ptr - tmp));
+      if (quote) put('"');
+    } else if constexpr (std::is_same<T, char>::value) {
+      quoted(std::string_view(&v, 1));
+    } else if constexpr (std::is_convertible<const T&, std::string_view>::value) {
+      quote ? quoted(v) : put(std::string_view(v));
+    } else {
+      std::ostringstream ss;
+      ss << v;
+      quote ? quoted(ss.str()) : put(ss.str());
+    }
+
+    return *this;
+  }
+
+  /// Numbers and booleans as they are, everything else as a string
+  template <class T>
+  StreamWriter& json(const T& v) {
+    return value(v, !std::is_arithmetic<T>::value || std::is_same<T, char>::value);
+  }
+
+  /// JSON escapes, other control characters as \u00XX
+  StreamWriter& quoted(std::string_view s) {
+    put('"');
+    for (char c : s) {
+      switch (c) {
+        case '"':  put("\\\""); break;
+        case '\\': put("\\\\"); break;
+        case '\n': put("\\n");  break;
+        case '\t': put("\\t");  break;
+        case '\r': put("\\r");  break;
+        case '\b': put("\\b");  break;
+        case '\f': put("\\f");  break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            const char hex[] = "0123456789abcdef";
+            const char code[] = { '\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF] };
+            put(std::string_view(code, sizeof(code)));
+          } else {
+            put(c);
+          }
+      }
+    }
+    put('"');
+    return *this;
+  }
+};
+
+}
+
+#endif
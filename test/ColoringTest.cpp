@@ -0,0 +1,45 @@
+#include <iostream>
+
+#include "graph/Coloring.hpp"
+#include "graph/Generators.hpp"
+
+int main() {
+  qaed::Graph<char, int, qaed::UNDIRECTED> g;
+  for (char c = 'a'; c <= 'f'; ++c)
+    g.add_vertex(c);
+
+  // Jobs sharing a resource can't run in the same batch
+  g.add_edge('a', 'b', 1);
+  g.add_edge('a', 'c', 1);
+  g.add_edge('b', 'c', 1);
+  g.add_edge('c', 'd', 1);
+  g.add_edge('d', 'e', 1);
+  g.add_edge('e', 'f', 1);
+  g.add_edge('f', 'd', 1);
+
+  qaed::CSRGraph<char, int> csr(g);
+  auto batches = qaed::color_graph(csr, qaed::SMALLEST_LAST, qaed::SPECULATIVE, 2);
+
+  std::cout << batches.no_colors << " batches:\n";
+  for (std::uint32_t v = 0; v < csr.no_vertexes(); ++v)
+    std::cout << csr.label(v) << " -> " << batches.color[v] << '\n';
+
+  auto list = qaed::generators::rmat<int>(14, 8);
+  std::vector<unsigned> labels(list.no_vertexes);
+  std::iota(labels.begin(), labels.end(), 0);
+  std::vector<qaed::CSRGraph<unsigned, int>::Arc> arcs(list.edges.begin(), list.edges.end());
+  auto big = qaed::CSRGraph<unsigned, int>::from_arcs(labels, arcs, false);
+
+  const char* orders[]  = { "largest first", "smallest last", "random" };
+  const char* methods[] = { "jones-plassmann", "speculative" };
+
+  for (auto method : { qaed::JONES_PLASSMANN, qaed::SPECULATIVE }) {
+    for (auto order : { qaed::LARGEST_FIRST, qaed::SMALLEST_LAST, qaed::RANDOM_ORDER }) {
+      auto c = qaed::color_graph(big, order, method, 4);
+      std::cout << methods[method] << ", " << orders[order] << ": " << c.no_colors << " colors, "
+                << (qaed::is_proper_coloring(big, c) ? "proper" : "NOT proper") << '\n';
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,40 @@
+#include <iostream>
+
+#include "graph/Community.hpp"
+#include "graph/Generators.hpp"
+
+int main() {
+  // Four dense groups of 8 vertexes, joined by a ring of light edges
+  qaed::Graph<int, double, qaed::UNDIRECTED> g;
+  for (int v = 0; v < 32; ++v)
+    g.add_vertex(v);
+
+  for (int c = 0; c < 4; ++c) {
+    for (int a = 0; a < 8; ++a)
+      for (int b = a + 1; b < 8; ++b)
+        g.add_edge(c * 8 + a, c * 8 + b, 1.0);
+
+    g.add_edge(c * 8, ((c + 1) % 4) * 8 + 1, 0.1);
+  }
+
+  qaed::CSRGraph<int, double> csr(g);
+
+  auto louvain = qaed::louvain(csr, 4);
+  std::cout << "Louvain: " << louvain.no_communities << " communities, modularity " << louvain.modularity << '\n';
+  for (std::uint32_t v = 0; v < csr.no_vertexes(); ++v)
+    std::cout << louvain.community[v] << (v + 1 < csr.no_vertexes() ? ' ' : '\n');
+
+  auto lpa = qaed::label_propagation(csr, 4);
+  std::cout << "Label propagation: " << lpa.no_communities << " communities, modularity " << lpa.modularity << '\n';
+
+  auto list = qaed::generators::power_law<double>(20000, 4);
+  qaed::Graph<unsigned, double, qaed::UNDIRECTED> big;
+  list.fill(big);
+  qaed::CSRGraph<unsigned, double> big_csr(big);
+
+  auto big_louvain = qaed::louvain(big_csr, 4);
+  std::cout << "Power law graph louvain: " << big_louvain.no_communities
+            << " communities, modularity " << big_louvain.modularity << '\n';
+
+  return 0;
+}
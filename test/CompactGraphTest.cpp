@@ -0,0 +1,56 @@
+#include <iostream>
+
+#include "graph/CompactGraph.hpp"
+#include "graph/Generators.hpp"
+
+int main() {
+  qaed::Graph<char, int, qaed::UNDIRECTED> g;
+  for (char c = 'a'; c <= 'e'; ++c)
+    g.add_vertex(c);
+
+  g.add_edge('a', 'b', 1);
+  g.add_edge('a', 'c', 2);
+  g.add_edge('b', 'd', 3);
+  g.add_edge('c', 'd', 4);
+  g.add_edge('d', 'e', 5);
+
+  qaed::CompactGraph<char, int, qaed::UNDIRECTED> c(g);
+  c.print();
+
+  c.add_vertex('f');
+  c.add_edge('f', 'a', 6);
+  c.set_tag_edge('d', 'b', 30);
+  c.remove_vertex('c');
+
+  std::cout << "\nAfter adding f, retagging b-d and removing c (" << c.no_vertexes() << " vertexes, "
+            << c.no_edges() << " edges):\n";
+  c.print();
+
+  std::cout << "\nCSR snapshot:\n";
+  c.to_csr().print();
+
+  qaed::CompactGraph<char, int, qaed::DIRECTED> d;
+  for (char x = 'a'; x <= 'd'; ++x)
+    d.add_vertex(x);
+  d.add_edge('a', 'b', 1);
+  d.add_edge('b', 'a', 2);
+  d.add_edge('c', 'a', 3);
+  d.add_edge('b', 'd', 4);
+  d.remove_vertex('a');
+
+  std::cout << "\nDIRECTED without a (" << d.no_edges() << " arcs):\n";
+  d.print();
+
+  auto list = qaed::generators::power_law<int>(200000, 4);
+  qaed::CompactGraph<unsigned, int, qaed::UNDIRECTED> big;
+  for (unsigned v = 0; v < list.no_vertexes; ++v)
+    big.add_vertex(v);
+  for (auto& e : list.edges)
+    big.link(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+  big.shrink_to_fit();
+
+  std::cout << "\nPower law graph, " << big.no_edges() << " edges: " << big.memory_bytes() << " bytes of adjacency, "
+            << double(big.memory_bytes()) / big.no_edges() << " bytes per edge\n";
+
+  return 0;
+}
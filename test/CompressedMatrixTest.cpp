@@ -0,0 +1,64 @@
+#include <chrono>
+#include <random>
+#include <iostream>
+
+#include "CompressedMatrix.hpp"
+
+int main() {
+  qaed::FastMatrix<int, 0> fast(4, 5);
+  fast.add(1, 0, 0);
+  fast.add(2, 0, 3);
+  fast.add(3, 1, 1);
+  fast.add(4, 2, 0);
+  fast.add(5, 2, 4);
+  fast.add(6, 3, 2);
+
+  std::cout << "FastMatrix:\n";
+  fast.printLn();
+
+  qaed::CSRMatrix<int> csr(fast);
+  std::cout << "CSR, " << csr.nnz() << " entries\n  pointers:";
+  for (auto p : csr.pointers()) std::cout << ' ' << p;
+  std::cout << "\n  indices: ";
+  for (auto i : csr.indices()) std::cout << ' ' << i;
+  std::cout << "\n  values:  ";
+  for (auto v : csr.values()) std::cout << ' ' << v;
+
+  auto csc = csr.to_csc();
+  std::cout << "\nCSC pointers:";
+  for (auto p : csc.pointers()) std::cout << ' ' << p;
+
+  std::cout << "\n\nRow 2:";
+  csr.for_each_in_row(2, [](auto c, auto v) { std::cout << " (" << c << ", " << v << ")"; });
+  std::cout << "\nColumn 0:";
+  csc.for_each_in_col(0, [](auto r, auto v) { std::cout << " (" << r << ", " << v << ")"; });
+
+  csr.get(1, 1) = 30;
+  std::cout << "\n\nAfter setting (1, 1) = 30, back to Matrix:\n";
+  csr.to_matrix()->printLn();
+
+  std::cout << "CSC -> CSR round trip " << (csc.to_csr() == qaed::CSRMatrix<int>(fast) ? "ok" : "FAILED") << "\n";
+  std::cout << "CSR -> FastMatrix -> CSR round trip " << (qaed::CSRMatrix<int>(csr.to_fast_matrix<0>()) == csr ? "ok" : "FAILED") << "\n";
+
+  const unsigned long n = 20000;
+  qaed::FastMatrix<long, 0> big(n, n);
+  std::mt19937 rng(5);
+  for (unsigned ii = 0; ii < 400000; ++ii)
+    big.add(1 + long(rng() % 10), rng() % n, rng() % n);
+
+  auto start = std::chrono::steady_clock::now();
+  qaed::CSRMatrix<long> a(big);
+  auto mid = std::chrono::steady_clock::now();
+  auto b = a.to_csc();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << "\n" << n << "x" << n << " with " << a.nnz() << " entries: FastMatrix -> CSR "
+            << std::chrono::duration<double, std::milli>(mid - start).count() << " ms, CSR -> CSC "
+            << std::chrono::duration<double, std::milli>(end - mid).count() << " ms\n";
+
+  qaed::CSRMatrix<double> unit(3, 3, { 0, 1, 2, 3 }, { 0, 1, 2 }, { 1.0, 1.0, 1.0 });
+  std::cout << "\n3x3 identity:\n";
+  unit.printLn();
+
+  return b.nnz() == a.nnz() ? 0 : 1;
+}
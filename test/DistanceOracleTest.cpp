@@ -0,0 +1,52 @@
+#include <chrono>
+#include <memory>
+#include <iostream>
+
+#include "graph/Generators.hpp"
+#include "graph/DistanceOracle.hpp"
+#include "graph/KShortestPaths.hpp"
+
+int main() {
+  auto list = qaed::generators::power_law<int>(20000, 3, 7);
+  std::vector<unsigned> labels(list.no_vertexes);
+  std::iota(labels.begin(), labels.end(), 0);
+  std::vector<qaed::CSRGraph<unsigned, int>::Arc> arcs(list.edges.begin(), list.edges.end());
+  auto g = qaed::CSRGraph<unsigned, int>::from_arcs(labels, arcs, false);
+
+  std::cout << g.no_vertexes() << " vertexes, " << g.no_edges() / 2 << " edges\n";
+
+  for (unsigned k = 3; k <= 5; ++k) {
+    auto start = std::chrono::steady_clock::now();
+    qaed::DistanceOracle<unsigned, int> oracle(g, k, 1, qaed::default_threads(), true);
+    auto built = std::chrono::steady_clock::now();
+
+    volatile long long sink = 0;
+    for (unsigned q = 0; q < 100000; ++q)
+      sink = sink + oracle.distance((q * 7919u) % g.no_vertexes(), (q * 104729u) % g.no_vertexes());
+    auto queried = std::chrono::steady_clock::now();
+
+    auto report = qaed::measure_stretch(g, oracle, 8, 200);
+
+    std::cout << "k = " << k << " (bound " << oracle.stretch_bound() << "): "
+              << oracle.bunch_entries() << " bunch entries, " << oracle.size_bytes() / 1024 << " KiB, built in "
+              << std::chrono::duration<double, std::milli>(built - start).count() << " ms, "
+              << std::chrono::duration<double, std::nano>(queried - built).count() / 100000 << " ns per query\n"
+              << "  stretch over " << report.pairs << " pairs: mean " << report.mean << ", max " << report.max
+              << "; spanner keeps " << oracle.spanner_arcs().size() << " edges\n";
+  }
+
+  auto sparse = qaed::spanner(g, 3);
+
+  // Exact distances on the spanner, one reverse Dijkstra per source
+  std::unique_ptr<qaed::PathFinder<unsigned, int>> finder;
+  auto on_spanner = [&](unsigned u, unsigned v) {
+    if (!finder || finder->to_target(u) != 0) finder.reset(new qaed::PathFinder<unsigned, int>(sparse, u));
+    return finder->to_target(v);
+  };
+
+  auto report = qaed::measure_stretch(g, on_spanner, 4, 200);
+  std::cout << "3-spanner: " << sparse.no_edges() / 2 << " edges, measured stretch mean " << report.mean
+            << ", max " << report.max << '\n';
+
+  return 0;
+}
@@ -1,5 +1,6 @@
 #include <memory>
 #include <chrono>
+#include <random>
 
 #include "Graph.hpp"
 
@@ -140,6 +141,45 @@ int main() {
   auto g5_mst = g5.mst_kruskal();
   std::cout << "MST for g5:\n";
   g5_mst.print();
+
+  std::cout << "g4 as DOT:\n";
+  g4.write_dot(std::cout);
+
+  std::cout << "g2 as JSON:\n";
+  g2.write_json(std::cout);
+
+  qaed::GraphDelta<char, int> batch;
+  batch.add_vertex('g')
+       .add_edge('g', 'a', 3)
+       .remove_edge('c', 'e')
+       .set_tag_edge('a', 'b', 9)
+       .remove_vertex('f');
+
+  auto log = g4.apply(batch);
+  std::cout << "\nBatch applied to g4, change log:\n" << log;
+  g4.print();
+
+  g4.apply(log.inverse());
+  std::cout << "Undone:\n";
+  g4.print();
+
+  qaed::Graph<int, int, qaed::UNDIRECTED> big1, big2;
+  qaed::GraphDelta<int, int> delta;
+  for (int v = 0; v < 20000; ++v) { big1.add_vertex(v); big2.add_vertex(v); }
+  std::mt19937 rng(1);
+  for (int ii = 0; ii < 100000; ++ii)
+    delta.add_edge(rng() % 20000, rng() % 20000, ii % 10);
+
+  start = clock();
+  for (auto& c : delta) big1.add_edge(c.from, c.to, c.tag);
+  end = clock();
+  std::cout << "100k add_edge calls: " << 1000.0 * (end - start) / CLOCKS_PER_SEC << " ms\n";
+
+  start = clock();
+  big2.apply(delta);
+  end = clock();
+  std::cout << "100k edges batch: " << 1000.0 * (end - start) / CLOCKS_PER_SEC << " ms, "
+            << big2.no_edges() << " edges\n";
   
   return 0;
 }
@@ -0,0 +1,34 @@
+// Instrumentation is compiled out unless QAED_INSTRUMENT is defined
+#define QAED_INSTRUMENT
+
+#include <random>
+#include <iostream>
+
+#include "Graph.hpp"
+
+int main() {
+  qaed::Graph<int, int, qaed::UNDIRECTED> g;
+
+  std::mt19937 rng(3);
+  for (int v = 0; v < 300; ++v)
+    g.add_vertex(v);
+  for (int ii = 0; ii < 1500; ++ii)
+    g.add_edge(int(rng() % 300), int(rng() % 300), int(1 + rng() % 100));
+
+  g.dijkstra_from(0);
+  std::cout << qaed::instrument::last() << "\n\n";
+
+  // Every run reported through a sink, e.g. to a log when over budget
+  qaed::instrument::set_sink([](const qaed::AlgoStats& s) {
+    if (s.seconds > 0.001) std::cout << "over budget, " << s << "\n\n";
+  });
+
+  g.mst_prim();
+  g.mst_kruskal();
+
+  std::size_t visited = 0;
+  g.visit_bfs([&](auto&) { ++visited; });
+  std::cout << "visit_bfs reached " << visited << ": " << qaed::instrument::last() << "\n";
+
+  return 0;
+}
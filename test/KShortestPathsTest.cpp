@@ -0,0 +1,45 @@
+#include <chrono>
+#include <iostream>
+
+#include "graph/Generators.hpp"
+#include "graph/KShortestPaths.hpp"
+
+int main() {
+  qaed::Graph<char, int, qaed::DIRECTED> g;
+  for (char c = 'c'; c <= 'h'; ++c)
+    g.add_vertex(c);
+
+  g.add_edge('c', 'd', 3);
+  g.add_edge('c', 'e', 2);
+  g.add_edge('d', 'f', 4);
+  g.add_edge('e', 'd', 1);
+  g.add_edge('e', 'f', 2);
+  g.add_edge('e', 'g', 3);
+  g.add_edge('f', 'g', 2);
+  g.add_edge('f', 'h', 1);
+  g.add_edge('g', 'h', 2);
+
+  qaed::CSRGraph<char, int> csr(g);
+
+  std::cout << "3 shortest paths c -> h:\n";
+  for (auto& p : qaed::k_shortest_paths(csr, csr.id_of('c'), csr.id_of('h'), 3)) {
+    for (auto v : p.vertexes) std::cout << csr.label(v) << ' ';
+    std::cout << "(cost " << p.cost << ")\n";
+  }
+
+  auto list = qaed::generators::grid<int>(300, 300);
+  qaed::Graph<unsigned, int, qaed::UNDIRECTED> city;
+  list.fill(city);
+  qaed::CSRGraph<unsigned, int> city_csr(city);
+
+  auto start = std::chrono::steady_clock::now();
+  auto paths = qaed::k_shortest_paths(city_csr, 0u, 300u * 300u - 1, 10, std::chrono::milliseconds(500));
+  auto end   = std::chrono::steady_clock::now();
+
+  std::cout << paths.size() << " paths on a 300x300 grid in "
+            << std::chrono::duration<double, std::milli>(end - start).count() << " ms, costs:";
+  for (auto& p : paths) std::cout << ' ' << p.cost;
+  std::cout << '\n';
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <iostream>
+
+#include "sparse/Krylov.hpp"
+#include "sparse/TripletBuilder.hpp"
+
+/// 5 point finite differences on a k x k grid, -laplace(u) + c du/dx.
+/// c = 0 gives the symmetric positive definite Poisson matrix.
+qaed::CSRMatrix<double> grid(std::uint32_t k, double c) {
+  qaed::TripletBuilder<double> t(k * k, k * k);
+  for (std::uint32_t i = 0; i < k; ++i)
+    for (std::uint32_t j = 0; j < k; ++j) {
+      std::uint32_t p = i * k + j;
+      t.add(p, p, 4);
+      if (j > 0)     t.add(p, p - 1, -1 - c);
+      if (j + 1 < k) t.add(p, p + 1, -1 + c);
+      if (i > 0)     t.add(p, p - k, -1);
+      if (i + 1 < k) t.add(p, p + k, -1);
+    }
+  return t.to_csr();
+}
+
+/// True relative residual ||b - A x|| / ||b||
+double check(const qaed::CSRMatrix<double>& a, const std::vector<double>& b, const std::vector<double>& x) {
+  std::vector<double> r = b;
+  qaed::spmv(a, x.data(), r.data(), -1.0, 1.0);
+  return std::sqrt(qaed::sparse::dot(r.data(), r.data(), r.size(), 1) / qaed::sparse::dot(b.data(), b.data(), b.size(), 1));
+}
+
+template <class Solve>
+void run(const char* name, const qaed::CSRMatrix<double>& a, const std::vector<double>& b, Solve&& solve) {
+  std::vector<double> x(b.size(), 0.0);
+  auto start = std::chrono::steady_clock::now();
+  qaed::SolverResult result = solve(x);
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << name << ": " << result << ", true residual " << check(a, b, x) << ", " << ms << " ms\n";
+}
+
+int main() {
+  // Small system with the iterations shown
+  qaed::CSRMatrix<double> small = grid(3, 0);
+  std::vector<double> sb(9, 1.0), sx;
+
+  qaed::SolverOptions verbose;
+  verbose.monitor = [](std::size_t it, double res) { std::cout << "  cg " << it << ": " << res << "\n"; };
+  std::cout << qaed::cg(small, sb, sx, qaed::IdentityPreconditioner(), verbose) << "\nx =";
+  for (double v : sx) std::cout << ' ' << v;
+  std::cout << "\n\n";
+
+  // 300 x 300 Poisson, 90000 unknowns
+  qaed::CSRMatrix<double> poisson = grid(300, 0);
+  std::vector<double> b(poisson.no_rows(), 1.0);
+
+  qaed::SolverOptions options;
+  options.max_iterations = 5000;
+
+  qaed::JacobiPreconditioner<double> jacobi(poisson);
+  qaed::ILU0Preconditioner<double>   ilu(poisson);
+
+  run("cg",            poisson, b, [&](std::vector<double>& x) { return qaed::cg(poisson, b, x, qaed::IdentityPreconditioner(), options); });
+  run("cg + jacobi",   poisson, b, [&](std::vector<double>& x) { return qaed::cg(poisson, b, x, jacobi, options); });
+  run("cg + ilu0",     poisson, b, [&](std::vector<double>& x) { return qaed::cg(poisson, b, x, ilu, options); });
+
+  qaed::SolverOptions serial = options;
+  serial.threads = 1;
+  run("cg, 1 thread",  poisson, b, [&](std::vector<double>& x) { return qaed::cg(poisson, b, x, qaed::IdentityPreconditioner(), serial); });
+
+  // Convection makes it nonsymmetric
+  qaed::CSRMatrix<double> convection = grid(300, 0.4);
+  qaed::ILU0Preconditioner<double> cilu(convection);
+
+  run("bicgstab",        convection, b, [&](std::vector<double>& x) { return qaed::bicgstab(convection, b, x, qaed::IdentityPreconditioner(), options); });
+  run("bicgstab + ilu0", convection, b, [&](std::vector<double>& x) { return qaed::bicgstab(convection, b, x, cilu, options); });
+  run("gmres(30)",       convection, b, [&](std::vector<double>& x) { return qaed::gmres(convection, b, x, qaed::IdentityPreconditioner(), options); });
+  run("gmres(30) + ilu0", convection, b, [&](std::vector<double>& x) { return qaed::gmres(convection, b, x, cilu, options); });
+
+  try {
+    qaed::ILU0Preconditioner<double> broken(qaed::CSRMatrix<double>(2, 2, { 0, 1, 1 }, { 1 }, { 1.0 }));
+  } catch (const std::runtime_error& e) {
+    std::cout << e.what() << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "sparse/MappedMatrix.hpp"
+
+template <class Function>
+double time_ms(Function&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+  // 3x4 matrix
+  // 1 0 2 0
+  // 0 3 0 0
+  // 4 0 5 6
+  qaed::CSRMatrix<double> a(3, 4, { 0, 2, 3, 6 }, { 0, 2, 1, 0, 2, 3 }, { 1, 2, 3, 4, 5, 6 });
+  qaed::write_mapped(a, "small.qcsr");
+
+  qaed::MappedMatrix<double> m("small.qcsr");
+  std::cout << m.no_rows() << "x" << m.no_cols() << ", " << m.nnz() << " entries\n";
+  m.for_each([](std::size_t r, std::size_t c, double v) { std::cout << "(" << r << ", " << c << ") = " << v << "\n"; });
+  std::cout << "at(2, 3) = " << m.get(2, 3) << ", at(1, 0) = " << m.at(1, 0, -1.0) << "\n";
+
+  std::vector<double> x = { 1, 1, 1, 1 };
+  std::cout << "A x   =";
+  for (double v : qaed::spmv(m, x)) std::cout << ' ' << v;
+
+  std::vector<double> u = { 1, 2, 3 }, t(4);
+  qaed::spmv_transposed(m, u.data(), t.data());
+  std::cout << "\nA^T u =";
+  for (double v : t) std::cout << ' ' << v;
+  std::cout << "\ncopy equal: " << (m.to_csr() == a) << "\n";
+
+  try {
+    qaed::MappedMatrix<float> wrong("small.qcsr");
+  } catch (const std::runtime_error& e) {
+    std::cout << "float view: " << e.what() << "\n";
+  }
+
+  // Row 1 ending past nnz, ptr[0] and ptr[rows] still right
+  {
+    qaed::mapped::Header h;
+    std::fstream f("small.qcsr", std::ios::in | std::ios::out | std::ios::binary);
+    f.read(reinterpret_cast<char*>(&h), sizeof(h));
+    std::size_t bad = 100;
+    f.seekp(h.ptr_at + 2 * sizeof(std::size_t));
+    f.write(reinterpret_cast<const char*>(&bad), sizeof(bad));
+  }
+  try {
+    qaed::MappedMatrix<double> corrupt("small.qcsr");
+  } catch (const std::runtime_error& e) {
+    std::cout << "corrupt row pointers: " << e.what() << "\n";
+  }
+
+  // Random 1M x 1M matrix with about 16 entries per row
+  const std::uint32_t n = 1000000;
+  std::mt19937 rng(5);
+  std::vector<std::size_t>   ptr(1, 0);
+  std::vector<std::uint32_t> idx;
+  std::vector<double>        val;
+
+  for (std::uint32_t r = 0; r < n; ++r) {
+    std::size_t first = idx.size();
+    for (int k = 0; k < 16; ++k) idx.push_back(rng() % n);
+
+    std::sort(idx.begin() + first, idx.end());
+    idx.erase(std::unique(idx.begin() + first, idx.end()), idx.end());
+    val.resize(idx.size(), 0.25);
+    ptr.push_back(idx.size());
+  }
+
+  qaed::CSRMatrix<double> big(n, n, std::move(ptr), std::move(idx), std::move(val));
+  std::cout << "\nwrite " << time_ms([&] { qaed::write_mapped(big, "big.qcsr"); }) << " ms\n";
+
+  qaed::CSRMatrix<double> loaded;
+  std::cout << "map + spmv vs copy + spmv\n";
+
+  std::vector<double> bx(n, 1.0), by(n), bz(n);
+  double mapped = time_ms([&] {
+    qaed::MappedMatrix<double> mm("big.qcsr");
+    qaed::spmv(mm, bx.data(), by.data());
+  });
+  double copied = time_ms([&] {
+    qaed::MappedMatrix<double> mm("big.qcsr");
+    loaded = mm.to_csr();
+    qaed::spmv(loaded, bx.data(), bz.data());
+  });
+
+  std::cout << "  mapped " << mapped << " ms, copied " << copied << " ms, same result: " << (by == bz) << "\n";
+
+  std::remove("small.qcsr");
+  std::remove("big.qcsr");
+  return 0;
+}
@@ -0,0 +1,49 @@
+#include <string>
+#include <iostream>
+
+#include "graph/Matching.hpp"
+
+int main() {
+  qaed::Graph<std::string, int, qaed::UNDIRECTED> g;
+
+  for (auto& w : {"ana", "bob", "cid", "dan"})
+    g.add_vertex(w);
+
+  for (auto& j : {"job1", "job2", "job3", "job4"})
+    g.add_vertex(j);
+
+  g.add_edge("ana", "job1", 4);
+  g.add_edge("ana", "job2", 1);
+  g.add_edge("bob", "job1", 2);
+  g.add_edge("cid", "job2", 3);
+  g.add_edge("cid", "job3", 5);
+  g.add_edge("dan", "job3", 1);
+  g.add_edge("dan", "job4", 9);
+
+  qaed::CSRGraph<std::string, int> csr(g);
+  std::cout << "CSR snapshot:\n";
+  csr.print();
+
+  auto is_worker = [](const std::string& s) { return s.compare(0, 3, "job") != 0; };
+
+  std::vector<bool> left(csr.no_vertexes());
+  for (std::uint32_t v = 0; v < csr.no_vertexes(); ++v)
+    left[v] = is_worker(csr.label(v));
+
+  auto m = qaed::hopcroft_karp(csr, left);
+  std::cout << "Hopcroft-Karp matching size: " << m.size << '\n';
+  for (auto& p : m.pairs(csr, left))
+    std::cout << p.first << " - " << p.second << '\n';
+
+  auto a = qaed::assignment(csr, left);
+  std::cout << "Min cost assignment (" << a.size << " pairs, cost " << a.weight << "):\n";
+  for (auto& p : a.pairs(csr, left))
+    std::cout << p.first << " - " << p.second << '\n';
+
+  auto b = qaed::assignment(csr, left, true);
+  std::cout << "Max weight assignment (" << b.size << " pairs, weight " << b.weight << "):\n";
+  for (auto& p : b.pairs(csr, left))
+    std::cout << p.first << " - " << p.second << '\n';
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <iostream>
+
+#include "SparseMatrix.hpp"
+#include "sparse/MatrixMarket.hpp"
+
+template <class Function>
+double time_ms(Function&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+  // Unsorted triplets with two repeats at (0, 1) and one at (2, 0)
+  qaed::TripletBuilder<double> triplets(3, 3);
+  triplets.add(2, 2, 5);
+  triplets.add(0, 1, 1);
+  triplets.add(2, 0, 4);
+  triplets.add(0, 1, 7);
+  triplets.add(1, 1, 3);
+  triplets.add(2, 0, -2);
+  triplets.add(0, 1, 2);
+
+  std::cout << "sum\n";  triplets.to_csr(qaed::SUM).printLn();
+  std::cout << "last\n"; triplets.to_csr(qaed::LAST).printLn();
+  std::cout << "min\n";  triplets.to_csr(qaed::MIN).printLn();
+  std::cout << "max as CSC\n"; triplets.to_csc(qaed::MAX).printLn();
+
+  std::ostringstream out;
+  qaed::write_matrix_market(triplets.to_csr(), out);
+  std::cout << out.str();
+
+  std::istringstream in(out.str());
+  std::cout << "read back equal: " << (qaed::read_matrix_market<double>(in) == triplets.to_csr()) << "\n\n";
+
+  // Symmetric file, the upper half is mirrored on reading
+  std::istringstream sym(
+    "%%MatrixMarket matrix coordinate integer symmetric\n"
+    "% lower triangle only\n"
+    "3 3 5\n"
+    "1 1 2\n"
+    "2 1 -1\n"
+    "2 2 2\n"
+    "3 2 -1\n"
+    "3 3 2\n");
+  qaed::read_matrix_market<int>(sym).printLn();
+
+  // Dense array file, zeros are dropped
+  std::istringstream dense(
+    "%%MatrixMarket matrix array real general\n"
+    "2 3\n"
+    "1.5\n0\n0\n2.5\n-1e1\n0\n");
+  qaed::read_matrix_market<double>(dense).printLn();
+
+  try {
+    std::istringstream broken("%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n3 1 1.0\n");
+    qaed::read_matrix_market<double>(broken);
+  } catch (const std::runtime_error& e) {
+    std::cout << e.what() << "\n";
+  }
+
+  // Assembly of 1M random triplets (about a quarter repeated) against
+  // one FastMatrix::add per entry
+  const std::uint32_t n = 200000;
+  const std::size_t   m = 1000000;
+  std::mt19937 rng(3);
+  std::vector<std::uint32_t> rows(m), cols(m);
+  std::vector<int>           vals(m, 1);
+  for (std::size_t k = 0; k < m; ++k) { rows[k] = rng() % n; cols[k] = rng() % (n / 16); }
+
+  qaed::TripletBuilder<int> big(n, n);
+  qaed::CSRMatrix<int> csr;
+  double built = time_ms([&] {
+    big.add(rows.data(), cols.data(), vals.data(), m);
+    csr = big.to_csr();
+  });
+
+  qaed::FastMatrix<int, 0, std::size_t> fast(n, n);
+  double added = time_ms([&] {
+    for (std::size_t k = 0; k < m; ++k) {
+      if (fast.find(rows[k], cols[k])) ++fast.get(rows[k], cols[k]);
+      else                             fast.add(1, rows[k], cols[k]);
+    }
+  });
+
+  std::cout << "\n" << m << " triplets, " << csr.nnz() << " entries: builder " << built
+            << " ms, FastMatrix::add " << added << " ms, same matrix: " << (qaed::CSRMatrix<int>(fast) == csr) << "\n";
+  return 0;
+}
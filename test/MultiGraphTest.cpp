@@ -0,0 +1,64 @@
+#include <chrono>
+#include <random>
+#include <iostream>
+
+#include "graph/MultiGraph.hpp"
+#include "graph/KShortestPaths.hpp"
+
+int main() {
+  // Flights between airports, several per route
+  qaed::MultiGraph<std::string, int, qaed::DIRECTED> g;
+  for (auto s : { "BCN", "CDG", "JFK", "LHR" })
+    g.add_vertex(s);
+
+  g.add_edge("BCN", "CDG", 120);
+  g.add_edge("BCN", "CDG", 95);
+  g.add_edge("BCN", "LHR", 150);
+  auto late = g.add_edge("CDG", "JFK", 510);
+  g.add_edge("CDG", "JFK", 480);
+  g.add_edge("LHR", "JFK", 470);
+  g.add_edge("BCN", "CDG", 110);
+  g.print();
+
+  auto bcn = g.id_of("BCN"), cdg = g.id_of("CDG");
+  std::cout << "\nBCN -> CDG has " << g.multiplicity(bcn, cdg) << " flights:";
+  for (auto e = g.parallel_edges(bcn, cdg).first; e != g.parallel_edges(bcn, cdg).second; ++e)
+    std::cout << " #" << *e << " (" << g.edge(*e).tag << ")";
+
+  g.remove_edge(late);
+  std::cout << "\n\nWithout #" << late << ", shortest flight per route:\n";
+  g.min_view().print();
+
+  std::cout << "\nTotal minutes per route:\n";
+  g.sum_view().print();
+
+  auto shortest = qaed::k_shortest_paths(g.min_view(), bcn, g.id_of("JFK"), 2);
+  std::cout << "\nTwo fastest BCN -> JFK itineraries:";
+  for (auto& p : shortest) std::cout << " " << p.cost;
+  std::cout << "\n";
+
+  // Call records between 100k numbers, a pair calls many times
+  const unsigned n = 100000;
+  qaed::MultiGraph<unsigned, int, qaed::UNDIRECTED> calls;
+  for (unsigned v = 0; v < n; ++v)
+    calls.add_vertex(v);
+
+  std::mt19937 rng(7);
+  std::vector<qaed::MultiGraph<unsigned, int, qaed::UNDIRECTED>::Record> records;
+  for (unsigned ii = 0; ii < 2000000; ++ii) {
+    unsigned a = rng() % n, b = (a + 1 + rng() % 50) % n;
+    records.emplace_back(a, b, int(1 + rng() % 600));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  calls.add_edges(records);
+  auto mid = std::chrono::steady_clock::now();
+  auto talk = calls.sum_view();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << "\n2M call records: bulk insert " << std::chrono::duration<double, std::milli>(mid - start).count()
+            << " ms, " << calls.no_edges() << " calls over " << talk.no_edges() / 2 << " pairs, sum view "
+            << std::chrono::duration<double, std::milli>(end - mid).count() << " ms\n";
+
+  return 0;
+}
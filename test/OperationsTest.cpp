@@ -0,0 +1,57 @@
+#include <chrono>
+#include <random>
+#include <iostream>
+
+#include "sparse/Operations.hpp"
+#include "sparse/TripletBuilder.hpp"
+
+template <class Function>
+double time_ms(Function&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+  // 1 0 2      0 1 0
+  // 0 3 0      4 0 0
+  qaed::CSRMatrix<int> a(2, 3, { 0, 2, 3 }, { 0, 2, 1 }, { 1, 2, 3 });
+  qaed::CSRMatrix<int> b(2, 3, { 0, 1, 2 }, { 1, 0 }, { 1, 4 });
+
+  std::cout << "A^T\n";     qaed::transpose(a).printLn();
+  std::cout << "A + B\n";   qaed::add(a, b).printLn();
+  std::cout << "A - B\n";   qaed::subtract(a, b).printLn();
+  std::cout << "A .* B\n";  qaed::hadamard(a, a).printLn();
+
+  qaed::scale(a, 10);
+  std::cout << "10 A\n"; a.printLn();
+
+  std::cout << "row sums:";
+  for (int v : qaed::row_sums(a)) std::cout << ' ' << v;
+  std::cout << "\ncol sums:";
+  for (int v : qaed::col_sums(a)) std::cout << ' ' << v;
+  std::cout << "\n\n";
+
+  // 1M x 1M with 8M entries
+  const std::uint32_t n = 1000000;
+  std::mt19937 rng(8);
+  auto random_matrix = [&] {
+    qaed::TripletBuilder<double> t(n, n);
+    t.reserve(8 * n);
+    for (std::size_t k = 0; k < 8 * std::size_t(n); ++k) t.add(rng() % n, rng() % n, 1.0);
+    return t.to_csr();
+  };
+  auto x = random_matrix(), y = random_matrix();
+
+  qaed::CSRMatrix<double> t, s, h;
+  double transposed = time_ms([&] { t = qaed::transpose(x); });
+  double converted  = time_ms([&] { x.to_csc(); });
+  double added      = time_ms([&] { s = qaed::add(x, y); });
+  double product    = time_ms([&] { h = qaed::hadamard(x, y); });
+
+  std::cout << x.nnz() << " entries: transpose " << transposed << " ms (serial to_csc " << converted
+            << " ms), add " << added << " ms (" << s.nnz() << " entries), hadamard " << product
+            << " ms (" << h.nnz() << " entries)\n";
+  std::cout << "transpose twice gives A back: " << (qaed::transpose(t) == x) << "\n";
+  return 0;
+}
@@ -0,0 +1,64 @@
+#include <string>
+#include <iostream>
+
+#include "graph/RandomWalk.hpp"
+#include "graph/Generators.hpp"
+
+void print_walks(const std::vector<std::uint32_t>& w, unsigned length) {
+  for (std::size_t ii = 0; ii < w.size(); ++ii) {
+    if (w[ii] == qaed::RandomWalker<int, int>::NONE) std::cout << '-';
+    else                                             std::cout << w[ii];
+    std::cout << ((ii + 1) % length ? ' ' : '\n');
+  }
+}
+
+int main() {
+  qaed::Graph<int, int, qaed::DIRECTED> g;
+  for (int v = 0; v < 6; ++v)
+    g.add_vertex(v);
+
+  g.add_edge(0, 1, 1);
+  g.add_edge(0, 2, 9);
+  g.add_edge(1, 2, 1);
+  g.add_edge(2, 0, 1);
+  g.add_edge(2, 3, 1);
+  g.add_edge(3, 4, 1);
+
+  qaed::CSRGraph<int, int> csr(g);
+  std::vector<std::uint32_t> starts = { 0, 0, 1, 5 };
+
+  std::cout << "Uniform walks:\n";
+  qaed::RandomWalker<int, int> uniform(csr, false, 2);
+  print_walks(uniform.walks(starts, 6), 6);
+
+  std::cout << "Weighted walks:\n";
+  qaed::RandomWalker<int, int> weighted(csr, true, 2);
+  print_walks(weighted.walks(starts, 6), 6);
+
+  std::cout << "node2vec walks (p = 4, q = 0.25):\n";
+  print_walks(weighted.node2vec_walks(starts, 6, 4, 0.25), 6);
+
+  // Uniform walks don't need numeric tags
+  std::vector<qaed::CSRGraph<int, std::string>::Arc> named = { { 0, 1, "a" }, { 1, 2, "b" }, { 2, 0, "c" } };
+  auto labelled = qaed::CSRGraph<int, std::string>::from_arcs({ 0, 1, 2 }, named, true);
+  qaed::RandomWalker<int, std::string> plain(labelled);
+  std::cout << "Uniform walk on string tags:\n";
+  print_walks(plain.walks({ 0 }, 5), 5);
+  try {
+    qaed::RandomWalker<int, std::string> bad(labelled, true);
+  } catch (const std::invalid_argument& e) {
+    std::cout << "weighted: " << e.what() << "\n";
+  }
+
+  auto list = qaed::generators::power_law<int>(1000, 4);
+  qaed::Graph<unsigned, int, qaed::UNDIRECTED> big;
+  list.fill(big);
+  qaed::CSRGraph<unsigned, int> big_csr(big);
+
+  qaed::RandomWalker<unsigned, int> sampler(big_csr);
+  auto s = sampler.sample_neighbours({ 0, 1 }, { 5, 3 });
+  std::cout << "2-hop sample from {0, 1}: " << s.hop_offsets[1] << " + "
+            << s.hop_offsets[2] - s.hop_offsets[1] << " arcs\n";
+
+  return 0;
+}
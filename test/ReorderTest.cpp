@@ -0,0 +1,53 @@
+#include <random>
+#include <iostream>
+
+#include "graph/Reorder.hpp"
+#include "graph/Generators.hpp"
+
+int main() {
+  // Grid with shuffled ids, the worst case for locality
+  auto list = qaed::generators::grid<int>(64, 64);
+
+  std::vector<std::uint32_t> shuffle(list.no_vertexes);
+  std::iota(shuffle.begin(), shuffle.end(), 0);
+  std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937_64(7));
+
+  std::vector<qaed::CSRGraph<unsigned, int>::Arc> arcs;
+  for (auto& e : list.edges)
+    arcs.emplace_back(shuffle[std::get<0>(e)], shuffle[std::get<1>(e)], std::get<2>(e));
+
+  std::vector<unsigned> labels(list.no_vertexes);
+  std::iota(labels.begin(), labels.end(), 0);
+
+  auto g = qaed::CSRGraph<unsigned, int>::from_arcs(labels, arcs, false);
+
+  const char* names[] = { "bfs", "rcm", "degree", "partition" };
+  for (auto how : { qaed::BFS_ORDER, qaed::RCM_ORDER, qaed::DEGREE_ORDER, qaed::PARTITION_ORDER }) {
+    auto r = qaed::reorder_graph(g, how, 256);
+    std::cout << names[how] << ": avg neighbour distance "
+              << r.before.avg_nbr_distance << " -> " << r.after.avg_nbr_distance
+              << ", edge cut " << r.before.edge_cut << " -> " << r.after.edge_cut << '\n';
+  }
+
+  // Directed: 3 -> 0 -> 1 -> 2, 4 -> 1, 5 -> 3, 6 alone. Arcs from later
+  // components lead into vertexes placed before, rcm must still give a
+  // permutation (permuted() throws otherwise)
+  std::vector<qaed::CSRGraph<unsigned, int>::Arc> directed_arcs = {
+    { 3, 0, 1 }, { 0, 1, 1 }, { 1, 2, 1 }, { 4, 1, 1 }, { 5, 3, 1 } };
+  auto d = qaed::CSRGraph<unsigned, int>::from_arcs({ 0, 1, 2, 3, 4, 5, 6 }, directed_arcs, true);
+  auto drcm = qaed::reorder::rcm(d);
+  std::cout << "directed rcm:";
+  for (auto id : drcm) std::cout << ' ' << id;
+  std::cout << ", " << d.permuted(drcm).no_edges() << " arcs kept\n";
+
+  try {
+    d.permuted({ 0, 6, 0, 0, 5, 0, 4 });
+  } catch (const std::invalid_argument& e) {
+    std::cout << "bad permutation: " << e.what() << '\n';
+  }
+
+  auto parts = qaed::reorder::label_propagation(g, 256);
+  std::cout << "label propagation edge cut: " << qaed::edge_cut(g, parts) << " of " << g.no_edges() << '\n';
+
+  return 0;
+}
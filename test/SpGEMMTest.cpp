@@ -0,0 +1,50 @@
+#include <chrono>
+#include <iostream>
+
+#include "sparse/SpGEMM.hpp"
+#include "graph/CSRGraph.hpp"
+#include "graph/Generators.hpp"
+
+int main() {
+  qaed::FastMatrix<int, 0> a(3, 3), b(3, 2);
+  a.add(1, 0, 0);
+  a.add(2, 0, 2);
+  a.add(3, 1, 1);
+  a.add(4, 2, 0);
+  b.add(1, 0, 0);
+  b.add(2, 1, 1);
+  b.add(3, 2, 0);
+  b.add(4, 2, 1);
+
+  std::cout << "A:\n";
+  a.printLn();
+  std::cout << "B:\n";
+  b.printLn();
+
+  auto c = qaed::multiply(a, b);
+  std::cout << "A B (" << c.nnz() << " entries):\n";
+  c.printLn();
+
+  auto cc = qaed::multiply(qaed::CSRMatrix<int>(a).to_csc(), qaed::CSRMatrix<int>(b).to_csc());
+  std::cout << "Same product in CSC " << (cc.to_csr() == c ? "ok" : "FAILED") << "\n";
+
+  // Two hop paths of a power law graph, (A^2)[u][v] counts the u -> w -> v walks
+  auto list = qaed::generators::power_law<int>(50000, 4);
+  for (auto& e : list.edges) std::get<2>(e) = 1;
+
+  std::vector<std::uint32_t> labels(list.no_vertexes);
+  for (std::uint32_t v = 0; v < list.no_vertexes; ++v) labels[v] = v;
+
+  auto g = qaed::CSRGraph<std::uint32_t, int>::from_arcs(labels, list.edges, false);
+  qaed::CSRMatrix<int> adj(g.no_vertexes(), g.no_vertexes(), g.offsets(), g.targets(), g.tags());
+
+  auto start = std::chrono::steady_clock::now();
+  auto two_hop = qaed::multiply(adj, adj);
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << "\nPower law graph with " << adj.nnz() << " arcs, A^2 has " << two_hop.nnz() << " entries, "
+            << std::chrono::duration<double, std::milli>(end - start).count() << " ms with "
+            << qaed::default_threads() << " threads\n";
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <random>
+#include <iostream>
+
+#include "sparse/SpMV.hpp"
+
+template <class Function>
+double time_ms(Function&& f, int reps) {
+  auto start = std::chrono::steady_clock::now();
+  for (int ii = 0; ii < reps; ++ii) f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / reps;
+}
+
+int main() {
+  // 3x4 matrix
+  // 1 0 2 0
+  // 0 3 0 0
+  // 4 0 5 6
+  qaed::CSRMatrix<double> a(3, 4, { 0, 2, 3, 6 }, { 0, 2, 1, 0, 2, 3 }, { 1, 2, 3, 4, 5, 6 });
+  a.printLn();
+
+  std::vector<double> x = { 1, 1, 1, 1 };
+  std::cout << "A x          =";
+  for (double v : qaed::spmv(a, x)) std::cout << ' ' << v;
+
+  std::vector<double> u = { 1, 2, 3 };
+  std::cout << "\nA^T u        =";
+  for (double v : qaed::spmv_transposed(a, u)) std::cout << ' ' << v;
+
+  std::vector<double> y = { 1, 1, 1 };
+  qaed::spmv(a, x.data(), y.data(), 2.0, -1.0);
+  std::cout << "\n2 A x - y    =";
+  for (double v : y) std::cout << ' ' << v;
+
+  auto csc = a.to_csc();
+  std::cout << "\nCSC A x      =";
+  for (double v : qaed::spmv(csc, x)) std::cout << ' ' << v;
+
+  // Two vectors at once, X is 4x2 row major: columns (1, 1, 1, 1) and (1, 0, 0, 0)
+  std::vector<double> block = { 1, 1, 1, 0, 1, 0, 1, 0 };
+  auto yy = qaed::spmm(a, block, 2);
+  std::cout << "\nA [x e0]     =";
+  for (std::size_t r = 0; r < 3; ++r) std::cout << " (" << yy[2 * r] << ", " << yy[2 * r + 1] << ")";
+  std::cout << "\n";
+
+  // Random 500k x 500k matrix with about 16 entries per row
+  const std::uint32_t n = 500000;
+  std::mt19937 rng(11);
+  std::vector<std::size_t>   ptr(1, 0);
+  std::vector<std::uint32_t> idx;
+  std::vector<double>        val;
+
+  for (std::uint32_t r = 0; r < n; ++r) {
+    std::size_t first = idx.size();
+    for (int k = 0; k < 16; ++k) idx.push_back(rng() % n);
+
+    std::sort(idx.begin() + first, idx.end());
+    idx.erase(std::unique(idx.begin() + first, idx.end()), idx.end());
+    val.resize(idx.size(), 0.5);
+    ptr.push_back(idx.size());
+  }
+
+  qaed::CSRMatrix<double> big(n, n, std::move(ptr), std::move(idx), std::move(val));
+  std::vector<double> bx(n, 1.0), by(n);
+
+  double serial   = time_ms([&] { qaed::spmv(big, bx.data(), by.data(), 1.0, 0.0, 1); }, 10);
+  double parallel = time_ms([&] { qaed::spmv(big, bx.data(), by.data()); }, 10);
+  double scalar   = time_ms([&] {
+    for (std::size_t r = 0; r < n; ++r)
+      by[r] = qaed::sparse::dot_scalar(big.idx_begin(r), big.val_begin(r), big.lane_size(r), bx.data());
+  }, 10);
+
+  std::cout << "\n" << big.nnz() << " entries: scalar " << scalar << " ms, spmv 1 thread " << serial << " ms, "
+            << qaed::default_threads() << " threads " << parallel << " ms ("
+            << 2.0 * big.nnz() / parallel / 1e6 << " GFlop/s)\n";
+
+  std::vector<double> bblock(std::size_t(n) * 4, 1.0);
+  double block4 = time_ms([&] { qaed::spmm(big, bblock, 4); }, 5);
+  std::cout << "spmm with 4 vectors " << block4 << " ms\n";
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <iostream>
+
+#include "sparse/Format.hpp"
+#include "sparse/TripletBuilder.hpp"
+
+template <class Function>
+double time_ms(Function&& f, int reps) {
+  auto start = std::chrono::steady_clock::now();
+  for (int ii = 0; ii < reps; ++ii) f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / reps;
+}
+
+double max_diff(const std::vector<double>& a, const std::vector<double>& b) {
+  double d = 0;
+  for (std::size_t i = 0; i < a.size(); ++i) d = std::max(d, std::abs(a[i] - b[i]));
+  return d;
+}
+
+// n x n, dense 4x4 patches: every block row couples to itself and to
+// `coupling` random block rows, like a finite element matrix with 4
+// unknowns per node
+qaed::CSRMatrix<double> blocked(std::uint32_t n, int coupling, std::mt19937& rng) {
+  qaed::TripletBuilder<double> t(n, n);
+  for (std::uint32_t br = 0; br < n / 4; ++br)
+    for (int k = 0; k <= coupling; ++k) {
+      std::uint32_t bc = k ? rng() % (n / 4) : br;
+      for (std::uint32_t i = 0; i < 4; ++i)
+        for (std::uint32_t j = 0; j < 4; ++j) t.add(4 * br + i, 4 * bc + j, double(rng() % 100) / 10);
+    }
+  return t.to_csr();
+}
+
+// n x n, row lengths from 1 to `longest`, scattered columns
+qaed::CSRMatrix<double> irregular(std::uint32_t n, std::uint32_t longest, std::mt19937& rng) {
+  qaed::TripletBuilder<double> t(n, n);
+  for (std::uint32_t r = 0; r < n; ++r)
+    for (std::uint32_t k = 1 + rng() % longest; k; --k) t.add(r, rng() % n, double(rng() % 100) / 10);
+  return t.to_csr();
+}
+
+int main() {
+  // 1 2 0 0 0
+  // 3 4 0 0 5
+  // 0 0 0 6 0
+  qaed::CSRMatrix<double> a(3, 5, { 0, 2, 5, 6 }, { 0, 1, 0, 1, 4, 3 }, { 1, 2, 3, 4, 5, 6 });
+  qaed::BSRMatrix<double, 2> b(a);
+  qaed::SellMatrix<double, 4> s(a, 4);
+
+  std::cout << "BSR 2x2: " << b.blocks() << " blocks, fill " << b.fill() << ", A(1, 4) = " << b.at(1, 4) << "\n";
+  std::cout << "SELL-4-4: " << s.chunks() << " chunk, width " << s.width(0) << ", fill " << s.fill() << "\n";
+  std::cout << "back to CSR: " << (b.to_csr() == a) << ' ' << (s.to_csr() == a) << "\n";
+
+  std::vector<double> x = { 1, 1, 1, 1, 1 };
+  std::cout << "A x =";
+  for (double v : qaed::spmv(a, x)) std::cout << ' ' << v;
+  std::cout << "\nBSR =";
+  for (double v : qaed::spmv(b, x)) std::cout << ' ' << v;
+  std::cout << "\nSELL =";
+  for (double v : qaed::spmv(s, x)) std::cout << ' ' << v;
+  std::cout << "\n\n";
+
+  std::mt19937 rng(50);
+  const std::uint32_t n = 400000;
+  const int reps = 10;
+
+  for (auto& m : { blocked(n, 6, rng), irregular(n, 8, rng), irregular(n, 64, rng) }) {
+    qaed::FormatAdvice advice = qaed::choose_format(m);
+    std::cout << m.nnz() << " entries: " << advice << "\n";
+
+    std::vector<double> v(n);
+    for (auto& e : v) e = double(rng() % 100) / 10;
+    std::vector<double> ref = qaed::spmv(m, v), y;
+
+    qaed::BSRMatrix<double, 4>  b4(m);
+    qaed::SellMatrix<double, 8> s8(m);
+
+    double csr  = time_ms([&] { y = qaed::spmv(m, v); }, reps);
+    double bsr  = time_ms([&] { y = qaed::spmv(b4, v); }, reps);
+    double dbsr = max_diff(y, ref);
+    double sell = time_ms([&] { y = qaed::spmv(s8, v); }, reps);
+    double dsell = max_diff(y, ref);
+
+    std::cout << "  spmv CSR " << csr << " ms, BSR 4x4 " << bsr << " ms (fill " << b4.fill() << ", diff " << dbsr
+              << "), SELL-8 " << sell << " ms (fill " << s8.fill() << ", diff " << dsell << ")\n";
+  }
+  return 0;
+}
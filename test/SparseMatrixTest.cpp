@@ -15,6 +15,26 @@ int main() {
   sp_matrix->add(2, 5, 2);
   sp_matrix->printLn();
 
+  // Out of order insertions still end up sorted in rows and columns
+  sp_matrix->add(3, 5, 8);
+  sp_matrix->add(4, 5, 0);
+  sp_matrix->add(5, 9, 2);
+  std::cout << "row 5:";
+  sp_matrix->for_each_in_row(5, [](unsigned long col, int v) { std::cout << " (" << col << ") " << v; });
+  std::cout << "\ncol 2:";
+  sp_matrix->for_each_in_col(2, [](unsigned long row, int v) { std::cout << " (" << row << ") " << v; });
+
+  qaed::Matrix<int> copy(*sp_matrix);
+  copy.remove(5, 5);
+  std::cout << "\ncopy has " << copy.nnz() << " elements, original " << sp_matrix->nnz() << std::endl << std::endl;
+
+  copy.swap_rows(0, 5);
+  copy.swap_cols(2, 9);
+  copy.remove_row(3);
+  copy.remove_col(7);
+  std::cout << "rows 0, 5 and cols 2, 9 swapped, row 3 and col 7 removed" << std::endl;
+  copy.printLn();
+
   auto fast_spmatrix = std::make_unique<qaed::FastMatrix<int, 0>>(10, 10);
 
   std::cout << "Fast Matrix:" << std::endl;
@@ -30,12 +50,52 @@ int main() {
   fast_spmatrix->add(1, 0, 5);
   fast_spmatrix->printLn();
 
+  qaed::FastMatrix<int, 0> fast_copy = *fast_spmatrix;
+  fast_copy.swap_rows(1, 5);
+  fast_copy.swap_cols(0, 9);
+  fast_copy.remove_row(2);
+  fast_copy.remove_col(6);
+  std::cout << "rows 1, 5 and cols 0, 9 swapped, row 2 and col 6 removed" << std::endl;
+  fast_copy.printLn();
+
   fast_spmatrix->write("out");
 
   auto fast_spmatrix2 = std::make_unique<qaed::FastMatrix<int, 0>>(0,0);
   fast_spmatrix2->read("out");
-  std::cout << "Fast Matrix 2:" << std::endl;
+  std::cout << "Fast Matrix 2 (" << fast_spmatrix2->nnz() << " elements):" << std::endl;
   fast_spmatrix2->printLn();
 
+  fast_spmatrix->write("out.txt", false);
+  auto fast_spmatrix3 = std::make_unique<qaed::FastMatrix<int, 0>>(0,0);
+  fast_spmatrix3->read("out.txt", false);
+  std::cout << "Fast Matrix 3 (text):" << std::endl;
+  fast_spmatrix3->printLn();
+
+  // Narrow types go through the text format as numbers
+  qaed::FastMatrix<bool, false> flags(2, 3);
+  flags.add(true, 0, 1);
+  flags.add(true, 1, 2);
+  flags.write("flags.txt", false);
+  qaed::FastMatrix<bool, false> flags2(0, 0);
+  flags2.read("flags.txt", false);
+  std::cout << "bool (text):" << std::endl;
+  flags2.printLn();
+
+  qaed::FastMatrix<unsigned char, 0> bytes(1, 3);
+  bytes.add(200, 0, 1);
+  bytes.add(255, 0, 2);
+  bytes.write("bytes.txt", false);
+  qaed::FastMatrix<unsigned char, 0> bytes2(0, 0);
+  bytes2.read("bytes.txt", false);
+  std::cout << "unsigned char (text): " << int(bytes2.get(0, 1)) << ' ' << int(bytes2.get(0, 2)) << std::endl;
+
+  qaed::FastMatrix<char, 'x'> chars(1, 3);
+  chars.add(' ', 0, 0);
+  chars.add('q', 0, 2);
+  chars.write("chars.txt", false);
+  qaed::FastMatrix<char, 'x'> chars2(0, 0);
+  chars2.read("chars.txt", false);
+  std::cout << "char (text): '" << chars2.get(0, 0) << "' '" << chars2.get(0, 2) << "' " << chars2.nnz() << " elements" << std::endl;
+
   return 0;
 }
@@ -0,0 +1,48 @@
+#include <chrono>
+#include <iostream>
+
+#include "graph/Subgraph.hpp"
+#include "graph/Generators.hpp"
+
+int main() {
+  qaed::Graph<char, int, qaed::UNDIRECTED> g;
+  for (char c = 'a'; c <= 'g'; ++c)
+    g.add_vertex(c);
+
+  g.add_edge('a', 'b', 1);
+  g.add_edge('b', 'c', 2);
+  g.add_edge('c', 'd', 3);
+  g.add_edge('d', 'e', 4);
+  g.add_edge('a', 'f', 5);
+  g.add_edge('f', 'g', 6);
+
+  qaed::CSRGraph<char, int> csr(g);
+
+  std::cout << "Ego network of 'a', radius 2:\n";
+  auto ego = qaed::SubgraphView<char, int>::ego(csr, csr.id_of('a'), 2);
+  ego.materialize().print();
+
+  std::cout << "Induced by {b, c, d, g}:\n";
+  auto induced = qaed::SubgraphView<char, int>::induced(csr, { csr.id_of('b'), csr.id_of('c'), csr.id_of('d'), csr.id_of('g') });
+  induced.materialize().print();
+
+  std::cout << "Arcs with tag >= 4:\n";
+  auto heavy = qaed::SubgraphView<char, int>::arcs_where(csr, [](auto, auto, const int& t) { return t >= 4; });
+  heavy.materialize().print();
+
+  auto list = qaed::generators::power_law<int>(200000, 4);
+  std::vector<unsigned> labels(list.no_vertexes);
+  std::iota(labels.begin(), labels.end(), 0);
+  std::vector<qaed::CSRGraph<unsigned, int>::Arc> arcs(list.edges.begin(), list.edges.end());
+  auto big = qaed::CSRGraph<unsigned, int>::from_arcs(labels, arcs, false);
+
+  auto start = std::chrono::steady_clock::now();
+  auto view  = qaed::SubgraphView<unsigned, int>::ego(big, 12345, 2, 2000);
+  auto sub   = view.materialize();
+  auto end   = std::chrono::steady_clock::now();
+
+  std::cout << "2-hop ego of 12345 in a 200k vertexes graph: " << sub.no_vertexes() << " vertexes, "
+            << sub.no_edges() << " arcs in " << std::chrono::duration<double, std::micro>(end - start).count() << " us\n";
+
+  return 0;
+}
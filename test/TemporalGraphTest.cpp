@@ -0,0 +1,61 @@
+#include <chrono>
+#include <random>
+#include <iostream>
+
+#include "graph/TemporalGraph.hpp"
+
+int main() {
+  // Trains between stations, [begin, end) is when a train can be
+  // boarded and duration the length of the trip
+  qaed::TemporalGraph<std::string, int, qaed::DIRECTED> g;
+  for (auto s : { "A", "B", "C", "D" })
+    g.add_vertex(s);
+
+  g.add_edge("A", "B", 0, 100, 1, 1);
+  g.add_edge("B", "D", 50, 51, 2, 1);
+  g.add_edge("A", "C", 10, 11, 3, 5);
+  g.add_edge("C", "D", 20, 30, 4, 2);
+  g.print();
+
+  auto a = g.id_of("A"), d = g.id_of("D");
+
+  std::cout << "\nBFS from A during [0, 15):";
+  g.visit_bfs(a, 0, 15, [&](auto v, auto hops) { std::cout << ' ' << g.label(v) << '/' << hops; });
+
+  auto arrivals = g.earliest_arrival(a, 0);
+  std::cout << "\nEarliest arrival at D leaving A at 0: " << arrivals.arrival[d] << " via";
+  for (auto v : arrivals.path_to(d)) std::cout << ' ' << g.label(v);
+
+  auto fast = g.fastest_path(a, d, 0);
+  std::cout << "\nFastest A -> D: leave at " << fast.departure << ", arrive at " << fast.arrival << " via";
+  for (auto v : fast.vertexes) std::cout << ' ' << g.label(v);
+  std::cout << "\n\nSnapshot of [40, 60):\n";
+  g.snapshot(40, 60).print();
+
+  qaed::TemporalGraph<unsigned, int, qaed::UNDIRECTED> contacts;
+  const unsigned n = 20000;
+  for (unsigned v = 0; v < n; ++v)
+    contacts.add_vertex(v);
+
+  std::mt19937_64 rng(1);
+  for (unsigned ii = 0; ii < 1000000; ++ii) {
+    long long t = rng() % 86400;
+    contacts.link(rng() % n, rng() % n, t, t + 60 + (long long)(rng() % 600), 1, 5);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::size_t reached = 0;
+  contacts.visit_bfs(0u, 3600, 7200, [&](auto, auto) { ++reached; });
+  auto mid = std::chrono::steady_clock::now();
+  auto ea = contacts.earliest_arrival(0u, 3600, 7200);
+  auto end = std::chrono::steady_clock::now();
+
+  std::size_t in_time = 0;
+  for (auto t : ea.arrival) in_time += t != contacts.NEVER;
+
+  std::cout << "\n1M contacts between 20k people over a day, window [1h, 2h): BFS reached " << reached << " in "
+            << std::chrono::duration<double, std::milli>(mid - start).count() << " ms, time respecting paths reached "
+            << in_time << " in " << std::chrono::duration<double, std::milli>(end - mid).count() << " ms\n";
+
+  return 0;
+}